@@ -20,15 +20,40 @@
 
 #include <algorithm>
 #include <regex>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "audiocapturemgr_iarm.h"
 #undef LOG // we don't need LOG from audiocapturemgr_iarm as we are defining our own LOG
 #include "DataCapture.h"
 #include <curl/curl.h>
 #include "socket_adaptor.h"
+#include "pcm_stream_server.h"
+#include "ChunkQueue.h"
+
+// the clip is read from the socket in parts of this size while it is uploaded
+#define DATA_CAPTURE_CLIP_CHUNK_SIZE 4096
+// clips waiting for the worker, a clip beyond that fails right away
+#define DATA_CAPTURE_MAX_PENDING_CLIPS 8
+#define DATA_CAPTURE_CLIP_ATTEMPTS 2
+#define DATA_CAPTURE_CLIP_RETRY_DELAY_MS 1000
+// encoded clip data waiting for the upload, the encoder blocks when the upload falls behind
+#define DATA_CAPTURE_ENCODED_CHUNK_SIZE 4096
+#define DATA_CAPTURE_ENCODED_MAX_CHUNKS 16
+
+#define DATA_CAPTURE_STREAM_DIRECTORY "/run/data-capture"
+#define DATA_CAPTURE_STREAM_PATH DATA_CAPTURE_STREAM_DIRECTORY "/pcm"
+// how far a live audio client may fall behind before it loses audio
+#define DATA_CAPTURE_STREAM_BUFFER_MS 500
+#define DATA_CAPTURE_STREAM_CHUNK_SIZE 4096
+#define DATA_CAPTURE_STREAM_RECONNECT_DELAY_MS 100
 
 const string WPEFramework::Plugin::DataCapture::SERVICE_NAME = "org.rdk.DataCapture";
 const string WPEFramework::Plugin::DataCapture::METHOD_ENABLE_AUDIO_CAPTURE = "enableAudioCapture";
 const string WPEFramework::Plugin::DataCapture::METHOD_GET_AUDIO_CLIP = "getAudioClip";
+const string WPEFramework::Plugin::DataCapture::METHOD_START_AUDIO_STREAM = "startAudioStream";
+const string WPEFramework::Plugin::DataCapture::METHOD_STOP_AUDIO_STREAM = "stopAudioStream";
+const string WPEFramework::Plugin::DataCapture::METHOD_GET_AUDIO_STREAM_STATUS = "getAudioStreamStatus";
 const string WPEFramework::Plugin::DataCapture::EVT_ON_AUDIO_CLIP_READY = "onAudioClipReady";
 pthread_mutex_t WPEFramework::Plugin::DataCapture::_mutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -73,6 +98,12 @@ namespace WPEFramework {
             , _max_supported_duration(0)
             , _is_precapture(false)
             , _duration(0)
+            , _codec(audio_encoder::PCM)
+            , _clip_worker_running(false)
+            , _curl(nullptr)
+            , _stream_session_id(-1)
+            , _stream_server(nullptr)
+            , _stream_running(false)
         {
             LOGINFO("ctor");
 
@@ -81,8 +112,13 @@ namespace WPEFramework {
             DataCapture::_instance = this;
             Register(METHOD_ENABLE_AUDIO_CAPTURE, &DataCapture::enableAudioCaptureWrapper, this);
             Register(METHOD_GET_AUDIO_CLIP, &DataCapture::getAudioClipWrapper, this);
+            Register(METHOD_START_AUDIO_STREAM, &DataCapture::startAudioStreamWrapper, this);
+            Register(METHOD_STOP_AUDIO_STREAM, &DataCapture::stopAudioStreamWrapper, this);
+            Register(METHOD_GET_AUDIO_STREAM_STATUS, &DataCapture::getAudioStreamStatusWrapper, this);
 
             _sock_adaptor = new socket_adaptor();
+
+            curl_global_init(CURL_GLOBAL_ALL);
         }
 
         DataCapture::~DataCapture()
@@ -92,6 +128,7 @@ namespace WPEFramework {
 
         const string DataCapture::Initialize(PluginHost::IShell* /* service */)
         {
+            startClipWorker();
             InitializeIARM();
             return "";
         }
@@ -99,7 +136,14 @@ namespace WPEFramework {
         void DataCapture::Deinitialize(PluginHost::IShell* /* service */)
         {
             DeinitializeIARM();
+            stopAudioStream();
+            stopClipWorker();
             delete _sock_adaptor;
+            if (_curl)
+            {
+                curl_easy_cleanup(_curl);
+                _curl = nullptr;
+            }
             DataCapture::_instance = nullptr;
         }
 
@@ -179,6 +223,62 @@ namespace WPEFramework {
             response["error"] = ret;
             returnResponse(0 == ret);
         }
+
+        uint32_t DataCapture::startAudioStreamWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            UNUSED(parameters);
+
+            string path(DATA_CAPTURE_STREAM_PATH);
+            int ret = startAudioStream(path);
+            response["error"] = ret;
+            if (0 == ret)
+            {
+                std::lock_guard<std::mutex> lock(_stream_mutex);
+                response["path"] = path;
+                response["format"] = _stream_format_string;
+            }
+            returnResponse(0 == ret);
+        }
+
+        uint32_t DataCapture::stopAudioStreamWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            stopAudioStream();
+            returnResponse(true);
+        }
+
+        uint32_t DataCapture::getAudioStreamStatusWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            std::lock_guard<std::mutex> lock(_stream_mutex);
+            response["running"] = _stream_running;
+            if (_stream_running)
+            {
+                response["path"] = _stream_server->get_path();
+                response["format"] = _stream_format_string;
+                response["bytesCaptured"] = _stream_server->get_bytes_received();
+
+                std::vector<pcm_stream_server::subscriber_info> subscribers;
+                _stream_server->get_subscribers(subscribers);
+
+                JsonArray subscriberArray;
+                for (std::vector<pcm_stream_server::subscriber_info>::const_iterator it = subscribers.begin(); it != subscribers.end(); ++it)
+                {
+                    JsonObject subscriber;
+                    subscriber["id"] = it->id;
+                    subscriber["bytesSent"] = it->bytes_sent;
+                    subscriber["bytesLost"] = it->bytes_lost;
+                    subscriber["overruns"] = it->overruns;
+                    subscriberArray.Add(subscriber);
+                }
+                response["subscribers"] = subscriberArray;
+            }
+            returnResponse(true);
+        }
         // Registered methods end
 
         // Internal methods begin
@@ -301,9 +401,17 @@ namespace WPEFramework {
             _duration = (unsigned int)clipRequest["duration"].Number();
             const string& captureMode = clipRequest["captureMode"].String();
             _is_precapture = (captureMode == "preCapture");
+            const string codec = clipRequest.HasLabel("codec") ? clipRequest["codec"].String() : string("pcm");
+
+            LOGINFO("DataCaptureService calling getAudioClip: stream = %s, url = %s, duration = %d, captureMode = %s, codec = %s, session id = %d",
+                         stream.c_str(), _destination_url.c_str(), _duration, captureMode.c_str(), codec.c_str(), _session_id);
 
-            LOGINFO("DataCaptureService calling getAudioClip: stream = %s, url = %s, duration = %d, captureMode = %s, session id = %d",
-                         stream.c_str(), _destination_url.c_str(), _duration, captureMode.c_str(), _session_id);
+            if(!audio_encoder::parse_codec(codec, _codec))
+            {
+                LOGERR("Unknown codec %s, expected pcm, flac or opus.", codec.c_str());
+                _codec = audio_encoder::PCM;
+                return ACM_RESULT_GENERAL_FAILURE;
+            }
 
             if(0 > _session_id)
             {
@@ -339,39 +447,268 @@ namespace WPEFramework {
 
         void DataCapture::constructFormatString()
         {
-            _audio_format_string = "";
-            switch(_audio_properties.format)
+            _audio_format_string = getFormatString(_audio_properties);
+            LOGINFO("New format string is %s", _audio_format_string.c_str());
+        }
+
+        string DataCapture::getFormatString(const audio_properties_ifce_t& properties)
+        {
+            string format_string;
+            switch(properties.format)
             {
                 case acmFormate16BitStereo:
-                    _audio_format_string += "codec=PCM_16_"; break;
+                    format_string += "codec=PCM_16_"; break;
                 case acmFormate16BitMonoLeft: //fall-through
                 case acmFormate16BitMonoRight: //fall-through
                 case acmFormate16BitMono:
-                    _audio_format_string += "codec=PCM_1_16_"; break;
+                    format_string += "codec=PCM_1_16_"; break;
                 case acmFormate24BitStereo:
-                    _audio_format_string += "codec=PCM_24_"; break;
+                    format_string += "codec=PCM_24_"; break;
                 case acmFormate24Bit5_1:
-                    _audio_format_string += "codec=PCM_6_24_"; break;
+                    format_string += "codec=PCM_6_24_"; break;
                 default:
                     LOGERR("Unsupported audio format!");
             }
 
-            switch(_audio_properties.sampling_frequency)
+            unsigned int sampling_rate = getSamplingRate(properties);
+            if (0 != sampling_rate)
+            {
+                format_string += std::to_string(sampling_rate) + "&";
+            }
+            else
+            {
+                LOGERR("Unsupported audio sampling rate!");
+            }
+            return format_string;
+        }
+
+        unsigned int DataCapture::getFrameSize(const audio_properties_ifce_t& properties)
+        {
+            switch(properties.format)
+            {
+                case acmFormate16BitStereo:
+                    return 4;
+                case acmFormate16BitMonoLeft: //fall-through
+                case acmFormate16BitMonoRight: //fall-through
+                case acmFormate16BitMono:
+                    return 2;
+                case acmFormate24BitStereo:
+                    return 6;
+                case acmFormate24Bit5_1:
+                    return 18;
+                default:
+                    return 1;
+            }
+        }
+
+        audio_encoder::pcm_format DataCapture::getPcmFormat(const audio_properties_ifce_t& properties)
+        {
+            audio_encoder::pcm_format format;
+            format.sample_rate = getSamplingRate(properties);
+            switch(properties.format)
+            {
+                case acmFormate16BitStereo:
+                    format.channels = 2; format.bits_per_sample = 16; break;
+                case acmFormate16BitMonoLeft: //fall-through
+                case acmFormate16BitMonoRight: //fall-through
+                case acmFormate16BitMono:
+                    format.channels = 1; format.bits_per_sample = 16; break;
+                case acmFormate24BitStereo:
+                    format.channels = 2; format.bits_per_sample = 24; break;
+                case acmFormate24Bit5_1:
+                    format.channels = 6; format.bits_per_sample = 24; break;
+                default:
+                    format.channels = 0; format.bits_per_sample = 0;
+            }
+            return format;
+        }
+
+        unsigned int DataCapture::getSamplingRate(const audio_properties_ifce_t& properties)
+        {
+            switch(properties.sampling_frequency)
             {
                 case acmFreqe48000:
-                    _audio_format_string += "48000&"; break;
+                    return 48000;
                 case acmFreqe44100:
-                    _audio_format_string += "44100&"; break;
+                    return 44100;
                 case acmFreqe32000:
-                    _audio_format_string += "32000&"; break;
+                    return 32000;
                 case acmFreqe24000:
-                    _audio_format_string += "24000&"; break;
+                    return 24000;
                 case acmFreqe16000:
-                    _audio_format_string += "16000&"; break;
+                    return 16000;
                 default:
-                    LOGERR("Unsupported audio sampling rate!");
+                    return 0;
+            }
+        }
+
+        bool DataCapture::prepareStreamDirectory()
+        {
+            // the directory is not shared with anyone, so nobody else can place or replace files in it
+            struct stat directory_stat;
+            if ((0 != mkdir(DATA_CAPTURE_STREAM_DIRECTORY, 0750)) && (EEXIST != errno))
+            {
+                LOGERR("Failed to create %s: %d", DATA_CAPTURE_STREAM_DIRECTORY, errno);
+                return false;
+            }
+            if ((0 != lstat(DATA_CAPTURE_STREAM_DIRECTORY, &directory_stat)) || !S_ISDIR(directory_stat.st_mode) || (directory_stat.st_uid != geteuid()))
+            {
+                LOGERR("%s is not a directory of this process", DATA_CAPTURE_STREAM_DIRECTORY);
+                return false;
+            }
+            if (0 != chmod(DATA_CAPTURE_STREAM_DIRECTORY, 0750))
+            {
+                LOGERR("Failed to restrict %s: %d", DATA_CAPTURE_STREAM_DIRECTORY, errno);
+                return false;
+            }
+            return true;
+        }
+
+        int DataCapture::startAudioStream(const string& path)
+        {
+            std::lock_guard<std::mutex> callLock(_stream_call_mutex);
+
+            LOGINFO("DataCaptureService calling startAudioStream: path = %s", C_STR(path));
+
+            if (0 <= _stream_session_id)
+            {
+                LOGERR("Audio stream is already running.");
+                return ACM_RESULT_GENERAL_FAILURE;
+            }
+
+            IARM_Result_t ret;
+            iarmbus_acm_arg_t param;
+
+            /*Open a realtime session, it writes the audio to a socket while it is captured*/
+            param.details.arg_open.source = 0; //primary
+            param.details.arg_open.output_type = REALTIME_SOCKET;
+            ret = IARM_Bus_Call(IARMBUS_AUDIOCAPTUREMGR_NAME, IARMBUS_AUDIOCAPTUREMGR_OPEN, (void *) &param, sizeof(param));
+            if(!verify_result(ret, param))
+            {
+                LOGERR("Failed to open a realtime audiocapturemgr session.");
+                return ACM_RESULT_GENERAL_FAILURE;
+            }
+            audiocapturemgr::session_id_t session_id = param.session_id;
+
+            audio_properties_ifce_t audio_properties;
+            string acm_path;
+            param.session_id = session_id;
+            ret = IARM_Bus_Call(IARMBUS_AUDIOCAPTUREMGR_NAME, IARMBUS_AUDIOCAPTUREMGR_GET_AUDIO_PROPS, (void *) &param, sizeof(param));
+            bool ok = verify_result(ret, param);
+            if (ok)
+            {
+                audio_properties = param.details.arg_audio_properties;
+                param.session_id = session_id;
+                ret = IARM_Bus_Call(IARMBUS_AUDIOCAPTUREMGR_NAME, IARMBUS_AUDIOCAPTUREMGR_GET_OUTPUT_PROPS, (void *) &param, sizeof(param));
+                ok = verify_result(ret, param);
+                if (ok)
+                {
+                    acm_path = param.details.arg_output_props.output.file_path;
+                }
+            }
+
+            pcm_stream_server* server = nullptr;
+            if (ok)
+            {
+                ok = prepareStreamDirectory();
+            }
+            if (ok)
+            {
+                unsigned int frame_size = getFrameSize(audio_properties);
+                size_t ring_size = (size_t)getSamplingRate(audio_properties) * frame_size * DATA_CAPTURE_STREAM_BUFFER_MS / 1000;
+                server = new pcm_stream_server(std::max<size_t>(ring_size, DATA_CAPTURE_STREAM_CHUNK_SIZE), frame_size);
+                ok = (0 == server->start(path));
+            }
+
+            if (ok)
+            {
+                param.session_id = session_id;
+                ret = IARM_Bus_Call(IARMBUS_AUDIOCAPTUREMGR_NAME, IARMBUS_AUDIOCAPTUREMGR_START, (void *) &param, sizeof(param));
+                ok = verify_result(ret, param);
+            }
+
+            if (!ok)
+            {
+                LOGERR("Failed to start the audio stream.");
+                delete server;
+                param.session_id = session_id;
+                IARM_Bus_Call(IARMBUS_AUDIOCAPTUREMGR_NAME, IARMBUS_AUDIOCAPTUREMGR_CLOSE, (void *) &param, sizeof(param));
+                return ACM_RESULT_GENERAL_FAILURE;
+            }
+
+            std::lock_guard<std::mutex> lock(_stream_mutex);
+            _stream_session_id = session_id;
+            _stream_server = server;
+            _stream_format_string = getFormatString(audio_properties);
+            _stream_running = true;
+            _stream_reader = std::thread(&DataCapture::streamReader, this, acm_path);
+            return 0;
+        }
+
+        void DataCapture::stopAudioStream()
+        {
+            std::lock_guard<std::mutex> callLock(_stream_call_mutex);
+
+            if (0 > _stream_session_id)
+            {
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_stream_mutex);
+                _stream_running = false;
+            }
+            _stream_condition.notify_all();
+
+            /*Stopping the session ends the data on the socket, which lets the reader return*/
+            iarmbus_acm_arg_t param;
+            param.session_id = _stream_session_id;
+            IARM_Result_t ret = IARM_Bus_Call(IARMBUS_AUDIOCAPTUREMGR_NAME, IARMBUS_AUDIOCAPTUREMGR_STOP, (void *) &param, sizeof(param));
+            if(IARM_RESULT_SUCCESS != ret)
+            {
+                LOGERR("Failed to stop audiocapturemgr session.");
+            }
+            ret = IARM_Bus_Call(IARMBUS_AUDIOCAPTUREMGR_NAME, IARMBUS_AUDIOCAPTUREMGR_CLOSE, (void *) &param, sizeof(param));
+            if(IARM_RESULT_SUCCESS != ret)
+            {
+                LOGERR("Failed to close audiocapturemgr session.");
+            }
+            _stream_session_id = -1;
+
+            if (_stream_reader.joinable())
+            {
+                _stream_reader.join();
+            }
+
+            std::lock_guard<std::mutex> lock(_stream_mutex);
+            delete _stream_server;
+            _stream_server = nullptr;
+        }
+
+        void DataCapture::streamReader(const string acmPath)
+        {
+            socket_adaptor acm_socket;
+            std::vector<char> buffer(DATA_CAPTURE_STREAM_CHUNK_SIZE);
+
+            std::unique_lock<std::mutex> lock(_stream_mutex);
+            while (_stream_running)
+            {
+                lock.unlock();
+                if (0 == acm_socket.connect_socket(acmPath))
+                {
+                    int size_recv;
+                    // the server does not lock, the clients get the audio from the ring on its own thread
+                    while (0 < (size_recv = acm_socket.read_data(&buffer[0], buffer.size())))
+                    {
+                        _stream_server->push(&buffer[0], size_recv);
+                    }
+                    acm_socket.disconnect_socket();
+                }
+                lock.lock();
+
+                /*The session may not have opened its socket yet, or restarted it*/
+                _stream_condition.wait_for(lock, std::chrono::milliseconds(DATA_CAPTURE_STREAM_RECONNECT_DELAY_MS), [this] { return !_stream_running; });
             }
-            LOGINFO("New format string is %s", _audio_format_string.c_str());
         }
 
         void DataCapture::iarmEventHandler(const char *owner, IARM_EventId_t eventId, void *data, size_t len)
@@ -395,116 +732,291 @@ namespace WPEFramework {
             if(DATA_CAPTURE_IARM_EVENT_AUDIO_CLIP_READY == eventId)
             {
                 iarmbus_notification_payload_t * payload = static_cast <iarmbus_notification_payload_t *> (eventData);
-                string dataLocator(payload->dataLocator);
-                string delimiter = "/";
-                size_t pos = 0;
-                string fileName;
-                pos = dataLocator.rfind(delimiter);
-                fileName = dataLocator.substr(pos + delimiter.length(), dataLocator.length());
-                int attemptsLeft = 2;
-                vector<unsigned char> data;
-                int time_wait_sec = 1;
-
-                JsonObject params;
-                params["fileName"] = fileName;
-
-                while (attemptsLeft) {
-                    if(0 == _sock_adaptor->connect_socket(payload->dataLocator))
+
+                ClipJob job;
+                job.dataLocator = payload->dataLocator;
+                job.url = _destination_url;
+                job.codec = _codec;
+                job.format = getPcmFormat(_audio_properties);
+
+                std::unique_lock<std::mutex> lock(_clip_mutex);
+                if (_clip_queue.size() >= DATA_CAPTURE_MAX_PENDING_CLIPS)
+                {
+                    lock.unlock();
+                    LOGERR("Too many clips waiting for upload, dropping %s", C_STR(job.dataLocator));
+
+                    string fileName = job.dataLocator.substr(job.dataLocator.rfind('/') + 1);
+                    JsonObject params;
+                    params["fileName"] = fileName;
+                    params["status"] = false;
+                    params["message"] = std::string("Too many clips waiting for upload, dropped ") + job.dataLocator;
+                    sendNotify(C_STR(EVT_ON_AUDIO_CLIP_READY), params);
+                    return;
+                }
+                _clip_queue.push_back(job);
+                lock.unlock();
+                _clip_condition.notify_one();
+            }
+        }
+
+        void DataCapture::startClipWorker()
+        {
+            std::lock_guard<std::mutex> lock(_clip_mutex);
+            if (!_clip_worker_running)
+            {
+                _clip_worker_running = true;
+                _clip_worker = std::thread(&DataCapture::clipWorker, this);
+            }
+        }
+
+        void DataCapture::stopClipWorker()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_clip_mutex);
+                _clip_worker_running = false;
+                _clip_queue.clear();
+            }
+            _clip_condition.notify_all();
+            if (_clip_worker.joinable())
+            {
+                _clip_worker.join();
+            }
+        }
+
+        void DataCapture::clipWorker()
+        {
+            std::unique_lock<std::mutex> lock(_clip_mutex);
+            while (_clip_worker_running)
+            {
+                if (_clip_queue.empty())
+                {
+                    _clip_condition.wait(lock);
+                    continue;
+                }
+                ClipJob job = _clip_queue.front();
+                _clip_queue.pop_front();
+                lock.unlock();
+                deliverClip(job);
+                lock.lock();
+            }
+        }
+
+        void DataCapture::deliverClip(const ClipJob& job)
+        {
+            string delimiter = "/";
+            size_t pos = job.dataLocator.rfind(delimiter);
+            string fileName = job.dataLocator.substr(pos + delimiter.length(), job.dataLocator.length());
+
+            JsonObject params;
+            params["fileName"] = fileName;
+
+            // the first part is read before the upload starts, so that an empty clip is retried instead of uploaded
+            char firstChunk[DATA_CAPTURE_CLIP_CHUNK_SIZE];
+            int firstChunkSize = 0;
+            for (int attempt = 1; attempt <= DATA_CAPTURE_CLIP_ATTEMPTS; ++attempt)
+            {
+                if (0 == _sock_adaptor->connect_socket(job.dataLocator))
+                {
+                    firstChunkSize = _sock_adaptor->read_data(firstChunk, sizeof(firstChunk));
+                    if (firstChunkSize > 0)
                     {
-                        _sock_adaptor->get_data(data); // closes the socket
-                        if (data.size() > 0) {
-                            LOGINFO("Got a clip: %u bytes", data.size());
-                            break;
-                        } else {
-                            LOGWARN("No data in the socket. One more attempt in %d sec", time_wait_sec);
-                            usleep(1000 * 1000 * time_wait_sec);
-                            --attemptsLeft;
-                            continue;
-                        }
+                        break;
                     }
+                    _sock_adaptor->disconnect_socket();
                 }
 
-                if(data.size() > 0)
+                if (attempt < DATA_CAPTURE_CLIP_ATTEMPTS)
                 {
-                    std::string error_str;
-                    if (uploadDataToUrl(data, _destination_url.c_str(), error_str))
+                    LOGWARN("No data in the socket. One more attempt in %d ms", DATA_CAPTURE_CLIP_RETRY_DELAY_MS);
+                    std::unique_lock<std::mutex> lock(_clip_mutex);
+                    if (_clip_condition.wait_for(lock, std::chrono::milliseconds(DATA_CAPTURE_CLIP_RETRY_DELAY_MS), [this] { return !_clip_worker_running; }))
                     {
-                        params["status"] = true;
-                        params["message"] = "Success";
-
-                    } else {
-                        LOGERR("Upload failed: %s (cURL error)", C_STR(error_str));
-                        params["status"] = false;
-                        params["message"] = std::string("Upload Failed: ") + error_str;
+                        return;
                     }
+                }
+            }
 
-                    // Optionally, we can save a file
-//                    FILE * pFile;
-//                    const char* path = strcat(payload->dataLocator, ".received.pcm");
-//                    pFile = fopen (path, "wb");
-//                    fwrite (&data[0] , sizeof(unsigned char), data.size(), pFile);
-//                    fclose (pFile);
-                    // now, upload it, then remove:
-//                    if (remove(path) != 0)
-//                    {
-//                        LOGERR("Unable to delete %s", path);
-//                    }
+            if (firstChunkSize > 0)
+            {
+                std::string error_str;
+                audio_encoder::codec_t codec = audio_encoder::negotiate(job.codec, job.format);
+                if (codec != job.codec)
+                {
+                    LOGWARN("%s is not available for %s, the clip is sent as %s", audio_encoder::get_codec_name(job.codec),
+                            C_STR(_audio_format_string), audio_encoder::get_codec_name(codec));
+                }
+                bool uploaded = uploadClipToUrl(firstChunk, firstChunkSize, job.url.c_str(), codec, job.format, error_str);
+                _sock_adaptor->disconnect_socket();
+                params["codec"] = audio_encoder::get_codec_name(codec);
+
+                if (uploaded)
+                {
+                    params["status"] = true;
+                    params["message"] = "Success";
                 } else {
-                    LOGERR("Unable to read data from %s (connection error)", payload->dataLocator);
+                    LOGERR("Upload failed: %s (cURL error)", C_STR(error_str));
                     params["status"] = false;
-                    params["message"] = std::string("Unable to read data from  ") + string(payload->dataLocator);
+                    params["message"] = std::string("Upload Failed: ") + error_str;
                 }
+            } else {
+                LOGERR("Unable to read data from %s (connection error)", C_STR(job.dataLocator));
+                params["status"] = false;
+                params["message"] = std::string("Unable to read data from  ") + job.dataLocator;
+            }
 
-                string message;
-                params.ToString(message);
-                LOGINFO("Sending notification %s: %s", C_STR(EVT_ON_AUDIO_CLIP_READY), C_STR(message));
-                sendNotify(C_STR(EVT_ON_AUDIO_CLIP_READY), params);
+            string message;
+            params.ToString(message);
+            LOGINFO("Sending notification %s: %s", C_STR(EVT_ON_AUDIO_CLIP_READY), C_STR(message));
+            sendNotify(C_STR(EVT_ON_AUDIO_CLIP_READY), params);
+        }
+
+        namespace {
+            struct ClipStream
+            {
+                socket_adaptor *sockAdaptor;
+                const char *firstChunk;
+                size_t firstChunkSize;
+                size_t totalSize;
+                bool failed;
+                // set when the clip is compressed, the encoder reads the socket instead
+                ChunkQueue *encoded;
+            };
+
+            // encoder thread of a compressed clip, from the socket into the queue of the upload
+            void encodeClip(audio_encoder *encoder, socket_adaptor *sockAdaptor, const char *firstChunk, size_t firstChunkSize, ChunkQueue *queue)
+            {
+                char buffer[DATA_CAPTURE_CLIP_CHUNK_SIZE];
+                bool ok = encoder->write(firstChunk, firstChunkSize);
+                while (ok)
+                {
+                    int size_recv = sockAdaptor->read_data(buffer, sizeof(buffer));
+                    if (size_recv <= 0)
+                    {
+                        ok = (0 == size_recv) && encoder->finish();
+                        break;
+                    }
+                    ok = encoder->write(buffer, size_recv);
+                }
+                queue->finish(ok);
+            }
+
+            size_t clipReadCallback(char *buffer, size_t size, size_t nitems, void *userdata)
+            {
+                ClipStream *stream = static_cast<ClipStream *>(userdata);
+                size_t length = size * nitems;
+
+                if (stream->encoded)
+                {
+                    if (!stream->encoded->read((unsigned char *)buffer, length, length))
+                    {
+                        stream->failed = true;
+                        return CURL_READFUNC_ABORT;
+                    }
+                }
+                else if (stream->firstChunkSize > 0)
+                {
+                    length = std::min(length, stream->firstChunkSize);
+                    memcpy(buffer, stream->firstChunk, length);
+                    stream->firstChunk += length;
+                    stream->firstChunkSize -= length;
+                }
+                else
+                {
+                    int size_recv = stream->sockAdaptor->read_data(buffer, length);
+                    if (size_recv < 0)
+                    {
+                        stream->failed = true;
+                        return CURL_READFUNC_ABORT;
+                    }
+                    length = size_recv;
+                }
+
+                stream->totalSize += length;
+                return length;
             }
         }
 
-        bool DataCapture::uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str)
+        bool DataCapture::uploadClipToUrl(const char *firstChunk, size_t firstChunkSize, const char *url, audio_encoder::codec_t &codec, const audio_encoder::pcm_format &format, std::string &error_str)
         {
-            CURL *curl;
             CURLcode res;
             bool call_succeeded = true;
 
             if(!url || !strlen(url))
             {
                 LOGERR("no url given");
+                error_str = "no url given";
                 return false;
             }
 
-            LOGWARN("uploading pcm data of size %u to '%s'", data.size(), url);
+            //a compressed clip is encoded on its own thread while curl sends what is ready
+            ChunkQueue encoded(DATA_CAPTURE_ENCODED_CHUNK_SIZE, DATA_CAPTURE_ENCODED_MAX_CHUNKS);
+            std::unique_ptr<audio_encoder> encoder;
+            if(audio_encoder::PCM != codec)
+            {
+                encoder = audio_encoder::create(codec, format, [&encoded](const char *data, size_t size) {
+                    return encoded.write((const unsigned char *)data, size);
+                });
+                if(!encoder)
+                {
+                    LOGWARN("could not create the %s encoder, the clip is sent as pcm", audio_encoder::get_codec_name(codec));
+                    codec = audio_encoder::PCM;
+                }
+            }
 
-            //init curl
-            curl_global_init(CURL_GLOBAL_ALL);
-            curl = curl_easy_init();
+            LOGWARN("uploading %s data to '%s' while it is read", audio_encoder::get_codec_name(codec), url);
+
+            //the handle is kept between clips so that its connection can be reused
+            if(!_curl)
+                _curl = curl_easy_init();
+            else
+                curl_easy_reset(_curl);
 
-            if(!curl)
+            if(!_curl)
             {
                 LOGERR("could not init curl\n");
+                error_str = "could not init curl";
                 return false;
             }
 
+            ClipStream stream = { _sock_adaptor, firstChunk, firstChunkSize, 0, false, encoder ? &encoded : nullptr };
+            std::thread encoder_thread;
+            if(encoder)
+                encoder_thread = std::thread(encodeClip, encoder.get(), _sock_adaptor, firstChunk, firstChunkSize, &encoded);
+
             //create header
             struct curl_slist *chunk = NULL;
-            chunk = curl_slist_append(chunk, "Content-Type: audio/x-wav");
+            chunk = curl_slist_append(chunk, (std::string("Content-Type: ") + audio_encoder::get_content_type(codec)).c_str());
+            chunk = curl_slist_append(chunk, "Transfer-Encoding: chunked");
 
-            //set url and data
-            curl_easy_setopt(curl, CURLOPT_URL, url);
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.size());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, &data[0]);
+            //set url and data, the data is read from the socket as curl sends it
+            curl_easy_setopt(_curl, CURLOPT_URL, url);
+            curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, chunk);
+            curl_easy_setopt(_curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(_curl, CURLOPT_READFUNCTION, clipReadCallback);
+            curl_easy_setopt(_curl, CURLOPT_READDATA, &stream);
 
             //perform blocking upload call
-            res = curl_easy_perform(curl);
+            res = curl_easy_perform(_curl);
+
+            //unblocks the encoder when the upload stopped early
+            if(encoder_thread.joinable())
+            {
+                encoded.cancel();
+                encoder_thread.join();
+            }
 
             //output success / failure log
-            if(CURLE_OK == res)
+            if(stream.failed)
+            {
+                LOGERR("reading the clip failed after %u bytes", (unsigned int)stream.totalSize);
+                error_str = "reading the clip failed";
+                call_succeeded = false;
+            }
+            else if(CURLE_OK == res)
             {
                 long response_code;
 
-                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+                curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, &response_code);
 
                 if(600 > response_code && response_code >= 400)
                 {
@@ -513,7 +1025,7 @@ namespace WPEFramework {
                     call_succeeded = false;
                 }
                 else
-                    LOGWARN("upload done");
+                    LOGWARN("upload of %u bytes done", (unsigned int)stream.totalSize);
             }
             else
             {
@@ -521,8 +1033,7 @@ namespace WPEFramework {
                 error_str = std::to_string(res) + std::string(":'") + std::string(curl_easy_strerror(res)) + std::string("'");
                 call_succeeded = false;
             }
-            //clean up curl object
-            curl_easy_cleanup(curl);
+            //the handle itself is kept, only the header list goes
             curl_slist_free_all(chunk);
 
             return call_succeeded;
@@ -19,13 +19,20 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "Module.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
 #include "libIBus.h"
 //#include "irMgr.h"
+#include "audio_encoder.h"
 
 class socket_adaptor;
+class pcm_stream_server;
 
 namespace WPEFramework {
     namespace Plugin {
@@ -45,12 +52,27 @@ namespace WPEFramework {
             static const string SERVICE_NAME;
             static const string METHOD_ENABLE_AUDIO_CAPTURE;
             static const string METHOD_GET_AUDIO_CLIP;
+            static const string METHOD_START_AUDIO_STREAM;
+            static const string METHOD_STOP_AUDIO_STREAM;
+            static const string METHOD_GET_AUDIO_STREAM_STATUS;
             static const string EVT_ON_AUDIO_CLIP_READY;
 
         private/*registered methods*/:
             //methods
             uint32_t enableAudioCaptureWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getAudioClipWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t startAudioStreamWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t stopAudioStreamWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getAudioStreamStatusWrapper(const JsonObject& parameters, JsonObject& response);
+
+        private/*internal types*/:
+            struct ClipJob
+            {
+                string dataLocator;
+                string url;
+                audio_encoder::codec_t codec;
+                audio_encoder::pcm_format format;
+            };
 
         private/*internal methods*/:
             DataCapture(const DataCapture&) = delete;
@@ -63,7 +85,19 @@ namespace WPEFramework {
             int enableAudioCapture(unsigned int bufferMaxDuration);
             int getAudioClip(const JsonObject& clipRequest);
             void constructFormatString();
-            bool uploadDataToUrl(std::vector<unsigned char> &data, const char *url, std::string &error_str);
+            static string getFormatString(const audiocapturemgr::audio_properties_ifce_t& properties);
+            static unsigned int getFrameSize(const audiocapturemgr::audio_properties_ifce_t& properties);
+            static unsigned int getSamplingRate(const audiocapturemgr::audio_properties_ifce_t& properties);
+            static audio_encoder::pcm_format getPcmFormat(const audiocapturemgr::audio_properties_ifce_t& properties);
+            bool prepareStreamDirectory();
+            int startAudioStream(const string& path);
+            void stopAudioStream();
+            void streamReader(const string acmPath);
+            void startClipWorker();
+            void stopClipWorker();
+            void clipWorker();
+            void deliverClip(const ClipJob& job);
+            bool uploadClipToUrl(const char *firstChunk, size_t firstChunkSize, const char *url, audio_encoder::codec_t &codec, const audio_encoder::pcm_format &format, std::string &error_str);
         private/*members*/:
             audiocapturemgr::session_id_t _session_id;
             unsigned int _max_supported_duration;
@@ -73,7 +107,26 @@ namespace WPEFramework {
             string _destination_url;
             bool _is_precapture;
             unsigned int _duration;
+            audio_encoder::codec_t _codec;
             static pthread_mutex_t _mutex;
+
+            // clips are read from the socket and uploaded on the worker, not on the IARM event thread
+            std::thread _clip_worker;
+            std::mutex _clip_mutex;
+            std::condition_variable _clip_condition;
+            std::deque<ClipJob> _clip_queue;
+            bool _clip_worker_running;
+            void *_curl;
+
+            // live audio of a realtime session, served to local clients on a unix socket
+            audiocapturemgr::session_id_t _stream_session_id;
+            pcm_stream_server* _stream_server;
+            string _stream_format_string;
+            std::thread _stream_reader;
+            std::mutex _stream_call_mutex;
+            std::mutex _stream_mutex;
+            std::condition_variable _stream_condition;
+            bool _stream_running;
         };
     } // namespace Plugin
 } // namespace WPEFramework
@@ -0,0 +1,412 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "audio_encoder.h"
+#include "socket_adaptor.h"
+#include <algorithm>
+#include <string.h>
+
+#ifdef HAS_FLAC
+#include <FLAC/stream_encoder.h>
+#endif
+
+#ifdef HAS_OPUS
+#include <opus/opus.h>
+#include <ogg/ogg.h>
+#endif
+
+namespace
+{
+#ifdef HAS_FLAC
+	const unsigned int FLAC_COMPRESSION_LEVEL = 5;
+
+	class flac_encoder : public audio_encoder
+	{
+		public:
+		flac_encoder(const pcm_format &format, const writer_t &writer) : audio_encoder(format, writer), m_encoder(FLAC__stream_encoder_new()), m_failed(false)
+		{
+		}
+
+		~flac_encoder()
+		{
+			if(m_encoder)
+			{
+				FLAC__stream_encoder_delete(m_encoder);
+			}
+		}
+
+		bool init()
+		{
+			if(!m_encoder)
+			{
+				return false;
+			}
+			FLAC__stream_encoder_set_channels(m_encoder, m_format.channels);
+			FLAC__stream_encoder_set_bits_per_sample(m_encoder, m_format.bits_per_sample);
+			FLAC__stream_encoder_set_sample_rate(m_encoder, m_format.sample_rate);
+			FLAC__stream_encoder_set_compression_level(m_encoder, FLAC_COMPRESSION_LEVEL);
+			/*Without seek and tell callbacks the stream is written once, front to back*/
+			FLAC__StreamEncoderInitStatus status = FLAC__stream_encoder_init_stream(m_encoder, write_callback, NULL, NULL, NULL, this);
+			if(FLAC__STREAM_ENCODER_INIT_STATUS_OK != status)
+			{
+				SA_ERR("FLAC encoder init failed: %s\n", FLAC__StreamEncoderInitStatusString[status]);
+				return false;
+			}
+			return true;
+		}
+
+		bool finish()
+		{
+			bool finished = FLAC__stream_encoder_finish(m_encoder);
+			return finished && !m_failed;
+		}
+
+		protected:
+		bool encode(const char * pcm, size_t frames)
+		{
+			size_t samples = frames * m_format.channels;
+			m_samples.resize(samples);
+			for(size_t i = 0; i < samples; i++)
+			{
+				m_samples[i] = sample(pcm, i);
+			}
+			return FLAC__stream_encoder_process_interleaved(m_encoder, &m_samples[0], frames) && !m_failed;
+		}
+
+		private:
+		static FLAC__StreamEncoderWriteStatus write_callback(const FLAC__StreamEncoder *, const FLAC__byte buffer[], size_t bytes, unsigned, unsigned, void *client_data)
+		{
+			flac_encoder * encoder = static_cast<flac_encoder *>(client_data);
+			if(!encoder->m_writer((const char *)buffer, bytes))
+			{
+				encoder->m_failed = true;
+				return FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+			}
+			return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+		}
+
+		FLAC__StreamEncoder * m_encoder;
+		std::vector<FLAC__int32> m_samples;
+		bool m_failed;
+	};
+#endif
+
+#ifdef HAS_OPUS
+	/*20 ms packets at 24 kbit/s per channel are plenty for speech and music recognition*/
+	const unsigned int OPUS_FRAME_MS = 20;
+	const int OPUS_BITRATE_PER_CHANNEL = 24000;
+	const unsigned int OPUS_GRANULE_RATE = 48000;
+
+	class ogg_opus_encoder : public audio_encoder
+	{
+		public:
+		ogg_opus_encoder(const pcm_format &format, const writer_t &writer) : audio_encoder(format, writer), m_encoder(nullptr), m_granule(0), m_packet_number(0),
+			m_packet_frames(format.sample_rate * OPUS_FRAME_MS / 1000), m_pending_frames(0)
+		{
+			ogg_stream_init(&m_stream, 1);
+		}
+
+		~ogg_opus_encoder()
+		{
+			if(m_encoder)
+			{
+				opus_encoder_destroy(m_encoder);
+			}
+			ogg_stream_clear(&m_stream);
+		}
+
+		bool init()
+		{
+			int error = OPUS_OK;
+			m_encoder = opus_encoder_create(m_format.sample_rate, m_format.channels, OPUS_APPLICATION_VOIP, &error);
+			if(OPUS_OK != error)
+			{
+				SA_ERR("Opus encoder init failed: %s\n", opus_strerror(error));
+				m_encoder = nullptr;
+				return false;
+			}
+			opus_encoder_ctl(m_encoder, OPUS_SET_BITRATE(OPUS_BITRATE_PER_CHANNEL * m_format.channels));
+			opus_int32 lookahead = 0;
+			opus_encoder_ctl(m_encoder, OPUS_GET_LOOKAHEAD(&lookahead));
+			m_pcm.resize(m_packet_frames * m_format.channels);
+			m_packet.resize(4000);
+
+			/*Identification header, RFC 7845 section 5.1*/
+			unsigned char head[19] = { 'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1, (unsigned char)m_format.channels };
+			unsigned int pre_skip = lookahead * (OPUS_GRANULE_RATE / m_format.sample_rate);
+			head[10] = pre_skip & 0xff;
+			head[11] = (pre_skip >> 8) & 0xff;
+			/*Granule positions include the pre-skip, decoders drop it again*/
+			m_granule = pre_skip;
+			for(int i = 0; i < 4; i++)
+			{
+				head[12 + i] = (m_format.sample_rate >> (8 * i)) & 0xff;
+			}
+			/*Comment header, RFC 7845 section 5.2, with a vendor string and no comments*/
+			static const char vendor[] = "DataCapture";
+			std::vector<unsigned char> tags(8 + 4 + sizeof(vendor) - 1 + 4, 0);
+			memcpy(&tags[0], "OpusTags", 8);
+			tags[8] = sizeof(vendor) - 1;
+			memcpy(&tags[12], vendor, sizeof(vendor) - 1);
+
+			/*Both headers end a page of their own*/
+			return add_packet(head, sizeof(head), 0, true, false) && add_packet(&tags[0], tags.size(), 0, true, false);
+		}
+
+		bool finish()
+		{
+			/*The last packet is padded with silence and ends the stream*/
+			size_t frames = m_pending_frames;
+			if(0 < frames)
+			{
+				memset(&m_pcm[frames * m_format.channels], 0, (m_packet_frames - frames) * m_format.channels * sizeof(opus_int16));
+			}
+			else
+			{
+				memset(&m_pcm[0], 0, m_pcm.size() * sizeof(opus_int16));
+			}
+			m_pending_frames = 0;
+			return encode_packet(frames, true);
+		}
+
+		protected:
+		bool encode(const char * pcm, size_t frames)
+		{
+			for(size_t frame = 0; frame < frames; frame++)
+			{
+				for(unsigned int channel = 0; channel < m_format.channels; channel++)
+				{
+					/*24 bit samples keep their top 16 bits, the encoder does not use more for speech*/
+					int value = sample(pcm, frame * m_format.channels + channel);
+					m_pcm[m_pending_frames * m_format.channels + channel] = (opus_int16)(value >> (m_format.bits_per_sample - 16));
+				}
+				if(++m_pending_frames == m_packet_frames)
+				{
+					m_pending_frames = 0;
+					if(!encode_packet(m_packet_frames, false))
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		private:
+		bool encode_packet(size_t frames, bool last)
+		{
+			opus_int32 size = opus_encode(m_encoder, &m_pcm[0], m_packet_frames, &m_packet[0], m_packet.size());
+			if(0 > size)
+			{
+				SA_ERR("Opus encoding failed: %s\n", opus_strerror(size));
+				return false;
+			}
+			/*The granule position counts 48 kHz samples up to the end of the real audio, so the padding is trimmed*/
+			m_granule += frames * (OPUS_GRANULE_RATE / m_format.sample_rate);
+			return add_packet(&m_packet[0], size, m_granule, last, last);
+		}
+
+		bool add_packet(unsigned char * data, size_t size, ogg_int64_t granule, bool flush, bool last)
+		{
+			ogg_packet packet;
+			packet.packet = data;
+			packet.bytes = size;
+			packet.b_o_s = (0 == m_packet_number) ? 1 : 0;
+			packet.e_o_s = last ? 1 : 0;
+			packet.granulepos = granule;
+			packet.packetno = m_packet_number++;
+			ogg_stream_packetin(&m_stream, &packet);
+
+			ogg_page page;
+			while(flush ? ogg_stream_flush(&m_stream, &page) : ogg_stream_pageout(&m_stream, &page))
+			{
+				if(!m_writer((const char *)page.header, page.header_len) || !m_writer((const char *)page.body, page.body_len))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		OpusEncoder * m_encoder;
+		ogg_stream_state m_stream;
+		ogg_int64_t m_granule;
+		ogg_int64_t m_packet_number;
+		size_t m_packet_frames;
+		size_t m_pending_frames;
+		std::vector<opus_int16> m_pcm;
+		std::vector<unsigned char> m_packet;
+	};
+#endif
+}
+
+audio_encoder::audio_encoder(const pcm_format &format, const writer_t &writer) : m_format(format), m_writer(writer),
+	m_frame_size(format.channels * format.bits_per_sample / 8)
+{
+}
+
+audio_encoder::~audio_encoder()
+{
+}
+
+bool audio_encoder::write(const char * pcm, size_t size)
+{
+	/*A frame split between two reads is completed first*/
+	if(!m_partial_frame.empty())
+	{
+		size_t length = std::min(size, m_frame_size - m_partial_frame.size());
+		m_partial_frame.insert(m_partial_frame.end(), pcm, pcm + length);
+		pcm += length;
+		size -= length;
+		if(m_partial_frame.size() < m_frame_size)
+		{
+			return true;
+		}
+		if(!encode(&m_partial_frame[0], 1))
+		{
+			return false;
+		}
+		m_partial_frame.clear();
+	}
+
+	size_t frames = size / m_frame_size;
+	if((0 < frames) && !encode(pcm, frames))
+	{
+		return false;
+	}
+	m_partial_frame.assign(pcm + frames * m_frame_size, pcm + size);
+	return true;
+}
+
+int audio_encoder::sample(const char * pcm, size_t i) const
+{
+	const unsigned char * bytes = (const unsigned char *)pcm;
+	if(24 == m_format.bits_per_sample)
+	{
+		bytes += i * 3;
+		return (int)(((unsigned int)bytes[0] << 8) | ((unsigned int)bytes[1] << 16) | ((unsigned int)bytes[2] << 24)) >> 8;
+	}
+	bytes += i * 2;
+	return (short)(bytes[0] | (bytes[1] << 8));
+}
+
+bool audio_encoder::parse_codec(const std::string &name, codec_t &codec)
+{
+	if("pcm" == name)
+	{
+		codec = PCM;
+	}
+	else if("flac" == name)
+	{
+		codec = FLAC;
+	}
+	else if("opus" == name)
+	{
+		codec = OPUS;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+const char * audio_encoder::get_codec_name(codec_t codec)
+{
+	switch(codec)
+	{
+		case FLAC:
+			return "flac";
+		case OPUS:
+			return "opus";
+		default:
+			return "pcm";
+	}
+}
+
+const char * audio_encoder::get_content_type(codec_t codec)
+{
+	switch(codec)
+	{
+		case FLAC:
+			return "audio/flac";
+		case OPUS:
+			return "audio/ogg";
+		default:
+			return "audio/x-wav";
+	}
+}
+
+audio_encoder::codec_t audio_encoder::negotiate(codec_t requested, const pcm_format &format)
+{
+	bool supported = false;
+	bool valid_format = (0 < format.sample_rate) && (0 < format.channels) && ((16 == format.bits_per_sample) || (24 == format.bits_per_sample));
+	switch(requested)
+	{
+		case FLAC:
+#ifdef HAS_FLAC
+			supported = valid_format && (8 >= format.channels);
+#endif
+			break;
+		case OPUS:
+#ifdef HAS_OPUS
+			/*Opus takes 8, 12, 16, 24 and 48 kHz only, and one stream is at most stereo*/
+			supported = valid_format && (2 >= format.channels) && (0 == OPUS_GRANULE_RATE % format.sample_rate) && (8000 <= format.sample_rate);
+#endif
+			break;
+		default:
+			break;
+	}
+	UNUSED(valid_format);
+	return supported ? requested : PCM;
+}
+
+std::unique_ptr<audio_encoder> audio_encoder::create(codec_t codec, const pcm_format &format, const writer_t &writer)
+{
+	switch(codec)
+	{
+#ifdef HAS_FLAC
+		case FLAC:
+		{
+			std::unique_ptr<flac_encoder> encoder(new flac_encoder(format, writer));
+			if(encoder->init())
+			{
+				return std::unique_ptr<audio_encoder>(encoder.release());
+			}
+			break;
+		}
+#endif
+#ifdef HAS_OPUS
+		case OPUS:
+		{
+			std::unique_ptr<ogg_opus_encoder> encoder(new ogg_opus_encoder(format, writer));
+			if(encoder->init())
+			{
+				return std::unique_ptr<audio_encoder>(encoder.release());
+			}
+			break;
+		}
+#endif
+		default:
+			break;
+	}
+	UNUSED(format);
+	UNUSED(writer);
+	return std::unique_ptr<audio_encoder>();
+}
@@ -0,0 +1,96 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef _audio_encoder_H_
+#define _audio_encoder_H_
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+/**
+ *  Compresses captured PCM (little endian, interleaved) while it is read, handing the encoded
+ *  stream to a writer in the order it is produced. FLAC is lossless, Opus is meant for speech.
+ *  Each codec is only available when its library was found at build time.
+ */
+class audio_encoder
+{
+	public:
+	typedef enum
+	{
+		PCM = 0,
+		FLAC,
+		OPUS
+	} codec_t;
+
+	struct pcm_format
+	{
+		unsigned int sample_rate;
+		unsigned int channels;
+		unsigned int bits_per_sample;
+	};
+
+	/*returns false to stop the encoder*/
+	typedef std::function<bool(const char * data, size_t size)> writer_t;
+
+	virtual ~audio_encoder();
+
+    /**
+     *  @brief Encodes PCM, any size, frames may be split between calls.
+     *
+     *  @return Returns false when the encoder or the writer failed.
+     */
+	bool write(const char * pcm, size_t size);
+
+    /**
+     *  @brief Encodes what is left and ends the stream.
+     */
+	virtual bool finish() = 0;
+
+	static bool parse_codec(const std::string &name, codec_t &codec);
+	static const char * get_codec_name(codec_t codec);
+	static const char * get_content_type(codec_t codec);
+
+    /**
+     *  @brief The codec the clip is actually sent in, PCM when the requested one is not built in
+     *  or cannot encode the format.
+     */
+	static codec_t negotiate(codec_t requested, const pcm_format &format);
+
+    /**
+     *  @brief This api creates an encoder for a negotiated codec other than PCM.
+     */
+	static std::unique_ptr<audio_encoder> create(codec_t codec, const pcm_format &format, const writer_t &writer);
+
+	protected:
+	audio_encoder(const pcm_format &format, const writer_t &writer);
+
+	/*whole frames only*/
+	virtual bool encode(const char * pcm, size_t frames) = 0;
+
+	/*sample i of the interleaved frames, sign extended*/
+	int sample(const char * pcm, size_t i) const;
+
+	pcm_format m_format;
+	writer_t m_writer;
+	size_t m_frame_size;
+	std::vector<char> m_partial_frame;
+};
+#endif //_audio_encoder_H_
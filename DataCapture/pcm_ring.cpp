@@ -0,0 +1,109 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "pcm_ring.h"
+#include <algorithm>
+#include <string.h>
+
+pcm_ring::pcm_ring(size_t capacity, unsigned int frame_size) : m_frame_size(frame_size ? frame_size : 1), m_reserved(0), m_committed(0)
+{
+	size_t size = 1;
+	while(size < capacity)
+	{
+		size <<= 1;
+	}
+	m_buffer.resize(size);
+	m_mask = size - 1;
+}
+
+void pcm_ring::write(const char * buffer, size_t size)
+{
+	/*Only the newest capacity bytes survive a larger write*/
+	if(size > m_buffer.size())
+	{
+		buffer += size - m_buffer.size();
+		size = m_buffer.size();
+	}
+
+	uint64_t position = m_committed.load(std::memory_order_relaxed);
+	m_reserved.store(position + size, std::memory_order_relaxed);
+	/*Readers that see any of the new bytes also see the reservation that invalidates the old ones*/
+	std::atomic_thread_fence(std::memory_order_release);
+
+	size_t offset = position & m_mask;
+	size_t first = std::min(size, m_buffer.size() - offset);
+	memcpy(&m_buffer[offset], buffer, first);
+	memcpy(&m_buffer[0], buffer + first, size - first);
+
+	m_committed.store(position + size, std::memory_order_release);
+}
+
+uint64_t pcm_ring::get_write_position() const
+{
+	return m_committed.load(std::memory_order_acquire);
+}
+
+size_t pcm_ring::get_capacity() const
+{
+	return m_buffer.size();
+}
+
+uint64_t pcm_ring::oldest(uint64_t write_position) const
+{
+	if(write_position <= m_buffer.size())
+	{
+		return 0;
+	}
+	/*Rounded up to the next frame so that the reader stays frame aligned*/
+	uint64_t position = write_position - m_buffer.size();
+	return ((position + m_frame_size - 1) / m_frame_size) * m_frame_size;
+}
+
+size_t pcm_ring::read(uint64_t &cursor, char * buffer, size_t size, uint64_t &lost_bytes) const
+{
+	lost_bytes = 0;
+	while(true)
+	{
+		uint64_t committed = m_committed.load(std::memory_order_acquire);
+		uint64_t start = oldest(committed);
+		if(cursor < start)
+		{
+			lost_bytes += start - cursor;
+			cursor = start;
+		}
+		if(cursor >= committed)
+		{
+			return 0;
+		}
+
+		size_t length = std::min<uint64_t>(size, committed - cursor);
+		size_t offset = cursor & m_mask;
+		size_t first = std::min(length, m_buffer.size() - offset);
+		memcpy(buffer, &m_buffer[offset], first);
+		memcpy(buffer + first, &m_buffer[0], length - first);
+
+		/*The copy is only valid when the producer did not start to overwrite it meanwhile*/
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t reserved = m_reserved.load(std::memory_order_relaxed);
+		if(reserved <= cursor + m_buffer.size())
+		{
+			return length;
+		}
+	}
+}
@@ -0,0 +1,76 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef _pcm_ring_H_
+#define _pcm_ring_H_
+#include <atomic>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ *  Single producer ring of PCM bytes that any number of readers follow with their own cursor.
+ *
+ *  Neither side locks or waits. The producer never blocks and overwrites the oldest data, a
+ *  reader that falls more than the capacity behind loses the overwritten bytes and is moved
+ *  forward to the oldest data still present, on a frame boundary. Positions are absolute byte
+ *  counts since the ring was created, so that a cursor never wraps.
+ */
+class pcm_ring
+{
+	public:
+    /**
+     *  @param[in] capacity    Ring size in bytes, rounded up to a power of two.
+     *  @param[in] frame_size  Bytes per audio frame, readers that lose data resume on a frame boundary.
+     */
+	pcm_ring(size_t capacity, unsigned int frame_size);
+
+    /**
+     *  @brief Appends data, overwriting the oldest data when the ring is full. Only one thread may write.
+     */
+	void write(const char * buffer, size_t size);
+
+    /**
+     *  @brief This api returns the position following the last written byte.
+     */
+	uint64_t get_write_position() const;
+
+    /**
+     *  @brief Copies up to size bytes starting at cursor, without moving the cursor.
+     *
+     *  @param[in,out] cursor      Read position, moved forward when the data at it was overwritten.
+     *  @param[out]    lost_bytes  Number of bytes the cursor was moved forward by.
+     *
+     *  @return Returns the number of bytes copied.
+     */
+	size_t read(uint64_t &cursor, char * buffer, size_t size, uint64_t &lost_bytes) const;
+
+	size_t get_capacity() const;
+
+	private:
+	uint64_t oldest(uint64_t write_position) const;
+
+	std::vector<char> m_buffer;
+	size_t m_mask;
+	unsigned int m_frame_size;
+	// bytes up to m_reserved may be being written, bytes up to m_committed are complete
+	std::atomic<uint64_t> m_reserved;
+	std::atomic<uint64_t> m_committed;
+};
+#endif //_pcm_ring_H_
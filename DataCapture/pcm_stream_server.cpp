@@ -0,0 +1,321 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "pcm_stream_server.h"
+#include "socket_adaptor.h"
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+static const unsigned int MAX_SUBSCRIBERS = 8;
+static const size_t SEND_CHUNK_SIZE = 16 * 1024;
+/*Only the plugin's user and group may listen to the audio*/
+static const mode_t SOCKET_MODE = 0660;
+
+pcm_stream_server::pcm_stream_server(size_t ring_size, unsigned int frame_size) : m_listen_fd(-1), m_event_fd(-1), m_running(false), m_next_id(1), m_ring(ring_size, frame_size)
+{
+}
+
+pcm_stream_server::~pcm_stream_server()
+{
+	stop();
+}
+
+int pcm_stream_server::start(const std::string &path)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_running)
+	{
+		SA_WARN("Already serving %s\n", m_path.c_str());
+		return -1;
+	}
+
+	struct sockaddr_un bind_path;
+	memset(&bind_path, 0, sizeof(bind_path));
+	bind_path.sun_family = AF_UNIX;
+	if(path.empty() || (path.size() >= sizeof(bind_path.sun_path)))
+	{
+		SA_ERR("Socket path %s is too long.\n", path.c_str());
+		return -1;
+	}
+	memcpy(bind_path.sun_path, path.c_str(), path.size());
+
+	/*Only a socket left behind by an earlier run is replaced, nothing else is ever removed*/
+	struct stat path_stat;
+	if(0 == lstat(path.c_str(), &path_stat))
+	{
+		if(!S_ISSOCK(path_stat.st_mode))
+		{
+			SA_ERR("%s exists and is not a socket.\n", path.c_str());
+			return -1;
+		}
+		unlink(path.c_str());
+	}
+
+	m_listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(0 > m_listen_fd)
+	{
+		SA_ERR("Could not open socket.\n");
+		return -1;
+	}
+
+	if(0 != bind(m_listen_fd, (const struct sockaddr *) &bind_path, sizeof(bind_path)))
+	{
+		SA_ERR("Failed to bind %s. errno: 0x%x\n", path.c_str(), errno);
+		close(m_listen_fd);
+		m_listen_fd = -1;
+		return -1;
+	}
+	/*The socket is created with the process umask, narrow it before anyone can connect*/
+	if((0 != chmod(path.c_str(), SOCKET_MODE)) || (0 != listen(m_listen_fd, MAX_SUBSCRIBERS)))
+	{
+		SA_ERR("Failed to listen on %s. errno: 0x%x\n", path.c_str(), errno);
+		close(m_listen_fd);
+		m_listen_fd = -1;
+		unlink(path.c_str());
+		return -1;
+	}
+
+	m_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(0 > m_event_fd)
+	{
+		SA_ERR("Could not create eventfd.\n");
+		close(m_listen_fd);
+		m_listen_fd = -1;
+		unlink(path.c_str());
+		return -1;
+	}
+
+	m_path = path;
+	m_running = true;
+	m_thread = std::thread(&pcm_stream_server::worker_thread, this);
+	SA_INFO("Serving PCM on %s\n", m_path.c_str());
+	return 0;
+}
+
+void pcm_stream_server::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(!m_running)
+		{
+			return;
+		}
+		m_running = false;
+	}
+	wake();
+	m_thread.join();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for(std::list<subscriber>::iterator it = m_subscribers.begin(); it != m_subscribers.end(); ++it)
+	{
+		close(it->fd);
+	}
+	m_subscribers.clear();
+	close(m_event_fd);
+	m_event_fd = -1;
+	close(m_listen_fd);
+	m_listen_fd = -1;
+	unlink(m_path.c_str());
+	m_path.clear();
+}
+
+void pcm_stream_server::push(const char * buffer, size_t size)
+{
+	m_ring.write(buffer, size);
+	wake();
+}
+
+void pcm_stream_server::wake()
+{
+	uint64_t value = 1;
+	int ret = write(m_event_fd, &value, sizeof(value));
+	UNUSED(ret);
+}
+
+std::string pcm_stream_server::get_path()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_path;
+}
+
+uint64_t pcm_stream_server::get_bytes_received() const
+{
+	return m_ring.get_write_position();
+}
+
+void pcm_stream_server::get_subscribers(std::vector<subscriber_info> &subscribers)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	subscribers.clear();
+	for(std::list<subscriber>::const_iterator it = m_subscribers.begin(); it != m_subscribers.end(); ++it)
+	{
+		subscriber_info info = { it->id, it->bytes_sent, it->bytes_lost, it->overruns };
+		subscribers.push_back(info);
+	}
+}
+
+void pcm_stream_server::accept_subscriber()
+{
+	int fd = accept4(m_listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if(0 > fd)
+	{
+		SA_ERR("Error accepting connection. errno: 0x%x\n", errno);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_subscribers.size() >= MAX_SUBSCRIBERS)
+	{
+		SA_WARN("Too many clients, refusing a new one.\n");
+		close(fd);
+		return;
+	}
+	/*A new client starts with the live audio, not with what the ring still holds*/
+	subscriber sub = { fd, m_next_id++, m_ring.get_write_position(), 0, 0, 0, false };
+	m_subscribers.push_back(sub);
+	SA_INFO("Client %d connected. Total clients now is %u\n", sub.id, (unsigned int)m_subscribers.size());
+}
+
+bool pcm_stream_server::send_pending(subscriber &sub, char * buffer, size_t size)
+{
+	sub.blocked = false;
+	while(true)
+	{
+		uint64_t lost_bytes = 0;
+		size_t length = m_ring.read(sub.cursor, buffer, size, lost_bytes);
+		if(0 < lost_bytes)
+		{
+			sub.bytes_lost += lost_bytes;
+			sub.overruns++;
+		}
+		if(0 == length)
+		{
+			return true;
+		}
+
+		ssize_t sent = send(sub.fd, buffer, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if(0 > sent)
+		{
+			if((EAGAIN == errno) || (EWOULDBLOCK == errno))
+			{
+				sub.blocked = true;
+				return true;
+			}
+			if(EINTR == errno)
+			{
+				continue;
+			}
+			return false;
+		}
+		/*Only what was sent is consumed, the rest is sent again from the ring*/
+		sub.cursor += sent;
+		sub.bytes_sent += sent;
+		if((size_t)sent < length)
+		{
+			sub.blocked = true;
+			return true;
+		}
+	}
+}
+
+void pcm_stream_server::worker_thread()
+{
+	SA_INFO("Enter\n");
+	std::vector<char> buffer(SEND_CHUNK_SIZE);
+	std::vector<struct pollfd> fds;
+
+	while(true)
+	{
+		fds.clear();
+		struct pollfd control = { m_event_fd, POLLIN, 0 };
+		struct pollfd listener = { m_listen_fd, POLLIN, 0 };
+		fds.push_back(control);
+		fds.push_back(listener);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(!m_running)
+			{
+				break;
+			}
+			for(std::list<subscriber>::const_iterator it = m_subscribers.begin(); it != m_subscribers.end(); ++it)
+			{
+				/*Clients never send, a readable socket means that the client went away*/
+				struct pollfd client = { it->fd, (short)(POLLIN | (it->blocked ? POLLOUT : 0)), 0 };
+				fds.push_back(client);
+			}
+		}
+
+		int ret = poll(&fds[0], fds.size(), -1);
+		if(0 > ret)
+		{
+			if(EINTR == errno)
+			{
+				continue;
+			}
+			SA_ERR("Error polling. errno: 0x%x\n", errno);
+			break;
+		}
+
+		if(fds[0].revents & POLLIN)
+		{
+			uint64_t value;
+			ret = read(m_event_fd, &value, sizeof(value));
+			UNUSED(ret);
+		}
+		if(fds[1].revents & POLLIN)
+		{
+			accept_subscriber();
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for(std::list<subscriber>::iterator it = m_subscribers.begin(); it != m_subscribers.end();)
+		{
+			bool connected = true;
+			for(size_t i = 2; i < fds.size(); i++)
+			{
+				if((fds[i].fd == it->fd) && (fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+				{
+					char discard[64];
+					connected = (0 < recv(it->fd, discard, sizeof(discard), MSG_DONTWAIT));
+				}
+			}
+			if(connected)
+			{
+				connected = send_pending(*it, &buffer[0], buffer.size());
+			}
+			if(!connected)
+			{
+				SA_INFO("Client %d disconnected after %llu bytes, %u overruns.\n", it->id, (unsigned long long)it->bytes_sent, it->overruns);
+				close(it->fd);
+				it = m_subscribers.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+	SA_INFO("Exit\n");
+}
@@ -0,0 +1,105 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#ifndef _pcm_stream_server_H_
+#define _pcm_stream_server_H_
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pcm_ring.h"
+
+/**
+ *  Serves live PCM to local clients over a unix domain socket.
+ *
+ *  The producer pushes audio into a pcm_ring and wakes the sender thread, which writes the new
+ *  data to every connected client from that client's own cursor. A client that cannot keep up
+ *  is never waited for, it loses the audio the ring overwrote and that is counted as an overrun.
+ */
+class pcm_stream_server
+{
+	public:
+	struct subscriber_info
+	{
+		int id;
+		uint64_t bytes_sent;
+		uint64_t bytes_lost;
+		unsigned int overruns;
+	};
+
+	private:
+	struct subscriber
+	{
+		int fd;
+		int id;
+		uint64_t cursor;
+		uint64_t bytes_sent;
+		uint64_t bytes_lost;
+		unsigned int overruns;
+		bool blocked;
+	};
+
+	std::string m_path;
+	int m_listen_fd;
+	int m_event_fd;
+	bool m_running;
+	int m_next_id;
+	pcm_ring m_ring;
+	std::list<subscriber> m_subscribers;
+	std::thread m_thread;
+	std::mutex m_mutex;
+
+	void worker_thread();
+	void accept_subscriber();
+	bool send_pending(subscriber &sub, char * buffer, size_t size);
+	void wake();
+
+	public:
+    /**
+     *  @param[in] ring_size   Audio kept for the clients in bytes, a client that falls further behind loses audio.
+     *  @param[in] frame_size  Bytes per audio frame, clients always resume on a frame boundary.
+     */
+	pcm_stream_server(size_t ring_size, unsigned int frame_size);
+	~pcm_stream_server();
+
+    /**
+     *  @brief This api makes the server listen for clients on the given unix domain socket path.
+     *  The socket is only accessible to the user and group of the process. An existing socket at
+     *  the path is replaced, any other existing file makes the call fail.
+     *
+     *  @return Returns 0 on success, -1 otherwise.
+     */
+	int start(const std::string &path);
+
+    /**
+     *  @brief This api disconnects all clients and removes the socket path.
+     */
+	void stop();
+
+    /**
+     *  @brief This api adds captured audio. Only one thread may push, it never blocks.
+     */
+	void push(const char * buffer, size_t size);
+
+	std::string get_path();
+	uint64_t get_bytes_received() const;
+	void get_subscribers(std::vector<subscriber_info> &subscribers);
+};
+#endif //_pcm_stream_server_H_
@@ -24,6 +24,7 @@
 #include <sys/un.h>
 #include <stdio.h>
 #include <errno.h>
+#include <string.h>
 
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE
@@ -31,14 +32,17 @@
 
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/time.h>
 
 static const int PIPE_READ_FD = 0;
 static const int PIPE_WRITE_FD = 1;
-static const unsigned int MAX_CONNECTIONS = 1;
+static const int READ_TIMEOUT_SEC = 5;
+static const int MAX_EVENTS = 2;
 
 static bool g_one_time_init_complete = false;
 
-socket_adaptor::socket_adaptor() : m_listen_fd(-1), m_write_fd(-1), m_read_fd(-1), m_num_connections(0), m_callback(nullptr)
+socket_adaptor::socket_adaptor() : m_listen_fd(-1), m_write_fd(-1), m_read_fd(-1), m_epoll_fd(-1), m_num_connections(0), m_callback(nullptr)
 {
 	SA_INFO("Enter\n");
 	if(!g_one_time_init_complete)
@@ -50,12 +54,19 @@ socket_adaptor::socket_adaptor() : m_listen_fd(-1), m_write_fd(-1), m_read_fd(-1
 		g_one_time_init_complete = true;
 	}
 	REPORT_IF_UNEQUAL(0, pipe2(m_control_pipe, O_NONBLOCK));
+
+	m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.fd = m_control_pipe[PIPE_READ_FD];
+	REPORT_IF_UNEQUAL(0, epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_control_pipe[PIPE_READ_FD], &event));
 }
 
 socket_adaptor::~socket_adaptor()
 {
 	SA_INFO("Enter\n");
 	stop_listening();
+	close(m_epoll_fd);
 	close(m_control_pipe[PIPE_WRITE_FD]);
 	close(m_control_pipe[PIPE_READ_FD]);
 }
@@ -78,9 +89,13 @@ int socket_adaptor::connect_socket(const std::string &path)
         if(connect(m_read_fd, (struct sockaddr *) &address, sizeof(struct sockaddr_un)) == 0)
         {
             SA_INFO("socket connected: %s\n", path.c_str());
+            /*A producer that stalls must not block the reader forever*/
+            struct timeval timeout = { READ_TIMEOUT_SEC, 0 };
+            REPORT_IF_UNEQUAL(0, setsockopt(m_read_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
         } else {
             SA_ERR("connect() failed\n");
             close(m_read_fd);
+            m_read_fd = -1;
             ret = -1;
             return ret;
 
@@ -120,7 +135,8 @@ int socket_adaptor::write_data(const char * buffer, const unsigned int size)
 
 unsigned int socket_adaptor::fetch_data()
 {
-    unsigned int size_recv , total_size = 0, n = 0;
+    unsigned int total_size = 0, n = 0;
+    ssize_t size_recv;
     unsigned short int CHUNK_SIZE = 4096;
     char chunk[CHUNK_SIZE];
 
@@ -135,6 +151,10 @@ unsigned int socket_adaptor::fetch_data()
         memset(chunk ,0 , CHUNK_SIZE);
         if((size_recv =  read(m_read_fd , chunk , CHUNK_SIZE) ) <= 0)
         {
+            if((size_recv < 0) && (EINTR == errno))
+            {
+                continue;
+            }
             break;
         }
         else
@@ -194,6 +214,37 @@ unsigned int socket_adaptor::get_data(char * buffer, const unsigned int size)
     return ret_size;
 }
 
+int socket_adaptor::read_data(char * buffer, const unsigned int size)
+{
+    if(m_read_fd < 0) {
+        SA_ERR("Unable to read data. Did you connect?");
+        return -1;
+    }
+
+    int size_recv;
+    do
+    {
+        size_recv = read(m_read_fd, buffer, size);
+    } while((size_recv < 0) && (EINTR == errno));
+
+    if(size_recv < 0)
+    {
+        SA_ERR("read() failed. errno: 0x%x\n", errno);
+    }
+    return size_recv;
+}
+
+void socket_adaptor::disconnect_socket()
+{
+    lock();
+    if(0 <= m_read_fd)
+    {
+        close(m_read_fd);
+        m_read_fd = -1;
+    }
+    unlock();
+}
+
 std::string& socket_adaptor::get_path()
 {
 	return m_path;
@@ -238,6 +289,10 @@ int socket_adaptor::start_listening(const std::string &path)
 			{
 				SA_INFO("Bound successfully to path.\n");
 				REPORT_IF_UNEQUAL(0, listen(m_listen_fd, 3));
+				struct epoll_event event;
+				event.events = EPOLLIN;
+				event.data.fd = m_listen_fd;
+				REPORT_IF_UNEQUAL(0, epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_listen_fd, &event));
 				m_thread = std::thread(&socket_adaptor::worker_thread, this);
 				break;
 			}
@@ -287,6 +342,12 @@ int socket_adaptor::stop_listening()
 		unlink(m_path.c_str());
 		m_path.clear();
 	}
+	if(0 <= m_listen_fd)
+	{
+		epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, m_listen_fd, NULL);
+		close(m_listen_fd);
+		m_listen_fd = -1;
+	}
 	unlock();
 	SA_INFO("Exit\n");
     return 0;
@@ -331,51 +392,46 @@ void socket_adaptor::worker_thread()
 {
 	SA_INFO("Enter\n");
 	int control_fd = m_control_pipe[PIPE_READ_FD];
-	int max_fd = (m_listen_fd > control_fd ? m_listen_fd : control_fd);
-
+	struct epoll_event events[MAX_EVENTS];
 
 	bool check_fds = true;
 
 	while(check_fds)
 	{
-		fd_set poll_fd_set;
-		FD_ZERO(&poll_fd_set);
-		FD_SET(m_listen_fd, &poll_fd_set);
-		FD_SET(control_fd, &poll_fd_set);
-
-		int ret = select((max_fd + 1), &poll_fd_set, NULL, NULL, NULL);
-		SA_INFO("Unblocking now. ret is 0x%x\n", ret);
-		if(0 == ret)
+		int ret = epoll_wait(m_epoll_fd, events, MAX_EVENTS, -1);
+		if(0 > ret)
 		{
-			SA_ERR("select() returned 0.\n");
+			if(EINTR == errno)
+			{
+				continue;
+			}
+			SA_ERR("SA_ERR polling monitor FD!\n");
+			break;
 		}
-		else if(0 < ret)
+
+		//Some activity was detected. Process event further.
+		for(int i = 0; (i < ret) && check_fds; i++)
 		{
-			//Some activity was detected. Process event further.
-			if(0 != FD_ISSET(control_fd, &poll_fd_set))
+			int fd = events[i].data.fd;
+			if(control_fd == fd)
 			{
 				control_code_t message;
 				REPORT_IF_UNEQUAL((sizeof(message)), read(m_control_pipe[PIPE_READ_FD], &message, sizeof(message)));
 				if(EXIT == message)
 				{
 					SA_INFO("Exiting monitor thread.\n");
-					break;
+					check_fds = false;
 				}
 				else
 				{
 					process_control_message(message);
 				}
 			}
-			if(0 != FD_ISSET(m_listen_fd, &poll_fd_set))
+			else if(m_listen_fd == fd)
 			{
 				process_new_connection();
 			}
 		}
-		else
-		{
-			SA_ERR("SA_ERR polling monitor FD!\n");
-			break;
-		}
 	}
 
 	SA_INFO("Exit\n");
@@ -55,6 +55,7 @@ class socket_adaptor
 	int m_write_fd;
 	int m_read_fd;
 	int m_control_pipe[2];
+	int m_epoll_fd;
     std::vector<unsigned char> m_fetch_buffer;
 	unsigned int m_num_connections;
 	std::thread m_thread;
@@ -133,6 +134,21 @@ class socket_adaptor
      */
     unsigned int get_data(char * buffer, const unsigned int size);
 
+    /**
+     *  @brief This api invokes unix read() once to read the next part of the data straight from the socket
+     *
+     *  @param[in] buffer Data buffer.
+     *  @param[in] size   Size of the buffer
+     *
+     *  @return Returns length of the data, 0 at the end of the data or -1 in case of an error
+     */
+    int read_data(char * buffer, const unsigned int size);
+
+    /**
+     *  @brief This api closes the socket opened by connect_socket()
+     */
+    void disconnect_socket();
+
     /**
      *  @brief This api invokes  close() to terminate the current connection.
      */
@@ -0,0 +1,199 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "socket_adaptor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*DATA_CAPTURE_CLIP_CHUNK_SIZE of DataCapture.cpp*/
+static const size_t CLIP_CHUNK_SIZE = 4 * 1024;
+/*The upload buffer curl asks read_data() to fill by default*/
+static const size_t UPLOAD_BUFFER_SIZE = 16 * 1024;
+static const size_t WRITE_SIZE = 64 * 1024;
+
+typedef size_t (*reader_t)(socket_adaptor &adaptor);
+
+static size_t fetch_whole_clip(socket_adaptor &adaptor)
+{
+	std::vector<unsigned char> data;
+	adaptor.fetch_data();
+	adaptor.get_data(data);
+	return data.size();
+}
+
+static size_t read_in_parts(socket_adaptor &adaptor, size_t part_size)
+{
+	std::vector<char> buffer(part_size);
+	size_t received = 0;
+	int size_recv;
+	while(0 < (size_recv = adaptor.read_data(&buffer[0], buffer.size())))
+	{
+		received += size_recv;
+	}
+	adaptor.disconnect_socket();
+	return received;
+}
+
+static size_t read_clip_chunks(socket_adaptor &adaptor)
+{
+	return read_in_parts(adaptor, CLIP_CHUNK_SIZE);
+}
+
+static size_t read_upload_buffers(socket_adaptor &adaptor)
+{
+	return read_in_parts(adaptor, UPLOAD_BUFFER_SIZE);
+}
+
+/*Sends size bytes to a socket_adaptor connected to path and returns the MB/s at which reader took them*/
+static double run(reader_t reader, const std::string &path, size_t size)
+{
+	int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+	unlink(path.c_str());
+	if((0 > listen_fd) || (0 != bind(listen_fd, (struct sockaddr *) &address, sizeof(address))) || (0 != listen(listen_fd, 1)))
+	{
+		fprintf(stderr, "Cannot listen on %s. errno: 0x%x\n", path.c_str(), errno);
+		if(0 <= listen_fd)
+		{
+			close(listen_fd);
+		}
+		return 0;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::thread producer([listen_fd, size]() {
+		int fd = accept(listen_fd, NULL, NULL);
+		if(0 > fd)
+		{
+			return;
+		}
+		std::vector<char> buffer(WRITE_SIZE, 0x55);
+		size_t sent = 0;
+		while(sent < size)
+		{
+			ssize_t ret = write(fd, &buffer[0], std::min(buffer.size(), size - sent));
+			if(0 > ret)
+			{
+				if(EINTR == errno)
+				{
+					continue;
+				}
+				break;
+			}
+			sent += ret;
+		}
+		close(fd);
+	});
+	socket_adaptor adaptor;
+	size_t received = 0;
+	if(0 == adaptor.connect_socket(path))
+	{
+		received = reader(adaptor);
+	}
+	else
+	{
+		shutdown(listen_fd, SHUT_RDWR);
+	}
+	producer.join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	close(listen_fd);
+	unlink(path.c_str());
+
+	if(received != size)
+	{
+		fprintf(stderr, "received %zu of %zu bytes\n", received, size);
+		return 0;
+	}
+	return (size / (1024.0 * 1024.0)) / elapsed.count();
+}
+
+// Usage: DataCaptureSocketBenchmark [-s MB] [-n iterations]
+// Prints the rate at which socket_adaptor reads a clip from a unix socket, collected whole by
+// fetch_data() and streamed by read_data() in the part sizes DataCapture uses.
+int main(int argc, char **argv)
+{
+	size_t megabytes = 64;
+	int iterations = 5;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if((0 == strcmp(argv[i], "-s")) && (i + 1 < argc))
+		{
+			megabytes = strtoul(argv[++i], NULL, 10);
+		}
+		else if((0 == strcmp(argv[i], "-n")) && (i + 1 < argc))
+		{
+			iterations = atoi(argv[++i]);
+		}
+		else
+		{
+			megabytes = 0;
+		}
+	}
+	if((0 == megabytes) || (0 >= iterations))
+	{
+		fprintf(stderr, "Usage: %s [-s MB] [-n iterations]\n", argv[0]);
+		return 1;
+	}
+
+	struct reader_info
+	{
+		const char * name;
+		reader_t reader;
+	};
+	const reader_info readers[] = {
+		{ "fetch_data() whole clip", fetch_whole_clip },
+		{ "read_data() 4K chunks", read_clip_chunks },
+		{ "read_data() 16K buffers", read_upload_buffers }
+	};
+
+	const std::string path = "/tmp/datacapture-benchmark-" + std::to_string(getpid());
+	printf("%zu MB per run, best and average of %d runs\n", megabytes, iterations);
+	for(size_t r = 0; r < sizeof(readers) / sizeof(readers[0]); r++)
+	{
+		double best = 0;
+		double total = 0;
+		for(int i = 0; i < iterations; i++)
+		{
+			double rate = run(readers[r].reader, path, megabytes * 1024 * 1024);
+			if(0 == rate)
+			{
+				return 1;
+			}
+			best = std::max(best, rate);
+			total += rate;
+		}
+		printf("%-26s %8.0f MB/s %8.0f MB/s\n", readers[r].name, best, total / iterations);
+	}
+	return 0;
+}
@@ -21,6 +21,7 @@
 #define __CENCPARSER_H
 
 #include "Module.h"
+#include <unordered_map>
 
 namespace WPEFramework {
 namespace Plugin {
@@ -109,17 +110,41 @@ namespace Plugin {
             uint32_t _systems;
         };
 
+        // Key ids show up in both GUID endiannesses (PlayReady), which only differ in the
+        // byte order of the first 8 bytes. Hash the last 8 bytes so both variants land in
+        // the same bucket and the KeyId equality decides.
+        struct KeyIdHash {
+            inline size_t operator()(const OCDM::KeyId& key) const
+            {
+                const uint8_t* id = key.Id();
+                const uint8_t length = key.Length();
+                size_t result = 2166136261U;
+
+                for (uint8_t index = (length > 8 ? length - 8 : 0); index < length; index++) {
+                    result = (result ^ id[index]) * 16777619U;
+                }
+                return (result);
+            }
+        };
+
         typedef Core::IteratorType<const std::list<KeyId>, const KeyId&, std::list<KeyId>::const_iterator> Iterator;
 
     public:
         CommonEncryptionData(const uint8_t data[], const uint16_t length)
             : _keyIds()
+            , _index()
         {
             Parse(data, length);
         }
         CommonEncryptionData(const CommonEncryptionData& copy)
             : _keyIds(copy._keyIds)
+            , _index()
         {
+            std::list<KeyId>::iterator index(_keyIds.begin());
+            while (index != _keyIds.end()) {
+                _index.emplace(*index, index);
+                index++;
+            }
         }
         ~CommonEncryptionData()
         {
@@ -134,9 +159,9 @@ namespace Plugin {
         {
             ::OCDM::ISession::KeyStatus result(::OCDM::ISession::StatusPending);
             if (key.IsValid() == true) {
-                std::list<KeyId>::const_iterator index(std::find(_keyIds.begin(), _keyIds.end(), key));
-                if (index != _keyIds.end()) {
-                    result = index->Status();
+                Index::const_iterator index(_index.find(key));
+                if (index != _index.end()) {
+                    result = index->second->Status();
                 }
             }
             return (result);
@@ -147,18 +172,18 @@ namespace Plugin {
         }
         inline bool HasKeyId(const OCDM::KeyId& keyId) const
         {
-            return (std::find(_keyIds.begin(), _keyIds.end(), keyId) != _keyIds.end());
+            return (_index.find(keyId) != _index.end());
         }
         inline void AddKeyId(const KeyId& key)
         {
-            std::list<KeyId>::iterator index(std::find(_keyIds.begin(), _keyIds.end(), key));
+            Index::iterator index(_index.find(key));
 
-            if (index == _keyIds.end()) {
+            if (index == _index.end()) {
                 TRACE(Trace::Information, (_T("Added key: %s for system: %02X\n"), key.ToString().c_str(), key.Systems()));
-                _keyIds.emplace_back(key);
+                Insert(key);
             } else {
                 TRACE(Trace::Information, (_T("Updated key: %s for system: %02X\n"), key.ToString().c_str(), key.Systems()));
-                index->Flag(key.Systems());
+                index->second->Flag(key.Systems());
             }
         }
         inline const KeyId* UpdateKeyStatus(::OCDM::ISession::KeyStatus status, const KeyId& key)
@@ -167,13 +192,12 @@ namespace Plugin {
 
             ASSERT(key.IsValid() == true);
 
-            std::list<KeyId>::iterator index(std::find(_keyIds.begin(), _keyIds.end(), key));
+            Index::iterator index(_index.find(key));
 
-            if (index == _keyIds.end()) {
-                _keyIds.emplace_back(key);
-                entry = &(_keyIds.back());
+            if (index == _index.end()) {
+                entry = &(*Insert(key));
             } else {
-                entry = &(*index);
+                entry = &(*(index->second));
             }
             entry->Status(status);
 
@@ -186,14 +210,7 @@ namespace Plugin {
             std::list<KeyId>::const_iterator requested(keys._keyIds.begin());
 
             while ((requested != keys._keyIds.end()) && (result == true)) {
-                std::list<KeyId>::const_iterator index(_keyIds.begin());
-
-                while ((index != _keyIds.end()) && (*index != *requested)) {
-                    index++;
-                }
-
-                result = (index != _keyIds.end());
-
+                result = (_index.find(*requested) != _index.end());
                 requested++;
             }
 
@@ -203,6 +220,15 @@ namespace Plugin {
             return _keyIds.empty();
         }
     private:
+        typedef std::unordered_map<OCDM::KeyId, std::list<KeyId>::iterator, KeyIdHash> Index;
+
+        inline std::list<KeyId>::iterator Insert(const KeyId& key)
+        {
+            std::list<KeyId>::iterator entry(_keyIds.emplace(_keyIds.end(), key));
+            _index.emplace(key, entry);
+            return (entry);
+        }
+
         uint8_t Base64(const uint8_t value[], const uint8_t sourceLength, uint8_t object[], const uint8_t length)
         {
             uint8_t state = 0;
@@ -252,9 +278,12 @@ namespace Plugin {
 
         void Parse(const uint8_t data[], const uint16_t length)
         {
-            uint16_t offset = 0;
+            // Keep the offset wider than the length, box sizes are 32 bits and
+            // must not wrap the offset back into the buffer.
+            uint32_t offset = 0;
 
-            do {
+            // Every format we recognize needs at least a size and a type.
+            while ((offset + 8) <= length) {
                 // Check if this is a PSSH box...
                 uint32_t size = (data[offset] << 24) | (data[offset + 1] << 16) | (data[offset + 2] << 8) | data[offset + 3];
                 if (size == 0) {
@@ -262,12 +291,14 @@ namespace Plugin {
                     break;
                 }
 
-                if ((size <= static_cast<uint32_t>(length - offset)) && (memcmp(&(data[offset + 4]), PSSHeader, 4) == 0)) {
-                    ParsePSSHBox(&(data[offset + 4 + 4]), size - 4 - 4);
+                const uint32_t remaining = length - offset;
+
+                if ((size <= remaining) && (size >= 8) && (memcmp(&(data[offset + 4]), PSSHeader, 4) == 0)) {
+                    ParsePSSHBox(&(data[offset + 4 + 4]), static_cast<uint16_t>(size - 4 - 4));
                 } else {
                     uint32_t XMLSize = (data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | (data[offset + 3] << 24));
 
-                    if (XMLSize <= static_cast<uint32_t>(length - offset)) {
+                    if ((XMLSize <= remaining) && (XMLSize >= 10)) {
 
                         uint16_t stringLength = (data[offset + 8] | (data[offset + 9] << 8));
                         if (stringLength <= (XMLSize - 10)) {
@@ -279,35 +310,49 @@ namespace Plugin {
                         offset += XMLSize;
 
                     } else if ((offset == 0) && (data[0] == '<') && (data[2] == 'W') && (data[4] == 'R') && (data[6] == 'M')) {
-                        ParseXMLBox(data, size);
+                        ParseXMLBox(data, length);
                         offset = length;
                     } else if (std::string(reinterpret_cast<const char*>(data), length).find(JSONKeyIds) != std::string::npos) {
                         /* keyids initdata type */
                         TRACE(Trace::Information, (_T("Initdata contains clearkey's key ids")));
 
                         ParseJSONInitData(reinterpret_cast<const char*>(data), length);
+                        offset = length;
                     } else {
                         TRACE(Trace::Information, (_T("Have no clue what this is!!! %d\n"), __LINE__));
                     }
                 }
-                offset += size;
 
-            } while (offset < length);
+                if (size > (length - offset)) {
+                    break;
+                }
+                offset += size;
+            }
         }
 
         void ParsePSSHBox(const uint8_t data[], const uint16_t length)
         {
+            // version/flags, system id and the (kid count | data size) field.
+            static constexpr uint16_t HeaderSize = 4 + 16 + 4;
+
+            if (length < HeaderSize) {
+                TRACE(Trace::Information, (_T("PSSH box too small: %d bytes\n"), length));
+                return;
+            }
+
             systemType system(COMMON);
             const uint8_t* psshData(&(data[KeyId::Length() + 4 /* flags */]));
             uint32_t count((psshData[0] << 24) | (psshData[1] << 16) | (psshData[2] << 8) | psshData[3]);
-            uint16_t stringLength = (data[8] | (data[9] << 8));
 
             if (::memcmp(&(data[4]), CommonEncryption, KeyId::Length()) == 0) {
                 psshData += 4;
                 TRACE(Trace::Information, (_T("Common detected [%d]\n"), __LINE__));
             } else if (::memcmp(&(data[4]), PlayReady, KeyId::Length()) == 0) {
-                if (stringLength <= (length - 10)) {
-                    ParseXMLBox(&(psshData[10]), count);
+                // A version 0 box carries the PlayReady object (XML), version 1 lists the key ids.
+                if (data[0] == 0) {
+                    const uint32_t consumed = static_cast<uint32_t>(psshData - data) + 10;
+                    const uint32_t available = (length > consumed ? length - consumed : 0);
+                    ParseXMLBox(&(psshData[10]), static_cast<uint16_t>(count < available ? count : available));
                     TRACE(Trace::Information, (_T("PlayReady XML detected [%d]\n"), __LINE__));
                     count = 0;
                 } else {
@@ -332,6 +377,13 @@ namespace Plugin {
                 count /= KeyId::Length();
             }
 
+            const uint32_t consumed = static_cast<uint32_t>(psshData - data);
+            const uint32_t available = (consumed < length ? (length - consumed) / KeyId::Length() : 0);
+            if (count > available) {
+                TRACE(Trace::Information, (_T("PSSH box announces %d keys, only room for %d\n"), count, available));
+                count = available;
+            }
+
             TRACE(Trace::Information, (_T("Adding %d keys from PSSH box\n"), count));
 
             while (count-- != 0) {
@@ -345,7 +397,7 @@ namespace Plugin {
             uint8_t index = 0;
             uint16_t result = 0;
 
-            while ((result <= length) && (index < keyLength)) {
+            while ((result < length) && (index < keyLength)) {
                 if (static_cast<uint8_t>(key[index]) == data[result]) {
                     index++;
                     result += 2;
@@ -372,7 +424,7 @@ namespace Plugin {
                 // we want to find and process this utf16 string:
                 // <KID>q5HgCTj40kGeNVhTH9Gexw==</KID>
                 //
-                while ((size > 0) && ((begin = FindInXML(slot, size, "<KID>", 5)) < size)) {
+                while ((size > 0) && ((begin = FindInXML(slot, size, "<KID>", 5)) < size) && ((begin + 10) <= size)) {
                     uint16_t end = FindInXML(&(slot[begin + 10]), size - begin - 10, "</KID>", 6);
 
                     if (end < (size - begin - 10)) {
@@ -394,8 +446,9 @@ namespace Plugin {
                             // Add them in both endiannesses, since we have encountered both in the wild.
                             AddKeyId(KeyId(PLAYREADY, a, b, c, d));
                         }
-                        size -= (begin + 10 + end + 12);
-                        slot += (begin + 10 + end + 12);
+                        const uint16_t consumed = begin + 10 + end + 12;
+                        size = (consumed < size ? size - consumed : 0);
+                        slot += consumed;
                     } else {
                         size = 0;
                     }
@@ -410,37 +463,39 @@ namespace Plugin {
                 // <KID ALGID="AESCTR" CHECKSUM="xNvWVxoWk04=" VALUE="0IbHou/5s0yzM80yOkKEpQ=="></KID>
                 //
                 // Now find the string "<KID " in this text
-                while ((size > 0) && ((begin = FindInXML(slot, size, "<KID ", 5)) < size)) {
+                while ((size > 0) && ((begin = FindInXML(slot, size, "<KID ", 5)) < size) && ((begin + 10) <= size)) {
                     uint16_t end = FindInXML(&(slot[begin + 10]), size - begin - 10, "</KID>", 6);
 
-                    uint16_t keyValue = FindInXML(&(slot[begin + 10]), end, "VALUE", 5);  
-                    uint16_t keyStart = FindInXML(&(slot[begin + 10 + keyValue + 10]), end - keyValue - 10, "\"", 1) + 2;
-                    uint16_t keyLength = FindInXML(&(slot[begin + 10 + keyValue + 10 + keyStart]), end - keyValue - 10 - keyStart - 2, "\"", 1) - 2;
-                    
-                    if (end < (size - begin - 10)) {
-                        uint8_t byteArray[32];
-
-                        // We got a KID, translate its
-                        if (Base64(&(slot[begin + 10 + keyValue + 10 + keyStart]), static_cast<uint8_t>(keyLength), byteArray, sizeof(byteArray)) == KeyId::Length()) {
-                            // Pass it the microsoft way :-(
-                            uint32_t a = byteArray[0];
-                            a = (a << 8) | byteArray[1];
-                            a = (a << 8) | byteArray[2];
-                            a = (a << 8) | byteArray[3];
-                            uint16_t b = byteArray[4];
-                            b = (b << 8) | byteArray[5];
-                            uint16_t c = byteArray[6];
-                            c = (c << 8) | byteArray[7];
-                            uint8_t* d = &byteArray[8];
-
-                            // Add them in both endiannesses, since we have encountered both in the wild.
-                            AddKeyId(KeyId(PLAYREADY, a, b, c, d));
-                        }
-                        size -= (begin + 10 + end + 12);
-                        slot += (begin + 10 + end + 12);
-                    } else {
+                    if (end >= (size - begin - 10)) {
                         size = 0;
+                        break;
+                    }
+
+                    uint16_t keyValue = FindInXML(&(slot[begin + 10]), end, "VALUE", 5);
+                    uint16_t keyStart = ((keyValue + 10) < end ? FindInXML(&(slot[begin + 10 + keyValue + 10]), end - keyValue - 10, "\"", 1) + 2 : end);
+                    uint16_t keyLength = ((keyValue + 10 + keyStart + 2) < end ? FindInXML(&(slot[begin + 10 + keyValue + 10 + keyStart]), end - keyValue - 10 - keyStart - 2, "\"", 1) - 2 : 0);
+
+                    uint8_t byteArray[32];
+
+                    // We got a KID, translate its
+                    if ((keyLength > 0) && ((keyValue + 10 + keyStart + keyLength) <= end) && Base64(&(slot[begin + 10 + keyValue + 10 + keyStart]), static_cast<uint8_t>(keyLength), byteArray, sizeof(byteArray)) == KeyId::Length()) {
+                        // Pass it the microsoft way :-(
+                        uint32_t a = byteArray[0];
+                        a = (a << 8) | byteArray[1];
+                        a = (a << 8) | byteArray[2];
+                        a = (a << 8) | byteArray[3];
+                        uint16_t b = byteArray[4];
+                        b = (b << 8) | byteArray[5];
+                        uint16_t c = byteArray[6];
+                        c = (c << 8) | byteArray[7];
+                        uint8_t* d = &byteArray[8];
+
+                        // Add them in both endiannesses, since we have encountered both in the wild.
+                        AddKeyId(KeyId(PLAYREADY, a, b, c, d));
                     }
+                    const uint16_t consumed = begin + 10 + end + 12;
+                    size = (consumed < size ? size - consumed : 0);
+                    slot += consumed;
                 }
         }
 
@@ -478,6 +533,7 @@ namespace Plugin {
 
     private:
         std::list<KeyId> _keyIds;
+        Index _index;
     };
 }
 } // namespace WPEFramework::Plugin
@@ -0,0 +1,133 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DECRYPTOUTPUT_H
+#define __DECRYPTOUTPUT_H
+
+#include <stdint.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Optional interface for a CDMi::IMediaKeySession. A CDM implements it next to
+    // IMediaKeySession when it can deliver the decrypted sample somewhere else than in
+    // a buffer of its own. The session worker negotiates the mode once, before the
+    // first Decrypt, and from then on the CDM writes its output accordingly.
+    struct IDecryptOutput {
+        enum mode : uint8_t {
+            // Decrypt returns a buffer owned by the CDM, the worker copies it back into
+            // the shared buffer. This is what every CDM without this interface does.
+            COPY = 0x01,
+            // Decrypt writes the clear sample into the input (shared) buffer and returns it.
+            IN_PLACE = 0x02,
+            // Decrypt writes an opaque secure buffer handle into the shared buffer and
+            // returns it, the returned size is the size of the handle.
+            SECURE_HANDLE = 0x04
+        };
+
+        virtual ~IDecryptOutput() = default;
+
+        // Bitmask of the modes this CDM can produce.
+        virtual uint8_t OutputModes() const = 0;
+
+        // The mode the CDM has to use for this session.
+        virtual void OutputMode(const mode selected) = 0;
+    };
+
+    // Server side of the negotiation, kept apart from the DataExchange worker so it can be
+    // tested against a stub CDM on the host.
+    class DecryptOutput {
+    private:
+        DecryptOutput() = delete;
+        DecryptOutput(const DecryptOutput&) = delete;
+        DecryptOutput& operator=(const DecryptOutput&) = delete;
+
+    public:
+        static constexpr uint8_t AllModes = IDecryptOutput::COPY | IDecryptOutput::IN_PLACE | IDecryptOutput::SECURE_HANDLE;
+
+        // cdm may be nullptr for CDMs that do not implement IDecryptOutput, supported is the
+        // set of modes the clients of this system can consume.
+        DecryptOutput(IDecryptOutput* cdm, const uint8_t supported = AllModes)
+            : _mode(Negotiate(cdm, supported))
+            , _mismatches(0)
+        {
+        }
+        ~DecryptOutput() = default;
+
+    public:
+        inline IDecryptOutput::mode Mode() const
+        {
+            return (_mode);
+        }
+        inline uint32_t Mismatches() const
+        {
+            return (_mismatches);
+        }
+
+        // Called after a successful Decrypt. Returns true if clearContent still has to be
+        // copied into the shared buffer. A CDM that returns the shared buffer itself is never
+        // copied, even without negotiation, older CDMs already decrypt in place that way.
+        bool CopyBack(const uint8_t* shared, const uint8_t* clearContent)
+        {
+            const bool copy = (clearContent != shared);
+
+            if ((copy == true) && (_mode != IDecryptOutput::COPY)) {
+                // The CDM agreed to write into the shared buffer but did not, copy its result
+                // so the client still gets the sample.
+                _mismatches++;
+            }
+
+            return (copy);
+        }
+
+        // In SECURE_HANDLE mode the returned size is the handle, not the sample.
+        inline bool SizeIsSample() const
+        {
+            return (_mode != IDecryptOutput::SECURE_HANDLE);
+        }
+
+    private:
+        static IDecryptOutput::mode Negotiate(IDecryptOutput* cdm, const uint8_t supported)
+        {
+            IDecryptOutput::mode result = IDecryptOutput::COPY;
+
+            if (cdm != nullptr) {
+                const uint8_t common = (cdm->OutputModes() & supported);
+
+                if ((common & IDecryptOutput::SECURE_HANDLE) != 0) {
+                    result = IDecryptOutput::SECURE_HANDLE;
+                } else if ((common & IDecryptOutput::IN_PLACE) != 0) {
+                    result = IDecryptOutput::IN_PLACE;
+                }
+
+                cdm->OutputMode(result);
+            }
+
+            return (result);
+        }
+
+    private:
+        const IDecryptOutput::mode _mode;
+        uint32_t _mismatches;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __DECRYPTOUTPUT_H
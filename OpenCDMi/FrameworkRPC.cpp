@@ -17,12 +17,16 @@
  * limitations under the License.
  */
 
+#include <chrono>
 #include <regex>
 #include <string>
 #include <vector>
 
 #include "Module.h"
 #include "CENCParser.h"
+#include "DecryptOutput.h"
+#include "IDecryptStatistics.h"
+#include "SessionStatistics.h"
 
 // Get in the definitions required for access to the sepcific
 // DRM engines.
@@ -90,7 +94,7 @@ namespace Plugin {
 
     static const TCHAR BufferFileName[] = _T("ocdmbuffer.");
 
-    class OCDMImplementation : public Exchange::IContentDecryption {
+    class OCDMImplementation : public Exchange::IContentDecryption, public Exchange::IDecryptStatistics {
     private:
         OCDMImplementation(const OCDMImplementation&) = delete;
         OCDMImplementation& operator=(const OCDMImplementation&) = delete;
@@ -249,9 +253,13 @@ namespace Plugin {
                         , _mediaKeysExt(dynamic_cast<CDMi::IMediaKeySessionExt*>(mediaKeys))
                         , _sessionKey(nullptr)
                         , _sessionKeyLength(0)
+                        , _subSamples()
+                        , _output(dynamic_cast<IDecryptOutput*>(mediaKeys))
+                        , _statistics()
                     {
                         Core::Thread::Run();
                         TRACE(Trace::Information, (_T("Constructing buffer server side: %p - %s"), this, name.c_str()));
+                        TRACE(Trace::Information, (_T("Decrypt output mode %d for: %s"), _output.Mode(), name.c_str()));
                     }
                     ~DataExchange()
                     {
@@ -265,7 +273,18 @@ namespace Plugin {
                         Core::Thread::Wait(Core::Thread::STOPPED, Core::infinite);
                     }
 
+                public:
+                    inline const SessionStatistics& Statistics() const
+                    {
+                        return (_statistics);
+                    }
+
                 private:
+                    static uint64_t Elapsed(const std::chrono::steady_clock::time_point& start, const std::chrono::steady_clock::time_point& end)
+                    {
+                        return (static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()));
+                    }
+
                     virtual uint32_t Worker() override
                     {
 
@@ -274,17 +293,25 @@ namespace Plugin {
                             uint32_t clearContentSize = 0;
                             uint8_t* clearContent = nullptr;
 
+                            std::chrono::steady_clock::time_point idle = std::chrono::steady_clock::now();
+
                             RequestConsume(Core::infinite);
 
                             if (IsRunning() == true) {
+                                const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                                const uint32_t encryptedSize = BytesWritten();
+
+                                _statistics.Waited(Elapsed(idle, start));
+
                                 uint8_t keyIdLength = 0;
                                 const uint8_t* keyIdData = KeyId(keyIdLength);
+                                const uint32_t subSampleCount = SubSampleMapping();
 
                                 int cr = _mediaKeys->Decrypt(
                                     _sessionKey,
                                     _sessionKeyLength,
-                                    nullptr, //subsamples
-                                    0, //number of subsamples
+                                    (subSampleCount != 0 ? _subSamples.data() : nullptr),
+                                    subSampleCount,
                                     IVKey(),
                                     IVKeyLength(),
                                     Buffer(),
@@ -294,14 +321,27 @@ namespace Plugin {
                                     keyIdLength,
                                     keyIdData,
                                     InitWithLast15());
+
+                                _statistics.Decrypted(encryptedSize, Elapsed(start, std::chrono::steady_clock::now()), (cr == 0),
+                                    ((cr == 0) && (clearContentSize != 0) && (clearContentSize != encryptedSize) && (_output.SizeIsSample() == true)));
+
                                 if ((cr == 0) && (clearContentSize != 0)) {
                                     if (clearContentSize != BytesWritten()) {
-                                        TRACE(Trace::Information, (_T("Returned clear sample size (%d) differs from encrypted buffer size (%d)"), clearContentSize, BytesWritten()));
+                                        if (_output.SizeIsSample() == true) {
+                                            TRACE(Trace::Information, (_T("Returned clear sample size (%d) differs from encrypted buffer size (%d)"), clearContentSize, BytesWritten()));
+                                        }
                                         Size(clearContentSize);
                                     }
 
-                                    // Adjust the buffer on our sied (this process) on what we will write back
-                                    SetBuffer(0, clearContentSize, clearContent);
+                                    // In the IN_PLACE and SECURE_HANDLE modes the CDM wrote its result into our
+                                    // shared buffer, where the other side will read it, so there is nothing to copy.
+                                    if (_output.CopyBack(Buffer(), clearContent) == true) {
+                                        if ((_output.Mode() != IDecryptOutput::COPY) && (_output.Mismatches() == 1)) {
+                                            TRACE(Trace::Error, (_T("CDM returned its own buffer in output mode %d, copying back for: %s"), _output.Mode(), ::OCDM::DataExchange::Name().c_str()));
+                                        }
+                                        // Adjust the buffer on our sied (this process) on what we will write back
+                                        SetBuffer(0, clearContentSize, clearContent);
+                                    }
                                 }
 
                                 // Store the status we have for the other side.
@@ -315,11 +355,52 @@ namespace Plugin {
                         return (Core::infinite);
                     }
 
+                    // The client describes the sample layout as a CENC subsample map: a sequence of
+                    // (uint16_t clear bytes, uint32_t encrypted bytes) entries in network byte order.
+                    // Translate it into the clear/encrypted uint32_t pairs the CDMi Decrypt expects,
+                    // so the CDM only touches the encrypted ranges and leaves the clear ones in place.
+                    // Returns the number of pairs, 0 means "decrypt the whole sample".
+                    uint32_t SubSampleMapping()
+                    {
+                        static constexpr uint8_t EntrySize = sizeof(uint16_t) + sizeof(uint32_t);
+
+                        const uint16_t length = SubSampleLength();
+                        const uint8_t* data = SubSampleData();
+                        uint32_t count = 0;
+
+                        _subSamples.clear();
+
+                        if ((data != nullptr) && (length >= EntrySize)) {
+                            uint64_t total = 0;
+
+                            for (uint16_t offset = 0; (offset + EntrySize) <= length; offset += EntrySize) {
+                                const uint32_t clear = (data[offset] << 8) | data[offset + 1];
+                                const uint32_t encrypted = (data[offset + 2] << 24) | (data[offset + 3] << 16) | (data[offset + 4] << 8) | data[offset + 5];
+
+                                _subSamples.push_back(clear);
+                                _subSamples.push_back(encrypted);
+                                total += clear + encrypted;
+                            }
+
+                            if (total == BytesWritten()) {
+                                count = static_cast<uint32_t>(_subSamples.size() / 2);
+                            } else {
+                                TRACE(Trace::Error, (_T("Subsample map covers %llu bytes, sample has %d bytes, decrypting whole sample"), static_cast<unsigned long long>(total), BytesWritten()));
+                                _subSamples.clear();
+                            }
+                        }
+
+                        return (count);
+                    }
+
                 private:
                     CDMi::IMediaKeySession* _mediaKeys;
                     CDMi::IMediaKeySessionExt* _mediaKeysExt;
                     uint8_t* _sessionKey;
                     uint32_t _sessionKeyLength;
+                    std::vector<uint32_t> _subSamples;
+                    DecryptOutput _output;
+                    SessionStatistics _statistics;
                 };
 
                 // IMediaKeys defines the MediaKeys interface.
@@ -399,7 +480,9 @@ namespace Plugin {
                         else
                             key = ::OCDM::ISession::InternalError;
 
+                        _parent._keyLock.Lock();
                         const CommonEncryptionData::KeyId* updated = _parent._cencData.UpdateKeyStatus(key, keyId);
+                        _parent._keyLock.Unlock();
 
                         ASSERT (updated != nullptr);
 
@@ -445,6 +528,7 @@ namespace Plugin {
                     , _mediaKeySessionExt(dynamic_cast<CDMi::IMediaKeySessionExt*>(mediaKeySession))
                     , _sink(this, callback)
                     , _buffer(nullptr)
+                    , _keyLock()
                     , _cencData(*sessionData)
                 {
                     ASSERT(parent != nullptr);
@@ -470,6 +554,7 @@ namespace Plugin {
                     , _mediaKeySessionExt(mediaKeySession)
                     , _sink(this, callback)
                     , _buffer(nullptr)
+                    , _keyLock()
                     , _cencData(*sessionData)
                 {
                     ASSERT(parent != nullptr);
@@ -504,11 +589,36 @@ namespace Plugin {
             public:
                 inline bool IsSupported(const CommonEncryptionData& keyIds, const string& keySystem) const
                 {
-                    return ((keySystem == _keySystem) && (_cencData.IsSupported(keyIds) == true));
+                    bool result = false;
+
+                    if (keySystem == _keySystem) {
+                        _keyLock.Lock();
+                        result = _cencData.IsSupported(keyIds);
+                        _keyLock.Unlock();
+                    }
+                    return (result);
                 }
                 inline bool HasKeyId(const OCDM::KeyId& keyId) const
                 {
-                    return (_cencData.HasKeyId(keyId));
+                    _keyLock.Lock();
+                    bool result = _cencData.HasKeyId(keyId);
+                    _keyLock.Unlock();
+                    return (result);
+                }
+                inline const std::string& KeySystem() const
+                {
+                    return (_keySystem);
+                }
+                void Statistics(SessionStatistics::Data& data) const
+                {
+                    data.Session = _sessionId;
+                    data.KeySystem = _keySystem;
+
+                    _adminLock.Lock();
+                    if (_buffer != nullptr) {
+                        _buffer->Statistics().Get(data);
+                    }
+                    _adminLock.Unlock();
                 }
                 virtual std::string SessionId() const override
                 {
@@ -522,12 +632,21 @@ namespace Plugin {
 
                 virtual ::OCDM::ISession::KeyStatus Status() const override
                 {
-                    return (_cencData.Status());
+                    _keyLock.Lock();
+                    ::OCDM::ISession::KeyStatus result = _cencData.Status();
+                    _keyLock.Unlock();
+                    return (result);
                 }
 
                 ::OCDM::ISession::KeyStatus Status(const uint8_t keyId[], const uint8_t length) const override
                 {
-                    return (_cencData.Status(CommonEncryptionData::KeyId(static_cast<CommonEncryptionData::systemType>(0), keyId, length)));
+                    const CommonEncryptionData::KeyId key(static_cast<CommonEncryptionData::systemType>(0), keyId, length);
+
+                    // The CDM updates key statuses from its own thread.
+                    _keyLock.Lock();
+                    ::OCDM::ISession::KeyStatus result = _cencData.Status(key);
+                    _keyLock.Unlock();
+                    return (result);
                 }
 
                 ::OCDM::OCDM_RESULT CreateSessionBuffer(std::string& bufferID) override {
@@ -663,6 +782,7 @@ namespace Plugin {
                 CDMi::IMediaKeySessionExt* _mediaKeySessionExt;
                 Core::Sink<Sink> _sink;
                 DataExchange* _buffer;
+                mutable Core::CriticalSection _keyLock;
                 CommonEncryptionData _cencData;
             };
 
@@ -710,6 +830,23 @@ namespace Plugin {
                 return _defaultSize;
             }
 
+            // Decrypt statistics of the sessions of the given key system (all when empty).
+            void Statistics(const std::string& keySystem, Core::JSON::ArrayType<SessionStatistics::Data>& sessions) const
+            {
+                _adminLock.Lock();
+
+                std::list<SessionImplementation*>::const_iterator index(_sessionList.begin());
+
+                while (index != _sessionList.end()) {
+                    if ((keySystem.empty() == true) || (keySystem == (*index)->KeySystem())) {
+                        (*index)->Statistics(sessions.Add());
+                    }
+                    index++;
+                }
+
+                _adminLock.Unlock();
+            }
+
             // Create a MediaKeySession using the supplied init data and CDM data.
             virtual OCDM::OCDM_RESULT CreateSession(
                 const std::string& keySystem,
@@ -1250,6 +1387,24 @@ namespace Plugin {
             return (Core::Service<RPC::StringIterator>::Create<RPC::IStringIterator>(sessions));
         }
 
+        // -------------------------------------------------------------------------------------------------------------
+        // IDecryptStatistics methods
+        // -------------------------------------------------------------------------------------------------------------
+        uint32_t Statistics(const string& keySystem, string& statistics) override
+        {
+            uint32_t result = Core::ERROR_UNAVAILABLE;
+
+            if (_entryPoint != nullptr) {
+                Core::JSON::ArrayType<SessionStatistics::Data> sessions;
+
+                static_cast<const AccessorOCDM*>(_entryPoint)->Statistics(keySystem, sessions);
+                sessions.ToString(statistics);
+                result = Core::ERROR_NONE;
+            }
+
+            return (result);
+        }
+
     public:
         bool IsTypeSupported(const std::string& keySystem, const std::string& contentType)
         {
@@ -1359,6 +1514,7 @@ namespace Plugin {
         // -------------------------------------------------------------------------------------------------------------
         BEGIN_INTERFACE_MAP(OCDMImplementation)
         INTERFACE_ENTRY(Exchange::IContentDecryption)
+        INTERFACE_ENTRY(Exchange::IDecryptStatistics)
         END_INTERFACE_MAP
 
     private:
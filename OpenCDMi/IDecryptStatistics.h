@@ -0,0 +1,44 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IDECRYPTSTATISTICS_H
+#define __IDECRYPTSTATISTICS_H
+
+#include "Module.h"
+#include <interfaces/Ids.h>
+
+namespace WPEFramework {
+namespace Exchange {
+
+    // Decrypt statistics of the sessions held by the OCDM implementation, next to
+    // IContentDecryption so they also reach the plugin when it runs out of process.
+    struct EXTERNAL IDecryptStatistics : virtual public Core::IUnknown {
+        enum { ID = ID_BROWSER + 0x11000 };
+
+        virtual ~IDecryptStatistics() {}
+
+        // statistics is a JSON array with one SessionStatistics::Data object per session of
+        // the given key system, all sessions when keySystem is empty.
+        virtual uint32_t Statistics(const string& keySystem, string& statistics /* @out */) = 0;
+    };
+
+} // Exchange
+} // WPEFramework
+
+#endif // __IDECRYPTSTATISTICS_H
@@ -113,6 +113,8 @@ namespace Plugin {
         } else {
             _opencdmi->Initialize(_service);
 
+            _statistics = _opencdmi->QueryInterface<Exchange::IDecryptStatistics>();
+
             ASSERT(_connectionId != 0);
             const RPC::IRemoteConnection *connection = _service->RemoteConnection(_connectionId);
 
@@ -125,6 +127,7 @@ namespace Plugin {
             }
             else {
                 message = _T("OCDM crashed at initialize!");
+                _statistics = nullptr;
                 _opencdmi = nullptr;
                 _service->Unregister(&_notification);
                 _service = nullptr;
@@ -143,6 +146,10 @@ namespace Plugin {
         _service->Unregister(&_notification);
         _memory->Release();
 
+        if (_statistics != nullptr) {
+            _statistics->Release();
+        }
+
         _opencdmi->Deinitialize(service);
 
         if (_opencdmi->Release() != Core::ERROR_DESTRUCTION_SUCCEEDED) {
@@ -174,6 +181,7 @@ namespace Plugin {
 
         // Deinitialize what we initialized..
         _memory = nullptr;
+        _statistics = nullptr;
         _opencdmi = nullptr;
         _service = nullptr;
     }
@@ -21,6 +21,8 @@
 #define __OPENCDMI_H
 
 #include "Module.h"
+#include "IDecryptStatistics.h"
+#include "SessionStatistics.h"
 #include <interfaces/IContentDecryption.h>
 #include <interfaces/IMemory.h>
 #include <interfaces/json/JsonData_OCDM.h>
@@ -147,6 +149,7 @@ namespace Plugin {
             : _service(nullptr)
             , _opencdmi(nullptr)
             , _memory(nullptr)
+            , _statistics(nullptr)
             , _notification(this)
         {
             RegisterAll();
@@ -205,6 +208,7 @@ namespace Plugin {
         void UnregisterAll();
         uint32_t get_drms(Core::JSON::ArrayType<JsonData::OCDM::DrmData>& response) const;
         uint32_t get_keysystems(const string& index, Core::JSON::ArrayType<Core::JSON::String>& response) const;
+        uint32_t get_sessionstats(const string& index, Core::JSON::ArrayType<SessionStatistics::Data>& response) const;
 
     private:
         uint8_t _skipURL;
@@ -212,6 +216,7 @@ namespace Plugin {
         PluginHost::IShell* _service;
         Exchange::IContentDecryption* _opencdmi;
         Exchange::IMemory* _memory;
+        Exchange::IDecryptStatistics* _statistics;
         Core::Sink<Notification> _notification;
     };
 } //namespace Plugin
@@ -34,10 +34,12 @@ namespace Plugin {
     {
         Property<Core::JSON::ArrayType<DrmData>>(_T("drms"), &OCDM::get_drms, nullptr, this);
         Property<Core::JSON::ArrayType<Core::JSON::String>>(_T("keysystems"), &OCDM::get_keysystems, nullptr, this);
+        Property<Core::JSON::ArrayType<SessionStatistics::Data>>(_T("sessionstats"), &OCDM::get_sessionstats, nullptr, this);
     }
 
     void OCDM::UnregisterAll()
     {
+        Unregister(_T("sessionstats"));
         Unregister(_T("keysystems"));
         Unregister(_T("drms"));
     }
@@ -101,6 +103,27 @@ namespace Plugin {
         return result;
     }
 
+    // Property: sessionstats - Decrypt statistics of the active sessions
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNAVAILABLE: Statistics could not be retrieved
+    uint32_t OCDM::get_sessionstats(const string& index, Core::JSON::ArrayType<SessionStatistics::Data>& response) const
+    {
+        uint32_t result = Core::ERROR_UNAVAILABLE;
+
+        // An empty index (no key system given) reports all sessions.
+        if (_statistics != nullptr) {
+            string sessions;
+
+            result = _statistics->Statistics(index, sessions);
+            if (result == Core::ERROR_NONE) {
+                response.FromString(sessions);
+            }
+        }
+
+        return result;
+    }
+
 } // namespace Plugin
 
 }
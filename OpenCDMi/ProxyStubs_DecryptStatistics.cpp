@@ -0,0 +1,117 @@
+//
+// 
+//
+// implements RPC proxy stubs for:
+//   - class IDecryptStatistics
+//
+
+#include "IDecryptStatistics.h"
+#include "Module.h"
+
+namespace WPEFramework {
+
+namespace ProxyStubs {
+
+    using namespace Exchange;
+
+    // -----------------------------------------------------------------
+    // STUB
+    // -----------------------------------------------------------------
+
+    //
+    // IDecryptStatistics interface stub definitions
+    //
+    // Methods:
+    //  (0) virtual uint32_t Statistics(const string &keySystem, string &statistics /* @out */) = 0;
+    //
+
+    ProxyStub::MethodHandler DecryptStatisticsStubMethods[] = {
+        // virtual uint32_t Statistics(const string&, string&) = 0
+        //
+        [](Core::ProxyType<Core::IPCChannel>& channel VARIABLE_IS_NOT_USED, Core::ProxyType<RPC::InvokeMessage>& message) {
+            RPC::Data::Input& input(message->Parameters());
+
+            // read parameters
+            RPC::Data::Frame::Reader reader(input.Reader());
+            const string param0 = reader.Text();
+            string param1{}; // storage
+
+            // call implementation
+            IDecryptStatistics* implementation = reinterpret_cast<IDecryptStatistics*>(input.Implementation());
+            ASSERT((implementation != nullptr) && "Null IDecryptStatistics implementation pointer");
+            const uint32_t output = implementation->Statistics(param0, param1);
+
+            // write return values
+            RPC::Data::Frame::Writer writer(message->Response().Writer());
+            writer.Number<const uint32_t>(output);
+            writer.Text(param1);
+        },
+
+        nullptr
+    }; // DecryptStatisticsStubMethods[]
+
+    // -----------------------------------------------------------------
+    // PROXY
+    // -----------------------------------------------------------------
+
+    //
+    // IDecryptStatistics interface proxy definitions
+    //
+    // Methods:
+    //  (0) virtual uint32_t Statistics(const string&, string&) = 0
+    //
+
+    class DecryptStatisticsProxy final : public ProxyStub::UnknownProxyType<IDecryptStatistics> {
+    public:
+        DecryptStatisticsProxy(const Core::ProxyType<Core::IPCChannel>& channel, RPC::instance_id implementation, const bool otherSideInformed)
+            : BaseClass(channel, implementation, otherSideInformed)
+        {
+        }
+
+        uint32_t Statistics(const string& param0, string& param1) override
+        {
+            IPCMessage newMessage(BaseClass::Message(0));
+
+            // write parameters
+            RPC::Data::Frame::Writer writer(newMessage->Parameters().Writer());
+            writer.Text(param0);
+
+            // invoke the method handler
+            uint32_t output{};
+            if ((output = Invoke(newMessage)) == Core::ERROR_NONE) {
+                // read return values
+                RPC::Data::Frame::Reader reader(newMessage->Response().Reader());
+                output = reader.Number<uint32_t>();
+                param1 = reader.Text();
+            }
+
+            return output;
+        }
+
+    }; // class DecryptStatisticsProxy
+
+    // -----------------------------------------------------------------
+    // REGISTRATION
+    // -----------------------------------------------------------------
+
+    namespace {
+
+        typedef ProxyStub::UnknownStubType<IDecryptStatistics, DecryptStatisticsStubMethods> DecryptStatisticsStub;
+
+        static class Instantiation {
+        public:
+            Instantiation()
+            {
+                RPC::Administrator::Instance().Announce<IDecryptStatistics, DecryptStatisticsProxy, DecryptStatisticsStub>();
+            }
+            ~Instantiation()
+            {
+                RPC::Administrator::Instance().Recall<IDecryptStatistics>();
+            }
+        } ProxyStubRegistration;
+
+    } // namespace
+
+} // namespace ProxyStubs
+
+}
@@ -0,0 +1,264 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SESSIONSTATISTICS_H
+#define __SESSIONSTATISTICS_H
+
+#include "Module.h"
+#include <atomic>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Power of two buckets, written by a single thread (the session decrypt worker) and read
+    // by the JSON-RPC handler at any time. Counters are relaxed atomics, a reader may see a
+    // sample in the count before it shows up in the sum, which is fine for statistics.
+    class Histogram {
+    private:
+        Histogram(const Histogram&) = delete;
+        Histogram& operator=(const Histogram&) = delete;
+
+    public:
+        static constexpr uint8_t BucketCount = 24;
+
+        class Data : public Core::JSON::Container {
+        private:
+            Data& operator=(const Data&) = delete;
+
+        public:
+            Data()
+                : Core::JSON::Container()
+                , Count(0)
+                , Average(0)
+                , Max(0)
+                , Buckets()
+            {
+                Init();
+            }
+            Data(const Data& copy)
+                : Core::JSON::Container()
+                , Count(copy.Count)
+                , Average(copy.Average)
+                , Max(copy.Max)
+                , Buckets(copy.Buckets)
+            {
+                Init();
+            }
+            ~Data()
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("count"), &Count);
+                Add(_T("average"), &Average);
+                Add(_T("max"), &Max);
+                Add(_T("buckets"), &Buckets);
+            }
+
+        public:
+            Core::JSON::DecUInt32 Count;
+            Core::JSON::DecUInt64 Average;
+            Core::JSON::DecUInt64 Max;
+            Core::JSON::ArrayType<Core::JSON::DecUInt32> Buckets;
+        };
+
+    public:
+        Histogram()
+            : _count(0)
+            , _sum(0)
+            , _max(0)
+        {
+            for (uint8_t index = 0; index < BucketCount; index++) {
+                _buckets[index].store(0, std::memory_order_relaxed);
+            }
+        }
+        ~Histogram()
+        {
+        }
+
+    public:
+        // Bucket N holds values in [2^(N-1), 2^N), bucket 0 holds 0, the last one is open ended.
+        inline void Add(const uint64_t value)
+        {
+            uint8_t index = 0;
+            uint64_t range = value;
+
+            while ((range != 0) && (index < (BucketCount - 1))) {
+                range >>= 1;
+                index++;
+            }
+
+            _buckets[index].fetch_add(1, std::memory_order_relaxed);
+            _sum.fetch_add(value, std::memory_order_relaxed);
+            _count.fetch_add(1, std::memory_order_relaxed);
+
+            if (value > _max.load(std::memory_order_relaxed)) {
+                _max.store(value, std::memory_order_relaxed);
+            }
+        }
+        inline void Get(Data& data) const
+        {
+            const uint32_t count = _count.load(std::memory_order_relaxed);
+
+            data.Count = count;
+            data.Average = (count != 0 ? (_sum.load(std::memory_order_relaxed) / count) : 0);
+            data.Max = _max.load(std::memory_order_relaxed);
+            data.Buckets.Clear();
+
+            for (uint8_t index = 0; index < BucketCount; index++) {
+                data.Buckets.Add() = _buckets[index].load(std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        std::atomic<uint32_t> _count;
+        std::atomic<uint64_t> _sum;
+        std::atomic<uint64_t> _max;
+        std::atomic<uint32_t> _buckets[BucketCount];
+    };
+
+    // Decrypt statistics of one session, see the OCDM sessionstats property.
+    class SessionStatistics {
+    private:
+        SessionStatistics(const SessionStatistics&) = delete;
+        SessionStatistics& operator=(const SessionStatistics&) = delete;
+
+    public:
+        class Data : public Core::JSON::Container {
+        private:
+            Data& operator=(const Data&) = delete;
+
+        public:
+            Data()
+                : Core::JSON::Container()
+                , Session()
+                , KeySystem()
+                , Samples(0)
+                , Bytes(0)
+                , Failures(0)
+                , SizeMismatches(0)
+                , Wait()
+                , Decrypt()
+                , Throughput()
+            {
+                Init();
+            }
+            Data(const Data& copy)
+                : Core::JSON::Container()
+                , Session(copy.Session)
+                , KeySystem(copy.KeySystem)
+                , Samples(copy.Samples)
+                , Bytes(copy.Bytes)
+                , Failures(copy.Failures)
+                , SizeMismatches(copy.SizeMismatches)
+                , Wait(copy.Wait)
+                , Decrypt(copy.Decrypt)
+                , Throughput(copy.Throughput)
+            {
+                Init();
+            }
+            ~Data()
+            {
+            }
+
+        private:
+            void Init()
+            {
+                Add(_T("session"), &Session);
+                Add(_T("keysystem"), &KeySystem);
+                Add(_T("samples"), &Samples);
+                Add(_T("bytes"), &Bytes);
+                Add(_T("failures"), &Failures);
+                Add(_T("sizemismatches"), &SizeMismatches);
+                Add(_T("wait"), &Wait);
+                Add(_T("decrypt"), &Decrypt);
+                Add(_T("throughput"), &Throughput);
+            }
+
+        public:
+            Core::JSON::String Session;
+            Core::JSON::String KeySystem;
+            Core::JSON::DecUInt32 Samples;
+            Core::JSON::DecUInt64 Bytes;
+            Core::JSON::DecUInt32 Failures;
+            Core::JSON::DecUInt32 SizeMismatches;
+            Histogram::Data Wait; // us the worker waited for the next sample
+            Histogram::Data Decrypt; // us spent in the CDM Decrypt
+            Histogram::Data Throughput; // KB/s per sample
+        };
+
+    public:
+        SessionStatistics()
+            : _bytes(0)
+            , _failures(0)
+            , _sizeMismatches(0)
+            , _wait()
+            , _decrypt()
+            , _throughput()
+        {
+        }
+        ~SessionStatistics()
+        {
+        }
+
+    public:
+        inline void Waited(const uint64_t microseconds)
+        {
+            _wait.Add(microseconds);
+        }
+        inline void Decrypted(const uint32_t bytes, const uint64_t microseconds, const bool success, const bool sizeMismatch)
+        {
+            _decrypt.Add(microseconds);
+            _bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+            // bytes per microsecond equals MB/s, report KB/s to keep small samples visible.
+            _throughput.Add((static_cast<uint64_t>(bytes) * 1000) / (microseconds != 0 ? microseconds : 1));
+
+            if (success == false) {
+                _failures.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (sizeMismatch == true) {
+                _sizeMismatches.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        inline void Get(Data& data) const
+        {
+            _wait.Get(data.Wait);
+            _decrypt.Get(data.Decrypt);
+            _throughput.Get(data.Throughput);
+            data.Samples = data.Decrypt.Count.Value();
+            data.Bytes = _bytes.load(std::memory_order_relaxed);
+            data.Failures = _failures.load(std::memory_order_relaxed);
+            data.SizeMismatches = _sizeMismatches.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<uint64_t> _bytes;
+        std::atomic<uint32_t> _failures;
+        std::atomic<uint32_t> _sizeMismatches;
+        Histogram _wait;
+        Histogram _decrypt;
+        Histogram _throughput;
+    };
+}
+} // namespace WPEFramework::Plugin
+
+#endif // __SESSIONSTATISTICS_H
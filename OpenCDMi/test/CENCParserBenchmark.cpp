@@ -0,0 +1,81 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+#include "CENCParser.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+using namespace WPEFramework::Plugin;
+
+// Usage: OCDMCENCParserBenchmark [-n iterations] <init data file>...
+// Prints the number of key ids found and the average parse time per init data,
+// so parser changes can be compared on the corpus in OpenCDMi/test/corpus.
+int main(int argc, char** argv)
+{
+    uint32_t iterations = 100000;
+    int first = 1;
+    int result = 0;
+
+    if ((argc > 2) && (std::string(argv[1]) == "-n")) {
+        iterations = static_cast<uint32_t>(std::stoul(argv[2]));
+        first = 3;
+    }
+
+    if ((first >= argc) || (iterations == 0)) {
+        std::cerr << "Usage: " << argv[0] << " [-n iterations] <init data file>..." << std::endl;
+        return (1);
+    }
+
+    for (int file = first; file < argc; file++) {
+        std::ifstream input(argv[file], std::ios::binary);
+        std::vector<uint8_t> initData((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+        if ((input.is_open() == false) || (initData.empty() == true) || (initData.size() > 0xFFFF)) {
+            std::cerr << argv[file] << ": can not use this file as init data" << std::endl;
+            result = 1;
+            continue;
+        }
+
+        uint32_t keys = 0;
+        CommonEncryptionData parsed(initData.data(), static_cast<uint16_t>(initData.size()));
+        CommonEncryptionData::Iterator entries(parsed.Keys());
+        while (entries.Next() == true) {
+            keys++;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (uint32_t loop = 0; loop < iterations; loop++) {
+            CommonEncryptionData sample(initData.data(), static_cast<uint16_t>(initData.size()));
+            ASSERT(sample.IsSupported(parsed) == true);
+        }
+
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << argv[file] << ": " << initData.size() << " bytes, " << keys << " key(s), "
+                  << (elapsed.count() / iterations) << " ns/parse" << std::endl;
+    }
+
+    return (result);
+}
@@ -0,0 +1,46 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+#include "CENCParser.h"
+
+using namespace WPEFramework::Plugin;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    // Init data reaches the parser through a 16 bits length.
+    if (size <= 0xFFFF) {
+        // Copy into an exactly sized buffer so ASAN catches reads past the end.
+        uint8_t* buffer = new uint8_t[size > 0 ? size : 1];
+        ::memcpy(buffer, data, size);
+
+        CommonEncryptionData parsed(buffer, static_cast<uint16_t>(size));
+        CommonEncryptionData copy(parsed);
+
+        CommonEncryptionData::Iterator index(parsed.Keys());
+        while (index.Next() == true) {
+            ASSERT(copy.HasKeyId(index.Current()) == true);
+        }
+        ASSERT(copy.IsSupported(parsed) == true);
+
+        delete[] buffer;
+    }
+
+    return (0);
+}
@@ -0,0 +1,188 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DecryptOutput.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+    // "Decrypts" by xor-ing every byte with a fixed key, writing the result where the
+    // negotiated mode says it should go.
+    class StubCDM : public IDecryptOutput {
+    public:
+        static constexpr uint8_t Key = 0x5A;
+        static constexpr uint32_t HandleSize = 8;
+
+        StubCDM(const uint8_t modes, const bool misbehave = false)
+            : _modes(modes)
+            , _misbehave(misbehave)
+            , _selected(COPY)
+            , _negotiations(0)
+            , _output()
+        {
+        }
+
+        uint8_t OutputModes() const override
+        {
+            return (_modes);
+        }
+        void OutputMode(const mode selected) override
+        {
+            _selected = selected;
+            _negotiations++;
+        }
+
+        int Decrypt(uint8_t* sample, const uint32_t length, uint32_t* clearSize, uint8_t** clear)
+        {
+            if ((_selected == SECURE_HANDLE) && (_misbehave == false)) {
+                // An opaque handle to the clear sample in secure memory.
+                for (uint32_t index = 0; index < HandleSize; index++) {
+                    sample[index] = static_cast<uint8_t>(0xF0 + index);
+                }
+                *clearSize = HandleSize;
+                *clear = sample;
+            } else if ((_selected == IN_PLACE) && (_misbehave == false)) {
+                for (uint32_t index = 0; index < length; index++) {
+                    sample[index] ^= Key;
+                }
+                *clearSize = length;
+                *clear = sample;
+            } else {
+                _output.assign(sample, sample + length);
+                for (uint8_t& entry : _output) {
+                    entry ^= Key;
+                }
+                *clearSize = length;
+                *clear = _output.data();
+            }
+            return (0);
+        }
+
+        mode Selected() const
+        {
+            return (_selected);
+        }
+        uint32_t Negotiations() const
+        {
+            return (_negotiations);
+        }
+
+    private:
+        const uint8_t _modes;
+        const bool _misbehave;
+        mode _selected;
+        uint32_t _negotiations;
+        std::vector<uint8_t> _output;
+    };
+
+    int failures = 0;
+
+    void Check(const bool condition, const char test[], const char what[])
+    {
+        if (condition == false) {
+            std::cerr << test << ": " << what << std::endl;
+            failures++;
+        }
+    }
+
+    // The part of the DataExchange worker that deals with the CDM output: shared is the
+    // buffer the client reads back, copies counts the copies the worker had to make.
+    void Run(const char test[], StubCDM& cdm, DecryptOutput& output, uint32_t& copies, std::vector<uint8_t>& shared)
+    {
+        uint32_t clearSize = 0;
+        uint8_t* clear = nullptr;
+
+        Check(cdm.Decrypt(shared.data(), static_cast<uint32_t>(shared.size()), &clearSize, &clear) == 0, test, "decrypt failed");
+
+        if (output.CopyBack(shared.data(), clear) == true) {
+            ::memcpy(shared.data(), clear, clearSize);
+            copies++;
+        }
+        shared.resize(clearSize);
+    }
+
+    void Sample(const char test[], const uint8_t modes, const bool misbehave, const IDecryptOutput::mode expected, const uint32_t expectedCopies)
+    {
+        static const uint8_t clearText[] = "subsample in the shared buffer";
+
+        StubCDM cdm(modes, misbehave);
+        DecryptOutput output(&cdm);
+        uint32_t copies = 0;
+
+        Check(output.Mode() == expected, test, "unexpected negotiated mode");
+        Check(cdm.Selected() == expected, test, "CDM not told about the negotiated mode");
+        Check(cdm.Negotiations() == 1, test, "negotiated more than once");
+
+        for (uint32_t loop = 0; loop < 3; loop++) {
+            std::vector<uint8_t> shared(clearText, clearText + sizeof(clearText));
+            for (uint8_t& entry : shared) {
+                entry ^= StubCDM::Key;
+            }
+
+            Run(test, cdm, output, copies, shared);
+
+            if (expected == IDecryptOutput::SECURE_HANDLE) {
+                Check(output.SizeIsSample() == false, test, "handle size taken for the sample size");
+                Check((shared.size() == StubCDM::HandleSize) && (shared[0] == 0xF0), test, "handle not in the shared buffer");
+            } else {
+                Check(output.SizeIsSample() == true, test, "sample size not reported");
+                Check((shared.size() == sizeof(clearText)) && (::memcmp(shared.data(), clearText, sizeof(clearText)) == 0), test, "clear sample not in the shared buffer");
+            }
+        }
+
+        Check(copies == expectedCopies, test, "unexpected number of copies back");
+        Check(output.Mismatches() == ((misbehave == true) ? expectedCopies : 0), test, "unexpected number of mismatches");
+    }
+}
+
+// Exercises the decrypt output negotiation against a stub CDM: every mode a CDM can
+// offer, a CDM without the interface, and a CDM that ignores the mode it agreed to.
+int main(int /* argc */, char** /* argv */)
+{
+    Sample("copy", IDecryptOutput::COPY, false, IDecryptOutput::COPY, 3);
+    Sample("in place", IDecryptOutput::COPY | IDecryptOutput::IN_PLACE, false, IDecryptOutput::IN_PLACE, 0);
+    Sample("secure handle", DecryptOutput::AllModes, false, IDecryptOutput::SECURE_HANDLE, 0);
+    Sample("misbehaving", IDecryptOutput::IN_PLACE, true, IDecryptOutput::IN_PLACE, 3);
+
+    {
+        DecryptOutput legacy(nullptr);
+        uint8_t shared[4] = {};
+        uint8_t own[4] = {};
+
+        Check(legacy.Mode() == IDecryptOutput::COPY, "legacy", "CDM without the interface not in COPY mode");
+        Check(legacy.CopyBack(shared, own) == true, "legacy", "own buffer not copied back");
+        Check(legacy.CopyBack(shared, shared) == false, "legacy", "shared buffer copied onto itself");
+    }
+
+    {
+        StubCDM cdm(DecryptOutput::AllModes);
+        DecryptOutput restricted(&cdm, IDecryptOutput::COPY | IDecryptOutput::IN_PLACE);
+
+        Check(restricted.Mode() == IDecryptOutput::IN_PLACE, "restricted", "mode outside the supported set selected");
+    }
+
+    std::cout << ((failures == 0) ? "PASS" : "FAIL") << std::endl;
+
+    return (failures == 0 ? 0 : 1);
+}
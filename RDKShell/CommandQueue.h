@@ -0,0 +1,121 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Multiple producer, single consumer queue of compositor operations.
+        // Producers push with a single compare and swap on the list head, the consumer takes the
+        // whole list with one exchange and runs it oldest first. Commands are owned by the
+        // producer, which has to keep them alive until the completion future is ready.
+        class CommandQueue
+        {
+            public:
+                struct Command
+                {
+                    Command(const std::function<void()>& function) : mFunction(function), mNext(nullptr) {}
+
+                    std::function<void()> mFunction;
+                    std::promise<void> mDone;
+                    Command* mNext;
+                };
+
+                CommandQueue() : mHead(nullptr) {}
+                CommandQueue(const CommandQueue&) = delete;
+                CommandQueue& operator=(const CommandQueue&) = delete;
+
+                void post(Command* command)
+                {
+                    Command* head = mHead.load(std::memory_order_relaxed);
+                    do
+                    {
+                        command->mNext = head;
+                    } while (!mHead.compare_exchange_weak(head, command, std::memory_order_release, std::memory_order_relaxed));
+
+                    // only the push that makes the queue non empty has to wake the consumer
+                    if (head == nullptr)
+                    {
+                        std::lock_guard<std::mutex> lock(mWakeMutex);
+                        mWakeCondition.notify_one();
+                    }
+                }
+
+                // must only be called by one thread at a time
+                size_t drain()
+                {
+                    Command* command = mHead.exchange(nullptr, std::memory_order_acquire);
+                    Command* ordered = nullptr;
+                    while (command != nullptr)
+                    {
+                        Command* next = command->mNext;
+                        command->mNext = ordered;
+                        ordered = command;
+                        command = next;
+                    }
+
+                    size_t count = 0;
+                    while (ordered != nullptr)
+                    {
+                        // the producer may release the command as soon as it is completed
+                        Command* next = ordered->mNext;
+                        try
+                        {
+                            ordered->mFunction();
+                            ordered->mDone.set_value();
+                        }
+                        catch (...)
+                        {
+                            ordered->mDone.set_exception(std::current_exception());
+                        }
+                        ordered = next;
+                        count++;
+                    }
+                    return count;
+                }
+
+                bool empty() const
+                {
+                    return (mHead.load(std::memory_order_acquire) == nullptr);
+                }
+
+                // returns true when commands are pending before the timeout expired
+                bool waitFor(const std::chrono::microseconds& timeout)
+                {
+                    std::unique_lock<std::mutex> lock(mWakeMutex);
+                    return mWakeCondition.wait_for(lock, timeout, [this]() { return !empty(); });
+                }
+
+            private:
+                std::atomic<Command*> mHead;
+                std::mutex mWakeMutex;
+                std::condition_variable mWakeCondition;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,93 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Decides per frame whether the render thread has to draw. Damage is reported by any
+        // thread, the decision is made by the render thread only.
+        class FrameScheduler
+        {
+            public:
+                // frames drawn after the last damage so that every swap chain buffer is refreshed
+                static const uint32_t TRAILING_FRAMES = 2;
+
+                FrameScheduler() : mEnabled(true), mDamaged(true), mAnimationEndTime(0), mTrailingFrames(TRAILING_FRAMES)
+                {
+                }
+                FrameScheduler(const FrameScheduler&) = delete;
+                FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+                void enable(const bool enabled)
+                {
+                    mEnabled.store(enabled, std::memory_order_relaxed);
+                    damage();
+                }
+                bool enabled() const
+                {
+                    return mEnabled.load(std::memory_order_relaxed);
+                }
+
+                // the compositor state was changed
+                void damage()
+                {
+                    mDamaged.store(true, std::memory_order_release);
+                }
+
+                // keep drawing until the given time (RdkShell::seconds) e.g. for animations
+                void animateUntil(const double endTime)
+                {
+                    double current = mAnimationEndTime.load(std::memory_order_relaxed);
+                    while ((endTime > current) && !mAnimationEndTime.compare_exchange_weak(current, endTime, std::memory_order_relaxed))
+                    {
+                    }
+                }
+
+                // render thread only. hasContent tells whether something on screen can change by itself,
+                // it is only asked when nothing else requires the frame.
+                template <typename HAS_CONTENT>
+                bool needsDraw(const double now, HAS_CONTENT hasContent)
+                {
+                    if (mDamaged.exchange(false, std::memory_order_acquire) || !enabled() || (now < mAnimationEndTime.load(std::memory_order_relaxed)) || hasContent())
+                    {
+                        mTrailingFrames = TRAILING_FRAMES;
+                        return true;
+                    }
+                    if (mTrailingFrames > 0)
+                    {
+                        mTrailingFrames--;
+                        return true;
+                    }
+                    return false;
+                }
+
+            private:
+                std::atomic<bool> mEnabled;
+                std::atomic<bool> mDamaged;
+                std::atomic<double> mAnimationEndTime;
+                uint32_t mTrailingFrames;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
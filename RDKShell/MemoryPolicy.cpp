@@ -0,0 +1,263 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "MemoryPolicy.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace {
+
+            double now()
+            {
+                return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            // parses "some avg10=1.23 avg60=0.50 avg300=0.10 total=12345"
+            bool readAvg10(const std::string& line, const std::string& kind, double& avg10)
+            {
+                const std::string prefix = kind + " avg10=";
+                if (line.compare(0, prefix.size(), prefix) != 0)
+                {
+                    return false;
+                }
+                avg10 = std::strtod(line.c_str() + prefix.size(), nullptr);
+                return true;
+            }
+        }
+
+        MemoryPolicy::Config::Config()
+            : mEnabled(false), mIntervalMs(1000), mSuspendPressure(10), mDestroyPressure(5)
+            , mSuspendFreeKb(0), mDestroyFreeKb(0), mMinIdleSeconds(30), mCooldownSeconds(10)
+        {
+        }
+
+        MemoryPolicy::MemoryPolicy() : mSuspended(0), mDestroyed(0), mRunning(false)
+        {
+        }
+
+        MemoryPolicy::~MemoryPolicy()
+        {
+            stop();
+        }
+
+        void MemoryPolicy::start(const Config& config, const ClientsHandler& clients, const DetailsHandler& details, const ActionHandler& action)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mConfig = config;
+            if (mRunning || !mConfig.mEnabled)
+            {
+                return;
+            }
+            if (mConfig.mIntervalMs == 0)
+            {
+                mConfig.mIntervalMs = Config().mIntervalMs;
+            }
+            mClients = clients;
+            mDetails = details;
+            mAction = action;
+            mRunning = true;
+            mThread = std::thread(&MemoryPolicy::run, this);
+        }
+
+        void MemoryPolicy::stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mRunning = false;
+            }
+            mCondition.notify_all();
+            if (mThread.joinable())
+            {
+                mThread.join();
+            }
+        }
+
+        void MemoryPolicy::getInfo(Config& config, Sample& sample, uint32_t& suspended, uint32_t& destroyed)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            config = mConfig;
+            sample = mSample;
+            suspended = mSuspended;
+            destroyed = mDestroyed;
+        }
+
+        const char* MemoryPolicy::actionName(const Action action)
+        {
+            return (action == DESTROY ? "destroy" : "suspend");
+        }
+
+        bool MemoryPolicy::readSample(Sample& sample)
+        {
+            std::ifstream pressureFile("/proc/pressure/memory");
+            std::string line;
+            bool hasSome = false, hasFull = false;
+            while (std::getline(pressureFile, line))
+            {
+                hasSome = readAvg10(line, "some", sample.mSomeAvg10) || hasSome;
+                hasFull = readAvg10(line, "full", sample.mFullAvg10) || hasFull;
+            }
+            sample.mHasPressure = (hasSome && hasFull);
+
+            std::ifstream memInfoFile("/proc/meminfo");
+            while (!sample.mHasAvailable && std::getline(memInfoFile, line))
+            {
+                std::istringstream fields(line);
+                std::string name;
+                fields >> name;
+                if (name == "MemAvailable:")
+                {
+                    sample.mHasAvailable = static_cast<bool>(fields >> sample.mAvailableKb);
+                }
+            }
+            return (sample.mHasPressure || sample.mHasAvailable);
+        }
+
+        void MemoryPolicy::run()
+        {
+            double nextActionTime = 0;
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (mRunning)
+            {
+                mCondition.wait_for(lock, std::chrono::milliseconds(mConfig.mIntervalMs));
+                if (!mRunning)
+                {
+                    break;
+                }
+                lock.unlock();
+                Sample sample;
+                const bool sampled = readSample(sample);
+                std::vector<Client> clients;
+                mClients(clients);
+                lock.lock();
+
+                const double currentTime = now();
+                mSample = sample;
+                std::map<std::string, double> lastVisible;
+                for (std::vector<Client>::const_iterator it = clients.begin(); it != clients.end(); ++it)
+                {
+                    std::map<std::string, double>::const_iterator previous = mLastVisible.find(it->mCallsign);
+                    lastVisible[it->mCallsign] = ((it->mVisible || (previous == mLastVisible.end())) ? currentTime : previous->second);
+                }
+                mLastVisible.swap(lastVisible);
+
+                Action action = SUSPEND;
+                std::string reason;
+                if (!sampled || (currentTime < nextActionTime) || !evaluate(sample, action, reason))
+                {
+                    continue;
+                }
+
+                std::vector<Client> candidates;
+                for (std::vector<Client>::const_iterator it = clients.begin(); it != clients.end(); ++it)
+                {
+                    if (!it->mVisible && !isProtected(it->mCallsign) && ((currentTime - mLastVisible[it->mCallsign]) >= mConfig.mMinIdleSeconds))
+                    {
+                        candidates.push_back(*it);
+                    }
+                }
+                if (candidates.empty())
+                {
+                    continue;
+                }
+                lock.unlock();
+                for (std::vector<Client>::iterator it = candidates.begin(); it != candidates.end(); ++it)
+                {
+                    mDetails(*it);
+                }
+                lock.lock();
+
+                const Client* selected = nullptr;
+                double selectedCost = 0;
+                for (std::vector<Client>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+                {
+                    if ((action == SUSPEND) && it->mSuspended)
+                    {
+                        continue;
+                    }
+                    const double cost = (currentTime - mLastVisible[it->mCallsign] + 1) * std::max<uint32_t>(it->mResidentKb, 1);
+                    if ((selected == nullptr) || (cost > selectedCost))
+                    {
+                        selected = &(*it);
+                        selectedCost = cost;
+                    }
+                }
+                if (selected == nullptr)
+                {
+                    continue;
+                }
+
+                const Client client = *selected;
+                const double idleSeconds = currentTime - mLastVisible[client.mCallsign];
+                lock.unlock();
+                std::cout << "memory policy: " << actionName(action) << " " << client.mCallsign << " (" << reason << ", some " << sample.mSomeAvg10
+                          << "%, full " << sample.mFullAvg10 << "%, available " << sample.mAvailableKb << " KB, resident " << client.mResidentKb
+                          << " KB, hidden for " << idleSeconds << " seconds)\n";
+                const bool done = mAction(client, action, reason, sample);
+                lock.lock();
+                if (done)
+                {
+                    (action == DESTROY ? mDestroyed : mSuspended)++;
+                }
+                nextActionTime = now() + mConfig.mCooldownSeconds;
+            }
+        }
+
+        bool MemoryPolicy::isProtected(const std::string& callsign) const
+        {
+            return (std::find(mConfig.mProtected.begin(), mConfig.mProtected.end(), callsign) != mConfig.mProtected.end());
+        }
+
+        bool MemoryPolicy::evaluate(const Sample& sample, Action& action, std::string& reason) const
+        {
+            if (sample.mHasPressure && (mConfig.mDestroyPressure > 0) && (sample.mFullAvg10 >= mConfig.mDestroyPressure))
+            {
+                action = DESTROY;
+                reason = "memoryPressure";
+            }
+            else if (sample.mHasAvailable && (mConfig.mDestroyFreeKb > 0) && (sample.mAvailableKb < mConfig.mDestroyFreeKb))
+            {
+                action = DESTROY;
+                reason = "lowMemory";
+            }
+            else if (sample.mHasPressure && (mConfig.mSuspendPressure > 0) && (sample.mSomeAvg10 >= mConfig.mSuspendPressure))
+            {
+                action = SUSPEND;
+                reason = "memoryPressure";
+            }
+            else if (sample.mHasAvailable && (mConfig.mSuspendFreeKb > 0) && (sample.mAvailableKb < mConfig.mSuspendFreeKb))
+            {
+                action = SUSPEND;
+                reason = "lowMemory";
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,128 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Reclaims memory before the OOM killer does. Memory pressure (PSI) and available memory
+        // are sampled periodically; above the suspend thresholds the background application with
+        // the highest cost is suspended, above the destroy thresholds it is destroyed. The cost of
+        // an application is the time since it was last visible weighted by its resident memory.
+        // One application is reclaimed per cooldown period so that the pressure averages can follow.
+        class MemoryPolicy
+        {
+            public:
+                enum Action
+                {
+                    SUSPEND,
+                    DESTROY
+                };
+
+                struct Config
+                {
+                    Config();
+
+                    bool mEnabled;
+                    uint32_t mIntervalMs;
+                    // PSI avg10 percentages, 0 disables the check
+                    uint32_t mSuspendPressure;
+                    uint32_t mDestroyPressure;
+                    // available memory in KB, 0 disables the check
+                    uint32_t mSuspendFreeKb;
+                    uint32_t mDestroyFreeKb;
+                    uint32_t mMinIdleSeconds;
+                    uint32_t mCooldownSeconds;
+                    std::vector<std::string> mProtected;
+                };
+
+                struct Sample
+                {
+                    Sample() : mHasPressure(false), mSomeAvg10(0), mFullAvg10(0), mHasAvailable(false), mAvailableKb(0) {}
+
+                    bool mHasPressure;
+                    double mSomeAvg10;
+                    double mFullAvg10;
+                    bool mHasAvailable;
+                    uint32_t mAvailableKb;
+                };
+
+                struct Client
+                {
+                    Client() : mVisible(false), mSuspended(false), mResidentKb(0) {}
+
+                    std::string mCallsign;
+                    bool mVisible;
+                    bool mSuspended;
+                    uint32_t mResidentKb;
+                };
+
+                // lists the reclaimable clients and their visibility, called every interval
+                typedef std::function<void(std::vector<Client>&)> ClientsHandler;
+                // fills in the suspended state and resident memory of a candidate
+                typedef std::function<void(Client&)> DetailsHandler;
+                // suspends or destroys the client, returns true on success
+                typedef std::function<bool(const Client&, const Action, const std::string& reason, const Sample&)> ActionHandler;
+
+                MemoryPolicy();
+                ~MemoryPolicy();
+                MemoryPolicy(const MemoryPolicy&) = delete;
+                MemoryPolicy& operator=(const MemoryPolicy&) = delete;
+
+                void start(const Config& config, const ClientsHandler& clients, const DetailsHandler& details, const ActionHandler& action);
+                void stop();
+
+                void getInfo(Config& config, Sample& sample, uint32_t& suspended, uint32_t& destroyed);
+
+                static const char* actionName(const Action action);
+                static bool readSample(Sample& sample);
+
+            private:
+                void run();
+                bool isProtected(const std::string& callsign) const;
+                // returns false when no threshold is exceeded
+                bool evaluate(const Sample& sample, Action& action, std::string& reason) const;
+
+                std::mutex mMutex;
+                std::condition_variable mCondition;
+                Config mConfig;
+                Sample mSample;
+                uint32_t mSuspended;
+                uint32_t mDestroyed;
+                // callsign to the last time it was seen visible, or first seen
+                std::map<std::string, double> mLastVisible;
+                bool mRunning;
+                std::thread mThread;
+                ClientsHandler mClients;
+                DetailsHandler mDetails;
+                ActionHandler mAction;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
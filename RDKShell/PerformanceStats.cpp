@@ -0,0 +1,197 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "PerformanceStats.h"
+#include <algorithm>
+
+#define RDKSHELL_PERFORMANCE_STATS_MAX_PENDING_KEYS 64
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace {
+
+            // frame budgets of 60, 30 and 20 fps are bucket limits so that missed frames stand out
+            const uint64_t sBucketLimits[] = { 1000, 2000, 4000, 8000, 16667, 33333, 50000, 100000, 250000, 500000, 1000000, 0 };
+            const size_t sBucketCount = sizeof(sBucketLimits) / sizeof(sBucketLimits[0]);
+        }
+
+        const size_t PerformanceStats::WINDOW;
+
+        PerformanceStats::Histogram::Histogram() : mNext(0), mCount(0)
+        {
+        }
+
+        void PerformanceStats::Histogram::add(const uint64_t sample)
+        {
+            mSamples[mNext] = sample;
+            mNext = (mNext + 1) % WINDOW;
+            mCount = std::min(mCount + 1, WINDOW);
+        }
+
+        uint64_t PerformanceStats::Histogram::last() const
+        {
+            return (mCount != 0 ? mSamples[(mNext + WINDOW - 1) % WINDOW] : 0);
+        }
+
+        void PerformanceStats::Histogram::summarize(Summary& summary) const
+        {
+            summary = Summary();
+            summary.mBuckets.assign(sBucketCount, 0);
+            summary.mCount = mCount;
+            if (mCount == 0)
+            {
+                return;
+            }
+            summary.mLast = last();
+            std::vector<uint64_t> sorted(mSamples, mSamples + mCount);
+            std::sort(sorted.begin(), sorted.end());
+            uint64_t sum = 0;
+            size_t bucket = 0;
+            for (std::vector<uint64_t>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+            {
+                sum += *it;
+                while ((sBucketLimits[bucket] != 0) && (*it > sBucketLimits[bucket]))
+                {
+                    bucket++;
+                }
+                summary.mBuckets[bucket]++;
+            }
+            summary.mMin = sorted.front();
+            summary.mMax = sorted.back();
+            summary.mAverage = sum / mCount;
+            summary.mP50 = sorted[(mCount - 1) * 50 / 100];
+            summary.mP95 = sorted[(mCount - 1) * 95 / 100];
+            summary.mP99 = sorted[(mCount - 1) * 99 / 100];
+        }
+
+        void PerformanceStats::Histogram::reset()
+        {
+            mNext = 0;
+            mCount = 0;
+        }
+
+        PerformanceStats::PerformanceStats() : mFramesDrawn(0), mFramesSkipped(0), mLastDrawEndTime(0)
+        {
+        }
+
+        void PerformanceStats::frameDone(const bool drawn, const double drawEndTime, const uint64_t drawTime, const uint64_t updateTime, const uint64_t frameTime)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mUpdateTime.add(updateTime);
+            mFrameTime.add(frameTime);
+            if (!drawn)
+            {
+                // the pause of an idle screen is no missed frame, intervals restart with the next drawn frame
+                mFramesSkipped++;
+                mLastDrawEndTime = 0;
+                return;
+            }
+            mFramesDrawn++;
+            mDrawTime.add(drawTime);
+            if (mLastDrawEndTime > 0)
+            {
+                mFrameInterval.add(static_cast<uint64_t>(drawEndTime - mLastDrawEndTime));
+            }
+            mLastDrawEndTime = drawEndTime;
+            for (std::vector<PendingKey>::const_iterator it = mPendingKeys.begin(); it != mPendingKeys.end(); ++it)
+            {
+                const uint64_t latency = static_cast<uint64_t>(std::max(drawEndTime - it->mTime, 0.0));
+                mKeyToFrameLatency.add(latency);
+                if (!it->mClient.empty())
+                {
+                    mClients[it->mClient].mKeyToFrameLatency.add(latency);
+                }
+            }
+            mPendingKeys.clear();
+        }
+
+        void PerformanceStats::keySent(const std::string& client, const double keyTime)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mPendingKeys.size() < RDKSHELL_PERFORMANCE_STATS_MAX_PENDING_KEYS)
+            {
+                PendingKey key = { client, keyTime };
+                mPendingKeys.push_back(key);
+            }
+        }
+
+        void PerformanceStats::clientFrameRate(const std::string& client, const uint32_t fps)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            ClientHistograms& histograms = mClients[client];
+            if (fps > 0)
+            {
+                histograms.mFrameIntervalFromFps.add(1000000 / fps);
+            }
+        }
+
+        void PerformanceStats::clientRemoved(const std::string& client)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mClients.erase(client);
+        }
+
+        void PerformanceStats::get(CompositorSummary& compositor, std::map<std::string, ClientSummary>& clients, const bool reset)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            compositor.mFramesDrawn = mFramesDrawn;
+            compositor.mFramesSkipped = mFramesSkipped;
+            mDrawTime.summarize(compositor.mDrawTime);
+            mUpdateTime.summarize(compositor.mUpdateTime);
+            mFrameTime.summarize(compositor.mFrameTime);
+            mFrameInterval.summarize(compositor.mFrameInterval);
+            mKeyToFrameLatency.summarize(compositor.mKeyToFrameLatency);
+            for (std::map<std::string, ClientHistograms>::const_iterator it = mClients.begin(); it != mClients.end(); ++it)
+            {
+                ClientSummary& summary = clients[it->first];
+                it->second.mFrameIntervalFromFps.summarize(summary.mFrameIntervalFromFps);
+                it->second.mKeyToFrameLatency.summarize(summary.mKeyToFrameLatency);
+            }
+            if (!reset)
+            {
+                return;
+            }
+            mFramesDrawn = 0;
+            mFramesSkipped = 0;
+            mDrawTime.reset();
+            mUpdateTime.reset();
+            mFrameTime.reset();
+            mFrameInterval.reset();
+            mKeyToFrameLatency.reset();
+            mLastDrawEndTime = 0;
+            for (std::map<std::string, ClientHistograms>::iterator it = mClients.begin(); it != mClients.end(); ++it)
+            {
+                it->second.mFrameIntervalFromFps.reset();
+                it->second.mKeyToFrameLatency.reset();
+            }
+        }
+
+        size_t PerformanceStats::bucketCount()
+        {
+            return sBucketCount;
+        }
+
+        uint64_t PerformanceStats::bucketLimit(const size_t bucket)
+        {
+            return (bucket < sBucketCount ? sBucketLimits[bucket] : 0);
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,141 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Frame counters and rolling timing histograms of the compositor and of every client, all
+        // times in microseconds. Each histogram keeps the last WINDOW samples so that it follows the
+        // current behaviour of a client instead of averaging over its lifetime. The render thread
+        // feeds it once per frame, getFrameStats and getPerformanceStats both read from it.
+        class PerformanceStats
+        {
+            public:
+                static const size_t WINDOW = 256;
+
+                struct Summary
+                {
+                    Summary() : mCount(0), mLast(0), mMin(0), mMax(0), mAverage(0), mP50(0), mP95(0), mP99(0) {}
+
+                    uint32_t mCount;
+                    uint64_t mLast;
+                    uint64_t mMin;
+                    uint64_t mMax;
+                    uint64_t mAverage;
+                    uint64_t mP50;
+                    uint64_t mP95;
+                    uint64_t mP99;
+                    // sample count per bucket, bucket i holds samples up to bucketLimit(i)
+                    std::vector<uint32_t> mBuckets;
+                };
+
+                struct ClientSummary
+                {
+                    // 1 second divided by the frame rate the client reports, not measured per commit
+                    Summary mFrameIntervalFromFps;
+                    Summary mKeyToFrameLatency;
+                };
+
+                struct CompositorSummary
+                {
+                    CompositorSummary() : mFramesDrawn(0), mFramesSkipped(0) {}
+
+                    uint64_t mFramesDrawn;
+                    uint64_t mFramesSkipped;
+                    Summary mDrawTime;
+                    Summary mUpdateTime;
+                    Summary mFrameTime;
+                    Summary mFrameInterval;
+                    Summary mKeyToFrameLatency;
+                };
+
+                PerformanceStats();
+                PerformanceStats(const PerformanceStats&) = delete;
+                PerformanceStats& operator=(const PerformanceStats&) = delete;
+
+                // render thread, once per frame. drawEndTime and drawTime are only used when the frame
+                // was drawn, a skipped frame still spends updateTime and frameTime.
+                void frameDone(const bool drawn, const double drawEndTime, const uint64_t drawTime, const uint64_t updateTime, const uint64_t frameTime);
+                // a key was sent at keyTime, to client or to the focused client when empty, its
+                // latency is measured up to the end of the next drawn frame, the compositor does not
+                // tell when the client committed the frame that shows the key
+                void keySent(const std::string& client, const double keyTime);
+                // frame rate reported by the client itself, sampled periodically
+                void clientFrameRate(const std::string& client, const uint32_t fps);
+                void clientRemoved(const std::string& client);
+
+                // reset clears the histograms in the same step, so that no sample is lost in between
+                void get(CompositorSummary& compositor, std::map<std::string, ClientSummary>& clients, const bool reset = false);
+
+                static size_t bucketCount();
+                // upper limit of a bucket in microseconds, 0 for the last unbounded one
+                static uint64_t bucketLimit(const size_t bucket);
+
+            private:
+                class Histogram
+                {
+                    public:
+                        Histogram();
+
+                        void add(const uint64_t sample);
+                        uint64_t last() const;
+                        void summarize(Summary& summary) const;
+                        void reset();
+
+                    private:
+                        uint64_t mSamples[WINDOW];
+                        size_t mNext;
+                        size_t mCount;
+                };
+
+                struct ClientHistograms
+                {
+                    Histogram mFrameIntervalFromFps;
+                    Histogram mKeyToFrameLatency;
+                };
+
+                struct PendingKey
+                {
+                    std::string mClient;
+                    double mTime;
+                };
+
+                std::mutex mMutex;
+                uint64_t mFramesDrawn;
+                uint64_t mFramesSkipped;
+                Histogram mDrawTime;
+                Histogram mUpdateTime;
+                Histogram mFrameTime;
+                Histogram mFrameInterval;
+                Histogram mKeyToFrameLatency;
+                double mLastDrawEndTime;
+                std::vector<PendingKey> mPendingKeys;
+                std::map<std::string, ClientHistograms> mClients;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
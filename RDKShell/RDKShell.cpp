@@ -23,8 +23,10 @@
 #include <iostream>
 #include <mutex>
 #include <thread>
+#include <future>
 #include <fstream>
 #include <sstream>
+#include <limits>
 #include <unistd.h>
 #include <rdkshell/compositorcontroller.h>
 #include <rdkshell/application.h>
@@ -34,7 +36,10 @@
 #include <plugins/System.h>
 #include <rdkshell/eastereggs.h>
 #include <rdkshell/linuxkeys.h>
-#include "base64.h"
+#include "CommandQueue.h"
+#include "ScreenshotEncoder.h"
+#include "FrameScheduler.h"
+#include "PerformanceStats.h"
 
 #ifdef RDKSHELL_READ_MAC_ON_STARTUP
 #include "FactoryProtectHal.h"
@@ -111,6 +116,13 @@ const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_ENABLE_VIRTUAL_DISP
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_VIRTUAL_DISPLAY_ENABLED = "getVirtualDisplayEnabled";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_LAST_WAKEUP_KEY = "getLastWakeupKey";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_SCREENSHOT = "getScreenshot";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_FRAME_STATS = "getFrameStats";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_SET_WARM_POOL = "setWarmPool";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_WARM_POOL = "getWarmPool";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_MEMORY_POLICY = "getMemoryPolicy";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_BATCH = "batch";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_GET_PERFORMANCE_STATS = "getPerformanceStats";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_METHOD_SET_PERFORMANCE_STATS_INTERVAL = "setPerformanceStatsInterval";
 
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_USER_INACTIVITY = "onUserInactivity";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_APP_LAUNCHED = "onApplicationLaunched";
@@ -132,6 +144,9 @@ const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_DEVICE_CRITICALLY_LO
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_EASTER_EGG = "onEasterEgg";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_WILL_DESTROY = "onWillDestroy";
 const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE = "onScreenshotComplete";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_APPLICATION_RECLAIMED = "onApplicationReclaimed";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_PERFORMANCE_STATS = "onPerformanceStats";
+const string WPEFramework::Plugin::RDKShell::RDKSHELL_EVENT_ON_LAUNCH_STAGE = "onLaunchStage";
 
 using namespace std;
 using namespace RdkShell;
@@ -157,14 +172,16 @@ bool sFactoryModeStart = false;
 bool sFactoryModeBlockResidentApp = false;
 bool sForceResidentAppLaunch = false;
 static bool sRunning = true;
-bool needsScreenshot = false;
+static uint8_t sPendingScreenshotFormats = 0;
 
 #define ANY_KEY 65536
 #define RDKSHELL_THUNDER_TIMEOUT 20000
 #define RDKSHELL_POWER_TIME_WAIT 2.5
 #define THUNDER_ACCESS_DEFAULT_VALUE "127.0.0.1:9998"
 #define RDKSHELL_WILLDESTROY_EVENT_WAITTIME 1
-#define RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS 250
+#define RDKSHELL_COMMAND_WAIT_TIME_IN_MS 20
+#define RDKSHELL_PERFORMANCE_STATS_SAMPLE_TIME_IN_MS 1000
+#define RDKSHELL_PERFORMANCE_STATS_REQUEST_SAMPLE_TIME_IN_MS 60000
 #define RDKSHELL_SPLASH_SCREEN_DISPLAY_TIME 5
 
 static std::string gThunderAccessValue = THUNDER_ACCESS_DEFAULT_VALUE;
@@ -386,14 +403,49 @@ namespace WPEFramework {
         SERVICE_REGISTRATION(RDKShell, 1, 0);
 
         RDKShell* RDKShell::_instance = nullptr;
-        std::mutex gRdkShellMutex;
+        // std::mutex that remembers its owner, so that compositor commands issued from code already
+        // running under the lock (e.g. compositor event listeners) are executed inline
+        class RdkShellMutex
+        {
+            public:
+                void lock()
+                {
+                    mMutex.lock();
+                    mOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                }
+                bool try_lock()
+                {
+                    if (!mMutex.try_lock())
+                    {
+                        return false;
+                    }
+                    mOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                    return true;
+                }
+                void unlock()
+                {
+                    mOwner.store(std::thread::id(), std::memory_order_relaxed);
+                    mMutex.unlock();
+                }
+                bool ownedByCurrentThread() const
+                {
+                    return (mOwner.load(std::memory_order_relaxed) == std::this_thread::get_id());
+                }
+
+            private:
+                std::mutex mMutex;
+                std::atomic<std::thread::id> mOwner;
+        };
+
+        RdkShellMutex gRdkShellMutex;
+        static CommandQueue gCommandQueue;
+        static FrameScheduler gFrameScheduler;
+        static PerformanceStats gPerformanceStats;
         std::mutex gPluginDataMutex;
         std::mutex gLaunchDestroyMutex;
 
-        std::mutex gLaunchMutex;
-        int32_t gLaunchCount = 0;
-
         static std::thread shellThread;
+        static ScreenshotEncoder gScreenshotEncoder;
 
         void RDKShell::launchRequestThread(RDKShellApiRequest apiRequest)
         {
@@ -416,23 +468,82 @@ namespace WPEFramework {
             rdkshellRequestsThread.detach();
         }
 
-        void lockRdkShellMutex()
+        // Compositor operations of the API handlers run on whichever thread holds gRdkShellMutex,
+        // normally the render thread between two frames. A handler only falls back to applying the
+        // queue itself when the render thread does not pick it up, e.g. while it is calling out to
+        // another plugin with the lock released or after it has stopped.
+        void runOnRenderThread(const std::function<void()>& function)
         {
-            bool lockAcquired = false;
-            double startTime = RdkShell::milliseconds();
-            while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
+            if (gRdkShellMutex.ownedByCurrentThread())
             {
-                lockAcquired = gRdkShellMutex.try_lock();
+                function();
+                gFrameScheduler.damage();
+                return;
             }
-            if (!lockAcquired)
+            CommandQueue::Command command(function);
+            std::future<void> done = command.mDone.get_future();
+            gCommandQueue.post(&command);
+            while (done.wait_for(std::chrono::milliseconds(RDKSHELL_COMMAND_WAIT_TIME_IN_MS)) != std::future_status::ready)
             {
-                std::cout << "unable to get lock for defaulting to normal lock\n";
-                gRdkShellMutex.lock();
+                if (gRdkShellMutex.try_lock())
+                {
+                    if (gCommandQueue.drain() > 0)
+                    {
+                        gFrameScheduler.damage();
+                    }
+                    gRdkShellMutex.unlock();
+                }
+            }
+            done.get();
+        }
+
+        // Calls out to other plugins made by the operations of a batch while it is being applied,
+        // only accessed by the thread holding gRdkShellMutex
+        static std::vector<std::function<void()>>* gBatchPluginCalls = nullptr;
+
+        // Points gBatchPluginCalls at the calls of a batch while the batch is applied, also when an
+        // operation throws
+        struct BatchPluginCallsScope
+        {
+            BatchPluginCallsScope(std::vector<std::function<void()>>& pluginCalls)
+            {
+                gBatchPluginCalls = &pluginCalls;
+            }
+            ~BatchPluginCallsScope()
+            {
+                gBatchPluginCalls = nullptr;
+            }
+        };
+
+        // Runs a call that does not touch the compositor. Inside a batch it is deferred until the
+        // batch has been applied, so the lock is not held while another plugin is waited for.
+        static void runOutsideBatch(const std::function<void()>& function)
+        {
+            if (gRdkShellMutex.ownedByCurrentThread() && (gBatchPluginCalls != nullptr))
+            {
+                gBatchPluginCalls->push_back(function);
+                return;
             }
-            /*else
+            function();
+        }
+
+        // whether a client can be seen, only a client that can be seen changes the screen by committing a
+        // new frame. Called by the render thread with gRdkShellMutex held.
+        static bool hasVisibleClient()
+        {
+            std::vector<std::string> clients;
+            CompositorController::getClients(clients);
+            for (std::vector<std::string>::const_iterator it = clients.begin(); it != clients.end(); ++it)
             {
-                std::cout << "lock was acquired via try\n";
-            }*/
+                bool visible = false;
+                unsigned int opacity = 0;
+                if (CompositorController::getVisibility(*it, visible) && visible &&
+                    CompositorController::getOpacity(*it, opacity) && (opacity > 0))
+                {
+                    return true;
+                }
+            }
+            return false;
         }
 
         void RDKShell::MonitorClients::StateChange(PluginHost::IShell* service)
@@ -451,10 +562,10 @@ namespace WPEFramework {
                    if (serviceConfig.HasLabel("clientidentifier"))
                    {
                        std::string clientidentifier = serviceConfig["clientidentifier"].String();
-                       gRdkShellMutex.lock();
-                       RdkShell::CompositorController::createDisplay(service->Callsign(), clientidentifier);
-                       RdkShell::CompositorController::addListener(clientidentifier, mShell.mEventListener);
-                       gRdkShellMutex.unlock();
+                       runOnRenderThread([&]() {
+                           RdkShell::CompositorController::createDisplay(service->Callsign(), clientidentifier);
+                           RdkShell::CompositorController::addListener(clientidentifier, mShell.mEventListener);
+                       });
                        gPluginDataMutex.lock();
                        std::string className = service->ClassName();
                        PluginData pluginData;
@@ -546,6 +657,8 @@ namespace WPEFramework {
                 }
                 else if (currentState == PluginHost::IShell::DEACTIVATED)
                 {
+                    mShell.mWarmPool.released(service->Callsign());
+                    gPerformanceStats.clientRemoved(service->Callsign());
                     std::string configLine = service->ConfigLine();
                     if (configLine.empty())
                     {
@@ -555,10 +668,10 @@ namespace WPEFramework {
                     if (serviceConfig.HasLabel("clientidentifier"))
                     {
                         std::string clientidentifier = serviceConfig["clientidentifier"].String();
-                        gRdkShellMutex.lock();
-                        RdkShell::CompositorController::kill(service->Callsign());
-                        RdkShell::CompositorController::removeListener(clientidentifier, mShell.mEventListener);
-                        gRdkShellMutex.unlock();
+                        runOnRenderThread([&]() {
+                            RdkShell::CompositorController::kill(service->Callsign());
+                            RdkShell::CompositorController::removeListener(clientidentifier, mShell.mEventListener);
+                        });
                     }
                     
                     gPluginDataMutex.lock();
@@ -585,7 +698,7 @@ namespace WPEFramework {
         }
 
         RDKShell::RDKShell()
-                : AbstractPlugin(API_VERSION_NUMBER_MAJOR), mClientsMonitor(Core::Service<MonitorClients>::Create<MonitorClients>(this)), mEnableUserInactivityNotification(true), mCurrentService(nullptr), mLastWakeupKeyCode(0), mLastWakeupKeyModifiers(0), mLastWakeupKeyTimestamp(0)
+                : AbstractPlugin(API_VERSION_NUMBER_MAJOR), mClientsMonitor(Core::Service<MonitorClients>::Create<MonitorClients>(this)), mEnableUserInactivityNotification(true), mCurrentService(nullptr), mLastWakeupKeyCode(0), mLastWakeupKeyModifiers(0), mLastWakeupKeyTimestamp(0), mPerformanceStatsInterval(0), mPerformanceStatsElapsed(0), mPerformanceStatsRequestedLeft(0)
         {
             LOGINFO("ctor");
             RDKShell::_instance = this;
@@ -658,8 +771,16 @@ namespace WPEFramework {
             registerMethod(RDKSHELL_METHOD_GET_VIRTUAL_DISPLAY_ENABLED, &RDKShell::getVirtualDisplayEnabledWrapper, this);
             registerMethod(RDKSHELL_METHOD_GET_LAST_WAKEUP_KEY, &RDKShell::getLastWakeupKeyWrapper, this);
             registerMethod(RDKSHELL_METHOD_GET_SCREENSHOT, &RDKShell::getScreenshotWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_FRAME_STATS, &RDKShell::getFrameStatsWrapper, this);
+            registerMethod(RDKSHELL_METHOD_SET_WARM_POOL, &RDKShell::setWarmPoolWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_WARM_POOL, &RDKShell::getWarmPoolWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_MEMORY_POLICY, &RDKShell::getMemoryPolicyWrapper, this);
+            registerMethod(RDKSHELL_METHOD_BATCH, &RDKShell::batchWrapper, this);
+            registerMethod(RDKSHELL_METHOD_GET_PERFORMANCE_STATS, &RDKShell::getPerformanceStatsWrapper, this);
+            registerMethod(RDKSHELL_METHOD_SET_PERFORMANCE_STATS_INTERVAL, &RDKShell::setPerformanceStatsIntervalWrapper, this);
 
             m_timer.connect(std::bind(&RDKShell::onTimer, this));
+            mPerformanceStatsTimer.connect(std::bind(&RDKShell::onPerformanceStatsTimer, this));
         }
 
         RDKShell::~RDKShell()
@@ -780,6 +901,37 @@ namespace WPEFramework {
                 sFactoryModeBlockResidentApp = true;
             }
 
+            char* disableIdleFrameSkip = getenv("RDKSHELL_DISABLE_IDLE_FRAME_SKIP");
+            if (NULL != disableIdleFrameSkip)
+            {
+                std::cout << "idle frame skipping is disabled\n";
+                gFrameScheduler.enable(false);
+            }
+
+            gScreenshotEncoder.start([this](const std::string& format, const uint32_t width, const uint32_t height, std::string& imageData) {
+                JsonObject params;
+                if (format.compare("shm") == 0)
+                {
+                    // only the name travels through the event, the consumer maps and unlinks the segment
+                    params["shmName"] = imageData;
+                    params["size"] = width * height * 4;
+                }
+                else
+                {
+                    params["imageData"] = imageData;
+                }
+                params["format"] = format;
+                if (format.compare("raw") != 0)
+                {
+                    params["width"] = width;
+                    params["height"] = height;
+                }
+                imageData.clear();
+                // not through notify(): sendNotify serializes the whole payload once more only to log it
+                std::cout << "Notify " << RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE << " format: " << format << std::endl;
+                Notify(RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE, params);
+            });
+
             shellThread = std::thread([=]() {
                 bool isRunning = true;
                 gRdkShellMutex.lock();
@@ -828,25 +980,33 @@ namespace WPEFramework {
                   const double maxSleepTime = (1000 / gCurrentFramerate) * 1000;
                   double startFrameTime = RdkShell::microseconds();
                   gRdkShellMutex.lock();
+                  if (gCommandQueue.drain() > 0)
+                  {
+                      gFrameScheduler.damage();
+                  }
                   if (receivedResolutionRequest)
                   {
                     CompositorController::setScreenResolution(resolutionWidth, resolutionHeight);
                     receivedResolutionRequest = false;
+                    gFrameScheduler.damage();
                   }
                   if (receivedFullScreenImageRequest)
                   {
                     CompositorController::showFullScreenImage(fullScreenImagePath);
                     fullScreenImagePath = "";
                     receivedFullScreenImageRequest = false;
+                    gFrameScheduler.damage();
                   }
                   if (receivedShowWatermarkRequest)
                   {
                     CompositorController::showWatermark();
                     receivedShowWatermarkRequest = false;
+                    gFrameScheduler.damage();
                   }
                   if (receivedShowSplashScreenRequest)
                   {
                     CompositorController::showSplashScreen(gSplashScreenDisplayTime);
+                    gFrameScheduler.animateUntil(RdkShell::seconds() + gSplashScreenDisplayTime);
                     gSplashScreenDisplayTime = 0;
                     receivedShowSplashScreenRequest = false;
                   }
@@ -913,37 +1073,51 @@ namespace WPEFramework {
                         std::cout << "not launching factory app as conditions not matched\n";
                     }
                   }
-                  RdkShell::draw();
-                  if (needsScreenshot)
+                  // librdkshell does not report client commits, so a client that can be seen may change the
+                  // screen at any time. Otherwise only commands, animations and screenshots do.
+                  double drawStartTime = RdkShell::microseconds();
+                  const bool drawFrame = (sPendingScreenshotFormats != 0) || gFrameScheduler.needsDraw(RdkShell::seconds(), hasVisibleClient);
+                  if (drawFrame)
+                  {
+                      RdkShell::draw();
+                  }
+                  double updateStartTime = RdkShell::microseconds();
+                  if (sPendingScreenshotFormats)
                   {
+                      // only the readback happens here, encoding is done by the screenshot encoder thread
                       uint8_t* data = nullptr;
-                      size_t size;
-                      string screenshotBase64;
+                      size_t size = 0;
+                      unsigned int width = 0, height = 0;
                       CompositorController::screenShot(data, size);
-                      size_t encodedImageSize = b64_get_encoded_buffer_size(size);
-                      uint8_t *encodedImage = (uint8_t*)malloc(encodedImageSize);
-                      b64_encode(&data[0], size, encodedImage);
-                      std::stringstream list1;
-                      for (unsigned int i=0; i<encodedImageSize; ++i){
-                         list1 << encodedImage[i];
-                      }
-                      screenshotBase64 = list1.str();
-                      std::cout << "Screenshot success size:" << size << std::endl;
-                      JsonObject params;
-                      params["imageData"] = screenshotBase64;
-                      notify(RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE, params);
-                      free(encodedImage);
-                      free(data);
-                      needsScreenshot = false;
+                      CompositorController::getScreenResolution(width, height);
+                      gScreenshotEncoder.submit(data, size, width, height, sPendingScreenshotFormats);
+                      sPendingScreenshotFormats = 0;
                   }
                   RdkShell::update();
                   isRunning = sRunning;
                   gRdkShellMutex.unlock();
-                  double frameTime = (int)RdkShell::microseconds() - (int)startFrameTime;
-                  if (frameTime < maxSleepTime)
+                  double frameTime = RdkShell::microseconds() - startFrameTime;
+                  gPerformanceStats.frameDone(drawFrame, updateStartTime, updateStartTime - drawStartTime, startFrameTime + frameTime - updateStartTime, frameTime);
+                  // apply commands posted while idle right away instead of at the next frame, an idle
+                  // frame is cut short so that the change is drawn immediately
+                  while (isRunning && (frameTime < maxSleepTime))
                   {
                       int sleepTime = (int)maxSleepTime-(int)frameTime;
-                      usleep(sleepTime);
+                      if (gCommandQueue.waitFor(std::chrono::microseconds(sleepTime)))
+                      {
+                          gRdkShellMutex.lock();
+                          size_t commandCount = gCommandQueue.drain();
+                          gRdkShellMutex.unlock();
+                          if (commandCount > 0)
+                          {
+                              gFrameScheduler.damage();
+                              if (!drawFrame)
+                              {
+                                  break;
+                              }
+                          }
+                      }
+                      frameTime = RdkShell::microseconds() - startFrameTime;
                   }
                 }
             });
@@ -956,12 +1130,62 @@ namespace WPEFramework {
             }
             loadStartupConfig();
             invokeStartupThunderApis();
+
+            mWarmPool.start([this](const WarmPool::Entry& entry) {
+                JsonObject request, response;
+                request["callsign"] = entry.mCallsign;
+                request["type"] = entry.mType;
+                if (!entry.mUri.empty())
+                {
+                    request["uri"] = entry.mUri;
+                }
+                request["suspend"] = true;
+                request["visible"] = false;
+                request["focused"] = false;
+                launchWrapper(request, response);
+                return (response.HasLabel("success") && response["success"].Boolean());
+            }, [this](const std::string& callsign) {
+                uint32_t residentKb = 0;
+                Exchange::IMemory* pluginMemoryInterface(mCurrentService->QueryInterfaceByCallsign<Exchange::IMemory>(callsign.c_str()));
+                if (nullptr != pluginMemoryInterface)
+                {
+                    residentKb = pluginMemoryInterface->Resident()/1024;
+                    pluginMemoryInterface->Release();
+                }
+                return residentKb;
+            }, [](const std::string& callsign) {
+                JsonObject joParams;
+                joParams.Set("callsign", callsign.c_str());
+                JsonObject joResult;
+                uint32_t status = getThunderControllerClient()->Invoke(RDKSHELL_THUNDER_TIMEOUT, "deactivate", joParams, joResult);
+                if (status > 0)
+                {
+                    std::cout << "failed to destroy warm instance " << callsign << ".  status: " << status << std::endl;
+                }
+            });
+            char* warmPoolConfigFileName = getenv("RDKSHELL_WARM_POOL_CONFIG");
+            if (NULL != warmPoolConfigFileName)
+            {
+                std::ifstream warmPoolConfigFile(warmPoolConfigFileName, std::ifstream::binary);
+                std::stringstream strStream;
+                strStream << warmPoolConfigFile.rdbuf();
+                JsonObject warmPoolConfig;
+                if (!warmPoolConfigFile.is_open() || !warmPoolConfig.FromString(strStream.str()) || !configureWarmPool(warmPoolConfig))
+                {
+                    std::cout << "RDKShell warm pool config file read error : [" << warmPoolConfigFileName << "]\n";
+                }
+            }
             char* willDestroyWaitTimeValue = getenv("RDKSHELL_WILLDESTROY_EVENT_WAITTIME");
             if (NULL != willDestroyWaitTimeValue)
             {
                 gWillDestroyEventWaitTime = atoi(willDestroyWaitTimeValue); 
             }
 
+            startMemoryPolicy(service->ConfigLine());
+
+            mPerformanceStatsTimer.setInterval(RDKSHELL_PERFORMANCE_STATS_SAMPLE_TIME_IN_MS);
+            mPerformanceStatsTimer.start();
+
             m_timer.setInterval(RECONNECTION_TIME_IN_MILLISECONDS);
             m_timer.start();
             std::cout << "Started SystemServices connection timer" << std::endl;
@@ -1111,10 +1335,14 @@ namespace WPEFramework {
         void RDKShell::Deinitialize(PluginHost::IShell* service)
         {
             LOGINFO("Deinitialize");
+            mPerformanceStatsTimer.stop();
+            mMemoryPolicy.stop();
+            mWarmPool.stop();
             gRdkShellMutex.lock();
             sRunning = false;
             gRdkShellMutex.unlock();
             shellThread.join();
+            gScreenshotEncoder.stop();
             mCurrentService = nullptr;
             service->Unregister(mClientsMonitor);
             mClientsMonitor->Release();
@@ -1171,9 +1399,9 @@ namespace WPEFramework {
                 if ((prevState == "STANDBY" || prevState == "LIGHT_SLEEP" || prevState == "DEEP_SLEEP" || prevState == "OFF")
                     && powerState == "ON")
                 {
-                    gRdkShellMutex.lock();
-                    CompositorController::getLastKeyPress(mLastWakeupKeyCode, mLastWakeupKeyModifiers, mLastWakeupKeyTimestamp);
-                    gRdkShellMutex.unlock();
+                    runOnRenderThread([&]() {
+                        CompositorController::getLastKeyPress(mLastWakeupKeyCode, mLastWakeupKeyModifiers, mLastWakeupKeyTimestamp);
+                    });
                 }
             }
         }
@@ -1811,9 +2039,9 @@ namespace WPEFramework {
                 {
                     client = parameters["callsign"].String();
                 }
-                gRdkShellMutex.lock();
-                result = CompositorController::addKeyMetadataListener(client);
-                gRdkShellMutex.unlock();
+                runOnRenderThread([&]() {
+                    result = CompositorController::addKeyMetadataListener(client);
+                });
                 if (false == result) {
                   response["message"] = "failed to add key metadata listeners";
                 }
@@ -1843,9 +2071,9 @@ namespace WPEFramework {
                 {
                     client = parameters["callsign"].String();
                 }
-                lockRdkShellMutex();
-                result = CompositorController::removeKeyMetadataListener(client);
-                gRdkShellMutex.unlock();
+                runOnRenderThread([&]() {
+                    result = CompositorController::removeKeyMetadataListener(client);
+                });
                 if (false == result) {
                   response["message"] = "failed to remove key metadata listeners";
                 }
@@ -2101,9 +2329,9 @@ namespace WPEFramework {
                 }
 
                 unsigned int x=0,y=0,w=0,h=0;
-                lockRdkShellMutex();
-                CompositorController::getBounds(client, x, y, w, h);
-                gRdkShellMutex.unlock();
+                runOnRenderThread([&]() {
+                    CompositorController::getBounds(client, x, y, w, h);
+                });
                 if (parameters.HasLabel("x"))
                 {
                     x  = parameters["x"].Number();
@@ -2442,9 +2670,9 @@ namespace WPEFramework {
             LOGINFOMETHOD();
             bool result = true;
             std::string logLevel = "INFO";
-            lockRdkShellMutex();
-            result = CompositorController::getLogLevel(logLevel);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                result = CompositorController::getLogLevel(logLevel);
+            });
             if (false == result) {
                 response["message"] = "failed to get log level";
             }
@@ -2467,10 +2695,10 @@ namespace WPEFramework {
             {
                 std::string logLevel  = parameters["logLevel"].String();
                 std::string currentLogLevel = "INFO";
-                lockRdkShellMutex();
-                result = CompositorController::setLogLevel(logLevel);
-                CompositorController::getLogLevel(currentLogLevel);
-                gRdkShellMutex.unlock();
+                runOnRenderThread([&]() {
+                    result = CompositorController::setLogLevel(logLevel);
+                    CompositorController::getLogLevel(currentLogLevel);
+                });
                 if (false == result) {
                     response["message"] = "failed to set log level";
                 }
@@ -2494,10 +2722,10 @@ namespace WPEFramework {
             if (result)
             {
                 uint32_t displayTime = parameters["displayTime"].Number();
-                lockRdkShellMutex();
-                gSplashScreenDisplayTime = displayTime;
-                receivedShowSplashScreenRequest = true;
-                gRdkShellMutex.unlock();
+                runOnRenderThread([&]() {
+                    gSplashScreenDisplayTime = displayTime;
+                    receivedShowSplashScreenRequest = true;
+                });
                 if (false == result) {
                     response["message"] = "failed to show splash screen";
                 }
@@ -2510,9 +2738,9 @@ namespace WPEFramework {
             LOGINFOMETHOD();
             bool result = true;
 
-            lockRdkShellMutex();
-            result = CompositorController::hideSplashScreen();
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                result = CompositorController::hideSplashScreen();
+            });
 
             returnResponse(result);
         }
@@ -2664,26 +2892,26 @@ namespace WPEFramework {
 
                 unsigned int x = 0, y = 0;
                 unsigned int clientWidth = 0, clientHeight = 0;
-                lockRdkShellMutex();
-                CompositorController::getBounds(client, x, y, clientWidth, clientHeight);
-                if (parameters.HasLabel("x"))
-                {
-                    x = parameters["x"].Number();
-                }
-                if (parameters.HasLabel("y"))
-                {
-                    y = parameters["y"].Number();
-                }
-                if (parameters.HasLabel("w"))
-                {
-                    clientWidth = parameters["w"].Number();
-                }
-                if (parameters.HasLabel("h"))
-                {
-                    clientHeight = parameters["h"].Number();
-                }
-                result = CompositorController::scaleToFit(client, x, y, clientWidth, clientHeight);
-                gRdkShellMutex.unlock();
+                runOnRenderThread([&]() {
+                    CompositorController::getBounds(client, x, y, clientWidth, clientHeight);
+                    if (parameters.HasLabel("x"))
+                    {
+                        x = parameters["x"].Number();
+                    }
+                    if (parameters.HasLabel("y"))
+                    {
+                        y = parameters["y"].Number();
+                    }
+                    if (parameters.HasLabel("w"))
+                    {
+                        clientWidth = parameters["w"].Number();
+                    }
+                    if (parameters.HasLabel("h"))
+                    {
+                        clientHeight = parameters["h"].Number();
+                    }
+                    result = CompositorController::scaleToFit(client, x, y, clientWidth, clientHeight);
+                });
 
                 if (!result) {
                   response["message"] = "failed to scale to fit";
@@ -2705,39 +2933,27 @@ namespace WPEFramework {
             }
 
             string appCallsign("");
-            /*if (result)
-            {
-                bool launchInProgress = false;
-                int32_t currentLaunchCount = 0;
-                gLaunchMutex.lock();
-                if (gLaunchCount > 0)
-                {
-                    launchInProgress = true;
-                }
-                else
-                {
-                    gLaunchCount++;
-                }
-                currentLaunchCount = gLaunchCount;
-                gLaunchMutex.unlock();
-                std::cout << "the current launch count is " << currentLaunchCount << std::endl;
-                if (launchInProgress)
-                {
-                    const string appCallsign = parameters["callsign"].String();
-                    std::cout << "launch is in progress.  not able to launch another app: " << appCallsign << std::endl;
-                    response["message"] = "failed to launch application.  another launch is in progress";
-                    returnResponse(false);
-                }
-            }*/
             if (result)
             {
                 appCallsign = parameters["callsign"].String();
+                // the warm-up of a pooled instance is a launch of the same callsign, a launch during it waits
+                // for it instead of being rejected below
+                const bool poolLaunch = mWarmPool.isPoolThread();
+                if (!poolLaunch)
+                {
+                    mWarmPool.waitForWarmUp(appCallsign);
+                }
                 bool isApplicationBeingDestroyed = false;
+                bool isApplicationBeingLaunched = false;
                 gLaunchDestroyMutex.lock();
                 if (gDestroyApplications.find(appCallsign) != gDestroyApplications.end())
                 {
                     isApplicationBeingDestroyed = true;
                 }
+                else if (gLaunchApplications.find(appCallsign) != gLaunchApplications.end())
+                {
+                    isApplicationBeingLaunched = true;
+                }
                 else
                 {
                     gLaunchApplications[appCallsign] = true;
@@ -2745,12 +2961,18 @@ namespace WPEFramework {
                 gLaunchDestroyMutex.unlock();
                 if (isApplicationBeingDestroyed)
                 {
-                    gLaunchMutex.lock();
-                    gLaunchCount = 0;
-                    gLaunchMutex.unlock();
                     response["message"] = "failed to launch application due to active destroy request";
                     returnResponse(false);
                 }
+                if (isApplicationBeingLaunched)
+                {
+                    std::cout << "launch of " << appCallsign << " is already in progress" << std::endl;
+                    response["message"] = "failed to launch application.  launch of the same application is in progress";
+                    returnResponse(false);
+                }
+                // a warm instance is already activated and suspended, the launch below only resumes it
+                const bool warmLaunch = mWarmPool.claim(appCallsign);
+                response["warm"] = warmLaunch;
                 RDKShellLaunchType launchType = RDKShellLaunchType::UNKNOWN;
                 const string callsign = parameters["callsign"].String();
                 const string callsignWithVersion = callsign + ".1";
@@ -2834,31 +3056,13 @@ namespace WPEFramework {
                     if (topmost)
                     {
                         std::string topmostClient;
-                        {
-                            bool lockAcquired = false;
-                            double startTime = RdkShell::milliseconds();
-                            while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
-                            {
-                                lockAcquired = gRdkShellMutex.try_lock();
-                            }
-                            if (!lockAcquired)
-                            {
-                                std::cout << "unable to get lock for topmost, defaulting to normal lock\n";
-                                gRdkShellMutex.lock();
-                            }
-                            else
-                            {
-                                std::cout << "lock was acquired via try for topmost\n";
-                            }
-                        }
-                        bool topmostResult =  CompositorController::getTopmost(topmostClient);
-                        gRdkShellMutex.unlock();
+                        runOnRenderThread([&]() {
+                            CompositorController::getTopmost(topmostClient);
+                        });
                         if (!topmostClient.empty())
                         {
                             response["message"] = "failed to launch application.  topmost application already present";
-                            gLaunchMutex.lock();
-                            gLaunchCount = 0;
-                            gLaunchMutex.unlock();
+                            mWarmPool.released(appCallsign);
 		            gLaunchDestroyMutex.lock();
                             gLaunchApplications.erase(appCallsign);
 		            gLaunchDestroyMutex.unlock();
@@ -2886,6 +3090,10 @@ namespace WPEFramework {
                 }
                 auto thunderController = std::unique_ptr<JSONRPCDirectLink>(new JSONRPCDirectLink(mCurrentService));
                 //auto thunderController = getThunderControllerClient();
+                double stageStartTime = launchStartTime;
+                double displayStartTime = 0;
+                double displayEndTime = 0;
+                std::future<void> displayCreated;
                 if ((false == newPluginFound) && (false == originalPluginFound))
                 {
                     Core::JSON::ArrayType<PluginHost::MetaData::Service> availablePluginResult;
@@ -2917,22 +3125,21 @@ namespace WPEFramework {
                     pluginsFound = availablePluginResult.Length();
                 }
 
+                onLaunchStage(callsign, "prepare", stageStartTime, RdkShell::seconds(), launchStartTime);
                 if (!newPluginFound && !originalPluginFound)
                 {
                     std::cout << "number of types found: " << pluginsFound << std::endl;
                     response["message"] = "failed to launch application.  type not found";
-                    gLaunchMutex.lock();
-                    gLaunchCount = 0;
-                    gLaunchMutex.unlock();
+                    mWarmPool.released(appCallsign);
 		    gLaunchDestroyMutex.lock();
                     gLaunchApplications.erase(appCallsign);
 		    gLaunchDestroyMutex.unlock();
-                    std::cout << "new launch count loc1: 0\n";
                     returnResponse(false);
                 }
                 else if (!newPluginFound)
                 {
                     std::cout << "attempting to clone type: " << type << " into " << callsign << std::endl;
+                    stageStartTime = RdkShell::seconds();
                     JsonObject joParams;
                     joParams.Set("callsign", type);
                     joParams.Set("newcallsign",callsign.c_str());
@@ -2956,26 +3163,42 @@ namespace WPEFramework {
                     joParams.ToString(strParams);
                     joResult.ToString(strResult);
                     launchType = RDKShellLaunchType::CREATE;
-                    {
-                        bool lockAcquired = false;
-                        double startTime = RdkShell::milliseconds();
-                        while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
-                        {
-                            lockAcquired = gRdkShellMutex.try_lock();
-                        }
-                        if (!lockAcquired)
-                        {
-                            std::cout << "unable to get lock for create display, defaulting to normal lock\n";
-                            gRdkShellMutex.lock();
-                        }
-                        else
+                    onLaunchStage(callsign, "clone", stageStartTime, RdkShell::seconds(), launchStartTime);
+
+                    // the display is created while the configuration is updated, it is waited for before
+                    // the activation because the application connects to it as soon as it starts. A caller
+                    // holding the render lock creates it when waiting since another thread could not get it
+                    displayStartTime = RdkShell::seconds();
+                    displayCreated = std::async(gRdkShellMutex.ownedByCurrentThread() ? std::launch::deferred : std::launch::async, [&]() {
+                        runOnRenderThread([&]() {
+                            RdkShell::CompositorController::createDisplay(callsign, displayName, width, height);
+                        });
+                        displayEndTime = RdkShell::seconds();
+                    });
+                }
+
+                // the state of an existing plugin only decides whether it has to be activated, it is
+                // queried on its own link while the configuration is updated
+                Core::JSON::ArrayType<PluginHost::MetaData::Service> serviceResults;
+                std::future<uint32_t> statusQuery;
+                if (launchType == RDKShellLaunchType::UNKNOWN)
+                {
+                    statusQuery = std::async(std::launch::async, [&]() {
+                        JSONRPCDirectLink statusController(mCurrentService);
+                        string statusMethod = "status@"+callsign;
+                        uint32_t statusQueryStatus = statusController.Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(RDKSHELL_THUNDER_TIMEOUT, statusMethod.c_str(),serviceResults);
+
+                        std::cout << "get status: " << statusQueryStatus << std::endl;
+                        if (statusQueryStatus > 0)
                         {
-                            std::cout << "lock was acquired via try for create display\n";
+                            std::cout << "trying status one more time...\n";
+                            statusQueryStatus = statusController.Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(RDKSHELL_THUNDER_TIMEOUT, statusMethod.c_str(),serviceResults);
+                            std::cout << "get status: " << statusQueryStatus << std::endl;
                         }
-                    }
-                    RdkShell::CompositorController::createDisplay(callsign, displayName, width, height);
-                    gRdkShellMutex.unlock();
+                        return statusQueryStatus;
+                    });
                 }
+                stageStartTime = RdkShell::seconds();
 
                 WPEFramework::Core::JSON::String configString;
 
@@ -3064,20 +3287,18 @@ namespace WPEFramework {
                     std::cout << "set status: " << status << std::endl;
                 }
 
-                if (launchType == RDKShellLaunchType::UNKNOWN)
+                onLaunchStage(callsign, "configure", stageStartTime, RdkShell::seconds(), launchStartTime);
+
+                if (displayCreated.valid())
                 {
-                    status = 0;
-                    string statusMethod = "status@"+callsign;
-                    Core::JSON::ArrayType<PluginHost::MetaData::Service> serviceResults;
-                    status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(RDKSHELL_THUNDER_TIMEOUT, statusMethod.c_str(),serviceResults);
+                    displayCreated.get();
+                    onLaunchStage(callsign, "display", displayStartTime, displayEndTime, launchStartTime);
+                }
 
-                    std::cout << "get status: " << status << std::endl;
-                    if (status > 0)
-                    {
-                        std::cout << "trying status one more time...\n";
-                        status = thunderController->Get<Core::JSON::ArrayType<PluginHost::MetaData::Service> >(RDKSHELL_THUNDER_TIMEOUT, statusMethod.c_str(),serviceResults);
-                        std::cout << "get status: " << status << std::endl;
-                    }
+                stageStartTime = RdkShell::seconds();
+                if (launchType == RDKShellLaunchType::UNKNOWN)
+                {
+                    status = statusQuery.get();
 
                     if (status == 0 && serviceResults.Length() > 0)
                     {
@@ -3136,6 +3357,8 @@ namespace WPEFramework {
                     }
                 }
 
+                onLaunchStage(callsign, "activate", stageStartTime, RdkShell::seconds(), launchStartTime);
+
                 bool deferLaunch = false;
                 if (status > 0)
                 {
@@ -3144,29 +3367,79 @@ namespace WPEFramework {
                 }
                 else
                 {
-                    uint32_t tempX = 0;
-                    uint32_t tempY = 0;
-                    uint32_t screenWidth = 0;
-                    uint32_t screenHeight = 0;
+                    gPluginDataMutex.lock();
                     {
-                        bool lockAcquired = false;
-                        double startTime = RdkShell::milliseconds();
-                        while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
-                        {
-                            lockAcquired = gRdkShellMutex.try_lock();
+                      auto notificationIt = gStateNotifications.find(callsign);
+                      if (notificationIt == gStateNotifications.end()) {
+                        PluginHost::IStateControl* stateControl(mCurrentService->QueryInterfaceByCallsign<PluginHost::IStateControl>(callsign));
+                        if (stateControl) {
+                          auto* handler = new Core::Sink<StateControlNotification>(callsign, *this);
+                          stateControl->Register(handler);
+                          stateControl->Release();
+                          gStateNotifications[callsign] = handler;
                         }
-                        if (!lockAcquired)
+                      } else {
+                        notificationIt->second->enableLaunch(true);
+                        deferLaunch = true;
+                      }
+                    }
+                    gPluginDataMutex.unlock();
+
+                    if (setSuspendResumeStateOnLaunch)
+                    {
+                        if (launchType == RDKShellLaunchType::UNKNOWN)
                         {
-                            std::cout << "unable to get lock for get bounds, defaulting to normal lock\n";
-                            gRdkShellMutex.lock();
+                            gPluginDataMutex.lock();
+                            std::map<std::string, PluginStateChangeData*>::iterator pluginStateChangeEntry = gPluginsEventListener.find(callsign);
+                            if (pluginStateChangeEntry != gPluginsEventListener.end())
+                            {
+                                PluginStateChangeData* data = pluginStateChangeEntry->second;
+                                data->enableLaunch(true);
+                                deferLaunch = true;
+                            }
+                            gPluginDataMutex.unlock();
+                            launchType = (suspend ? RDKShellLaunchType::SUSPEND : RDKShellLaunchType::RESUME);
                         }
-                        else
+                        if (suspend)
                         {
-                            std::cout << "lock was acquired via try for get bounds\n";
+                            visible = false;
                         }
                     }
-                    CompositorController::getBounds(callsign, tempX, tempY, screenWidth, screenHeight);
-                    gRdkShellMutex.unlock();
+
+                    // the state and the url are set on the plugin while the compositor lays out its display
+                    const double loadStartTime = RdkShell::seconds();
+                    double loadEndTime = loadStartTime;
+                    std::future<uint32_t> loaded = std::async(std::launch::async, [&]() {
+                        uint32_t loadStatus = 0;
+                        if (setSuspendResumeStateOnLaunch)
+                        {
+                            WPEFramework::Core::JSON::String stateString;
+                            stateString = (suspend ? "suspended" : "resumed");
+                            loadStatus = JSONRPCDirectLink(mCurrentService, callsign).Set<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
+                            std::cout << "setting the state to " << (suspend ? "suspended" : "resumed") << std::endl;
+                        }
+                        if (!uri.empty())
+                        {
+                            WPEFramework::Core::JSON::String urlString;
+                            urlString = uri;
+                            loadStatus = JSONRPCDirectLink(mCurrentService, callsign).Set<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "url",urlString);
+                            if (loadStatus > 0)
+                            {
+                                std::cout << "failed to set url to " << uri << " with status code " << loadStatus << std::endl;
+                            }
+                        }
+                        loadEndTime = RdkShell::seconds();
+                        return loadStatus;
+                    });
+
+                    stageStartTime = RdkShell::seconds();
+                    uint32_t tempX = 0;
+                    uint32_t tempY = 0;
+                    uint32_t screenWidth = 0;
+                    uint32_t screenHeight = 0;
+                    runOnRenderThread([&]() {
+                        CompositorController::getBounds(callsign, tempX, tempY, screenWidth, screenHeight);
+                    });
                     width = screenWidth;
                     height = screenHeight;
                     if (parameters.HasLabel("x"))
@@ -3185,27 +3458,11 @@ namespace WPEFramework {
                     {
                         height = parameters["h"].Number();
                     }
-                    {
-                        bool lockAcquired = false;
-                        double startTime = RdkShell::milliseconds();
-                        while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
-                        {
-                            lockAcquired = gRdkShellMutex.try_lock();
-                        }
-                        if (!lockAcquired)
-                        {
-                            std::cout << "unable to get lock for set bounds, defaulting to normal lock\n";
-                            gRdkShellMutex.lock();
-                        }
-                        else
-                        {
-                            std::cout << "lock was acquired via try for set bounds\n";
-                        }
-                    }
-                    std::cout << "setting the desired bounds\n";
-                    CompositorController::setBounds(callsign, 0, 0, 1, 1); //forcing a compositor resize flush
-                    CompositorController::setBounds(callsign, x, y, width, height);
-                    gRdkShellMutex.unlock();
+                    runOnRenderThread([&]() {
+                        std::cout << "setting the desired bounds\n";
+                        CompositorController::setBounds(callsign, 0, 0, 1, 1); //forcing a compositor resize flush
+                        CompositorController::setBounds(callsign, x, y, width, height);
+                    });
 
                     if (scaleToFit)
                     {
@@ -3234,97 +3491,23 @@ namespace WPEFramework {
                         }
                     }
 
-                    gPluginDataMutex.lock();
+                    setVisibility(callsign, visible);
+                    setHolePunch(callsign, holePunch);
+                    if (!visible)
                     {
-                      auto notificationIt = gStateNotifications.find(callsign);
-                      if (notificationIt == gStateNotifications.end()) {
-                        PluginHost::IStateControl* stateControl(mCurrentService->QueryInterfaceByCallsign<PluginHost::IStateControl>(callsign));
-                        if (stateControl) {
-                          auto* handler = new Core::Sink<StateControlNotification>(callsign, *this);
-                          stateControl->Register(handler);
-                          stateControl->Release();
-                          gStateNotifications[callsign] = handler;
-                        }
-                      } else {
-                        notificationIt->second->enableLaunch(true);
-                        deferLaunch = true;
-                      }
+                        focused = false;
                     }
-                    gPluginDataMutex.unlock();
- 
-                    if (setSuspendResumeStateOnLaunch)
-                    {
-                        if (suspend)
-                        {
-                            if (launchType == RDKShellLaunchType::UNKNOWN)
-                            {
-                                gPluginDataMutex.lock();
-                                std::map<std::string, PluginStateChangeData*>::iterator pluginStateChangeEntry = gPluginsEventListener.find(callsign);
-                                if (pluginStateChangeEntry != gPluginsEventListener.end())
-                                {
-                                    PluginStateChangeData* data = pluginStateChangeEntry->second;
-                                    data->enableLaunch(true);
-                                    deferLaunch = true;
-                                }
-                                gPluginDataMutex.unlock();
-                                launchType = RDKShellLaunchType::SUSPEND;
-                            }
-
-                            WPEFramework::Core::JSON::String stateString;
-                            stateString = "suspended";
-                            status = JSONRPCDirectLink(mCurrentService, callsign).Set<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
-                            
-                            std::cout << "setting the state to suspended\n";
-                            visible = false;
-                        }
-                        else
-                        {
-                            if (launchType == RDKShellLaunchType::UNKNOWN)
-                            {
-                                gPluginDataMutex.lock();
-                                std::map<std::string, PluginStateChangeData*>::iterator pluginStateChangeEntry = gPluginsEventListener.find(callsign);
-                                if (pluginStateChangeEntry != gPluginsEventListener.end())
-                                {
-                                    PluginStateChangeData* data = pluginStateChangeEntry->second;
-                                    data->enableLaunch(true);
-                                    deferLaunch = true;
-                                }
-                                gPluginDataMutex.unlock();
-                                launchType = RDKShellLaunchType::RESUME;
-                            }
-                            
-                            WPEFramework::Core::JSON::String stateString;
-                            stateString = "resumed";
-                            status = JSONRPCDirectLink(mCurrentService, callsign).Set<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "state", stateString);
-
-                            std::cout << "setting the state to resumed\n";
-                        }
-                    }
-
-                    setVisibility(callsign, visible);
-                    setHolePunch(callsign, holePunch);
-                    if (!visible)
-                    {
-                        focused = false;
-                    }
-                    if (focused)
+                    if (focused)
                     {
                         std::cout << "setting the focused app to " << callsign << std::endl;
                         setFocus(callsign);
                     }
 
                     bool setTopmostResult = setTopmost(callsign, topmost);
-                    JsonObject urlResult;
-                    if (!uri.empty())
-                    {
-                        WPEFramework::Core::JSON::String urlString;
-                        urlString = uri;
-                        status = JSONRPCDirectLink(mCurrentService, callsign).Set<WPEFramework::Core::JSON::String>(RDKSHELL_THUNDER_TIMEOUT, "url",urlString);
-                        if (status > 0)
-                        {
-                            std::cout << "failed to set url to " << uri << " with status code " << status << std::endl;
-                        }
-                    }
+                    onLaunchStage(callsign, "layout", stageStartTime, RdkShell::seconds(), launchStartTime);
+
+                    status = loaded.get();
+                    onLaunchStage(callsign, "load", loadStartTime, loadEndTime, launchStartTime);
                 }
 
                 if (status > 0 || !result)
@@ -3352,14 +3535,15 @@ namespace WPEFramework {
                             launchTypeString = "unknown";
                             break;
                     }
-                    std::cout << "Application:" << callsign << " took " << (RdkShell::seconds() - launchStartTime)*1000 << " milliseconds to launch " << std::endl;
-                    gLaunchMutex.lock();
-                    gLaunchCount = 0;
-                    gLaunchMutex.unlock();
+                    std::cout << "Application:" << callsign << " took " << (RdkShell::seconds() - launchStartTime)*1000 << " milliseconds to launch " << (warmLaunch ? "warm" : "cold") << std::endl;
                     if (setSuspendResumeStateOnLaunch && deferLaunch && ((launchType == SUSPEND) || (launchType == RESUME)))
                     {
                         std::cout << "deferring application launch " << std::endl;
                     }
+                    else if (poolLaunch)
+                    {
+                        std::cout << "not reporting the launch of warm pool instance " << callsign << std::endl;
+                    }
                     else
                     {
                         onLaunched(callsign, launchTypeString);
@@ -3371,14 +3555,11 @@ namespace WPEFramework {
             if (!result) 
             {
                 response["message"] = "failed to launch application";
+                mWarmPool.released(appCallsign);
             }
-            gLaunchMutex.lock();
-            gLaunchCount = 0;
-            gLaunchMutex.unlock();
 	    gLaunchDestroyMutex.lock();
             gLaunchApplications.erase(appCallsign);
 	    gLaunchDestroyMutex.unlock();
-            std::cout << "new launch count at loc2 is 0\n";
 
             returnResponse(result);
         }
@@ -3605,9 +3786,9 @@ namespace WPEFramework {
                 }
                 else if (mimeType == RDKSHELL_APPLICATION_MIME_TYPE_NATIVE)
                 {
-                    gRdkShellMutex.lock();
-                    result = CompositorController::launchApplication(client, uri, mimeType);
-                    gRdkShellMutex.unlock();
+                    runOnRenderThread([&]() {
+                        result = CompositorController::launchApplication(client, uri, mimeType);
+                    });
 
                     if (!result)
                     {
@@ -3645,9 +3826,9 @@ namespace WPEFramework {
 
                 if (mimeType == RDKSHELL_APPLICATION_MIME_TYPE_NATIVE)
                 {
-                    lockRdkShellMutex();
-                    result = CompositorController::suspendApplication(client);
-                    gRdkShellMutex.unlock();
+                    runOnRenderThread([&]() {
+                        result = CompositorController::suspendApplication(client);
+                    });
                 }
                 else if (mimeType == RDKSHELL_APPLICATION_MIME_TYPE_DAC_NATIVE)
                 {
@@ -3712,9 +3893,9 @@ namespace WPEFramework {
 
                 if (mimeType == RDKSHELL_APPLICATION_MIME_TYPE_NATIVE)
                 {
-                    lockRdkShellMutex();
-                    result = CompositorController::resumeApplication(client);
-                    gRdkShellMutex.unlock();
+                    runOnRenderThread([&]() {
+                        result = CompositorController::resumeApplication(client);
+                    });
                 }
                 else if (mimeType == RDKSHELL_APPLICATION_MIME_TYPE_DAC_NATIVE)
                 {
@@ -3868,9 +4049,9 @@ namespace WPEFramework {
             LOGINFOMETHOD();
             bool result = true;
 
-            lockRdkShellMutex();
-            result = CompositorController::hideFullScreenImage();
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                result = CompositorController::hideFullScreenImage();
+            });
 
             returnResponse(result);
         }
@@ -4721,9 +4902,240 @@ namespace WPEFramework {
         {
             LOGINFOMETHOD();
             bool result = true;
-            lockRdkShellMutex();
-            needsScreenshot = true;
-            gRdkShellMutex.unlock();
+            uint8_t format = ScreenshotEncoder::FORMAT_RAW;
+            if (parameters.HasLabel("format"))
+            {
+                const string requestedFormat = parameters["format"].String();
+                if (requestedFormat.compare("png") == 0)
+                {
+                    format = ScreenshotEncoder::FORMAT_PNG;
+                }
+                else if (requestedFormat.compare("shm") == 0)
+                {
+                    format = ScreenshotEncoder::FORMAT_SHM;
+                }
+                else if (requestedFormat.compare("raw") != 0)
+                {
+                    result = false;
+                    response["message"] = "unsupported format, please specify raw, png or shm";
+                }
+            }
+            if (result)
+            {
+                runOnRenderThread([&]() {
+                    sPendingScreenshotFormats |= format;
+                });
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::getFrameStatsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            // the same statistics as getPerformanceStats, without the histograms
+            PerformanceStats::CompositorSummary compositor;
+            std::map<std::string, PerformanceStats::ClientSummary> clients;
+            gPerformanceStats.get(compositor, clients, parameters.HasLabel("reset") && parameters["reset"].Boolean());
+            const PerformanceStats::Summary* timings[] = { &compositor.mDrawTime, &compositor.mUpdateTime, &compositor.mFrameTime };
+            const char* timingNames[] = { "drawTime", "updateTime", "frameTime" };
+            response["framerate"] = gCurrentFramerate;
+            response["idleFrameSkip"] = gFrameScheduler.enabled();
+            response["framesDrawn"] = compositor.mFramesDrawn;
+            response["framesSkipped"] = compositor.mFramesSkipped;
+            for (int i = 0; i < 3; i++)
+            {
+                JsonObject timing;
+                timing["last"] = timings[i]->mLast;
+                timing["average"] = timings[i]->mAverage;
+                timing["max"] = timings[i]->mMax;
+                response[timingNames[i]] = timing;
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::setWarmPoolWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            if (!parameters.HasLabel("entries"))
+            {
+                result = false;
+                response["message"] = "please specify entries";
+            }
+            if (result)
+            {
+                result = configureWarmPool(parameters);
+                if (!result)
+                {
+                    response["message"] = "every entry needs a callsign and a type";
+                }
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::getPerformanceStatsWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            // client frame rates are only sampled for a while after the stats were asked for
+            mPerformanceStatsRequestedLeft = RDKSHELL_PERFORMANCE_STATS_REQUEST_SAMPLE_TIME_IN_MS;
+            getPerformanceStats(response, parameters.HasLabel("reset") && parameters["reset"].Boolean());
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::setPerformanceStatsIntervalWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            if (!parameters.HasLabel("interval"))
+            {
+                result = false;
+                response["message"] = "please specify interval parameter";
+            }
+            if (result)
+            {
+                // the timer counts the interval in milliseconds, it has to fit once converted
+                const int64_t interval = parameters["interval"].Number();
+                if ((interval < 0) || (interval > (std::numeric_limits<uint32_t>::max() / 1000)))
+                {
+                    result = false;
+                    response["message"] = "invalid interval parameter";
+                }
+                else
+                {
+                    mPerformanceStatsElapsed = 0;
+                    mPerformanceStatsInterval = static_cast<uint32_t>(interval);
+                }
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::batchWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            // compositor operations, their calls out to other plugins are made once the batch has been applied
+            typedef uint32_t (RDKShell::*BatchOperation)(const JsonObject& parameters, JsonObject& response);
+            static const std::map<std::string, BatchOperation> batchOperations = {
+                { RDKSHELL_METHOD_SET_BOUNDS, &RDKShell::setBoundsWrapper },
+                { RDKSHELL_METHOD_SET_OPACITY, &RDKShell::setOpacityWrapper },
+                { RDKSHELL_METHOD_SET_VISIBILITY, &RDKShell::setVisibilityWrapper },
+                { RDKSHELL_METHOD_SET_SCALE, &RDKShell::setScaleWrapper },
+                { RDKSHELL_METHOD_SET_HOLE_PUNCH, &RDKShell::setHolePunchWrapper },
+                { RDKSHELL_METHOD_SET_TOPMOST, &RDKShell::setTopmostWrapper },
+                { RDKSHELL_METHOD_SET_FOCUS, &RDKShell::setFocusWrapper },
+                { RDKSHELL_METHOD_MOVE_TO_FRONT, &RDKShell::moveToFrontWrapper },
+                { RDKSHELL_METHOD_MOVE_TO_BACK, &RDKShell::moveToBackWrapper },
+                { RDKSHELL_METHOD_MOVE_BEHIND, &RDKShell::moveBehindWrapper },
+                { RDKSHELL_METHOD_ADD_ANIMATION, &RDKShell::addAnimationWrapper },
+                { RDKSHELL_METHOD_REMOVE_ANIMATION, &RDKShell::removeAnimationWrapper }
+            };
+
+            bool result = true;
+            if (!parameters.HasLabel("operations"))
+            {
+                result = false;
+                response["message"] = "please specify operations";
+            }
+            if (result)
+            {
+                const JsonArray operations = parameters["operations"].Array();
+                for (int i=0; i<operations.Length(); i++)
+                {
+                    const JsonObject& operation = operations[i].Object();
+                    if (!operation.HasLabel("method") || (batchOperations.find(operation["method"].String()) == batchOperations.end()))
+                    {
+                        result = false;
+                        response["message"] = "unsupported method in operation " + std::to_string(i);
+                        break;
+                    }
+                }
+            }
+            if (result)
+            {
+                // one render thread command, no frame is drawn with only part of the operations applied
+                const JsonArray operations = parameters["operations"].Array();
+                JsonArray results;
+                std::vector<std::function<void()>> pluginCalls;
+                runOnRenderThread([&]() {
+                    BatchPluginCallsScope batchScope(pluginCalls);
+                    for (int i=0; i<operations.Length(); i++)
+                    {
+                        const JsonObject& operation = operations[i].Object();
+                        const JsonObject operationParameters = operation.HasLabel("params") ? operation["params"].Object() : JsonObject();
+                        JsonObject operationResponse;
+                        (this->*(batchOperations.at(operation["method"].String())))(operationParameters, operationResponse);
+                        operationResponse["method"] = operation["method"].String();
+                        results.Add(operationResponse);
+                    }
+                });
+                for (size_t i = 0; i < pluginCalls.size(); i++)
+                {
+                    pluginCalls[i]();
+                }
+                response["results"] = results;
+            }
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::getMemoryPolicyWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            MemoryPolicy::Config config;
+            MemoryPolicy::Sample sample;
+            uint32_t suspended = 0, destroyed = 0;
+            mMemoryPolicy.getInfo(config, sample, suspended, destroyed);
+            response["enabled"] = config.mEnabled;
+            response["interval"] = config.mIntervalMs;
+            response["suspendPressure"] = config.mSuspendPressure;
+            response["destroyPressure"] = config.mDestroyPressure;
+            response["suspendFreeRam"] = config.mSuspendFreeKb;
+            response["destroyFreeRam"] = config.mDestroyFreeKb;
+            response["minIdleTime"] = config.mMinIdleSeconds;
+            response["cooldown"] = config.mCooldownSeconds;
+            JsonArray protectedApps;
+            for (size_t i = 0; i < config.mProtected.size(); i++)
+            {
+                protectedApps.Add(config.mProtected[i]);
+            }
+            response["protected"] = protectedApps;
+            if (sample.mHasPressure)
+            {
+                response["someAvg10"] = static_cast<uint32_t>(sample.mSomeAvg10 + 0.5);
+                response["fullAvg10"] = static_cast<uint32_t>(sample.mFullAvg10 + 0.5);
+            }
+            if (sample.mHasAvailable)
+            {
+                response["availableRam"] = sample.mAvailableKb;
+            }
+            response["suspended"] = suspended;
+            response["destroyed"] = destroyed;
+            returnResponse(result);
+        }
+
+        uint32_t RDKShell::getWarmPoolWrapper(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+            bool result = true;
+            std::vector<WarmPool::SlotInfo> slots;
+            uint32_t memoryBudget = 0, warmLaunches = 0, coldLaunches = 0;
+            mWarmPool.getInfo(slots, memoryBudget, warmLaunches, coldLaunches);
+            JsonArray entries;
+            for (size_t i = 0; i < slots.size(); i++)
+            {
+                JsonObject entry;
+                entry["callsign"] = slots[i].mEntry.mCallsign;
+                entry["type"] = slots[i].mEntry.mType;
+                entry["uri"] = slots[i].mEntry.mUri;
+                entry["state"] = WarmPool::stateName(slots[i].mState);
+                entry["residentKb"] = slots[i].mResidentKb;
+                entries.Add(entry);
+            }
+            response["entries"] = entries;
+            response["memoryBudget"] = memoryBudget;
+            response["warmLaunches"] = warmLaunches;
+            response["coldLaunches"] = coldLaunches;
             returnResponse(result);
         }
         // Registered methods end
@@ -4874,60 +5286,60 @@ namespace WPEFramework {
         bool RDKShell::moveToFront(const string& client)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::moveToFront(client);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::moveToFront(client);
+            });
             return ret;
         }
 
         bool RDKShell::moveToBack(const string& client)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::moveToBack(client);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::moveToBack(client);
+            });
             return ret;
         }
 
         bool RDKShell::moveBehind(const string& client, const string& target)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            std::vector<std::string> clientList;
-            CompositorController::getClients(clientList);
-            bool targetFound = false;
-            for (size_t i=0; i<clientList.size(); i++)
-            {
-                if (strcasecmp(clientList[i].c_str(),target.c_str()) == 0)
+            runOnRenderThread([&]() {
+                std::vector<std::string> clientList;
+                CompositorController::getClients(clientList);
+                bool targetFound = false;
+                for (size_t i=0; i<clientList.size(); i++)
                 {
-                    targetFound = true;
-                    break;
+                    if (strcasecmp(clientList[i].c_str(),target.c_str()) == 0)
+                    {
+                        targetFound = true;
+                        break;
+                    }
                 }
-            }
-            if (targetFound)
-            {
-                ret = CompositorController::moveBehind(client, target);
-            }
-            gRdkShellMutex.unlock();
+                if (targetFound)
+                {
+                    ret = CompositorController::moveBehind(client, target);
+                }
+            });
             return ret;
         }
 
         bool RDKShell::setFocus(const string& client)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::setFocus(client);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::setFocus(client);
+            });
             return ret;
         }
 
         bool RDKShell::kill(const string& client)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            RdkShell::CompositorController::removeListener(client, mEventListener);
-            ret = CompositorController::kill(client);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                RdkShell::CompositorController::removeListener(client, mEventListener);
+                ret = CompositorController::kill(client);
+            });
             return ret;
         }
 
@@ -4938,9 +5350,9 @@ namespace WPEFramework {
               flags |= getKeyFlag(modifiers[i].String());
             }
             bool ret = false;
-            gRdkShellMutex.lock();
-            ret = CompositorController::addKeyIntercept(client, keyCode, flags);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::addKeyIntercept(client, keyCode, flags);
+            });
             return ret;
         }
 
@@ -4951,164 +5363,160 @@ namespace WPEFramework {
               flags |= getKeyFlag(modifiers[i].String());
             }
             bool ret = false;
-            gRdkShellMutex.lock();
-            ret = CompositorController::removeKeyIntercept(client, keyCode, flags);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::removeKeyIntercept(client, keyCode, flags);
+            });
             return ret;
         }
 
         bool RDKShell::addKeyListeners(const string& client, const JsonArray& keys)
         {
-            gRdkShellMutex.lock();
-
             bool result = true;
+            runOnRenderThread([&]() {
+                for (int i=0; i<keys.Length(); i++) {
 
-            for (int i=0; i<keys.Length(); i++) {
-
-                result = false;
-                const JsonObject& keyInfo = keys[i].Object();
-
-                if (keyInfo.HasLabel("keyCode") && keyInfo.HasLabel("nativeKeyCode"))
-                {
-                    std::cout << "ERROR: keyCode and nativeKeyCode can't be set both at the same time" << std::endl;
-                }
-                else if (keyInfo.HasLabel("keyCode") || keyInfo.HasLabel("nativeKeyCode"))
-                {
-                    uint32_t keyCode = 0;
+                    result = false;
+                    const JsonObject& keyInfo = keys[i].Object();
 
-                    if (keyInfo.HasLabel("keyCode"))
+                    if (keyInfo.HasLabel("keyCode") && keyInfo.HasLabel("nativeKeyCode"))
+                    {
+                        std::cout << "ERROR: keyCode and nativeKeyCode can't be set both at the same time" << std::endl;
+                    }
+                    else if (keyInfo.HasLabel("keyCode") || keyInfo.HasLabel("nativeKeyCode"))
                     {
-                        std::string keystring = keyInfo["keyCode"].String();
-                        if (keystring.compare("*") == 0)
+                        uint32_t keyCode = 0;
+
+                        if (keyInfo.HasLabel("keyCode"))
                         {
-                          keyCode = ANY_KEY;
+                            std::string keystring = keyInfo["keyCode"].String();
+                            if (keystring.compare("*") == 0)
+                            {
+                              keyCode = ANY_KEY;
+                            }
+                            else
+                            {
+                              keyCode = keyInfo["keyCode"].Number();
+                            }
                         }
                         else
                         {
-                          keyCode = keyInfo["keyCode"].Number();
+                            std::string keystring = keyInfo["nativeKeyCode"].String();
+                            if (keystring.compare("*") == 0)
+                            {
+                                keyCode = ANY_KEY;
+                            }
+                            else
+                            {
+                                keyCode = keyInfo["nativeKeyCode"].Number();
+                            }
+                        }
+                        const JsonArray modifiers = keyInfo.HasLabel("modifiers") ? keyInfo["modifiers"].Array() : JsonArray();
+                        uint32_t flags = 0;
+                        for (int i=0; i<modifiers.Length(); i++) {
+                          flags |= getKeyFlag(modifiers[i].String());
+                        }
+                        std::map<std::string, RdkShellData> properties;
+                        if (keyInfo.HasLabel("activate"))
+                        {
+                            bool activate = keyInfo["activate"].Boolean();
+                            properties["activate"] = activate;
                         }
-                    }
-                    else
-                    {
-                        std::string keystring = keyInfo["nativeKeyCode"].String();
-                        if (keystring.compare("*") == 0)
+                        if (keyInfo.HasLabel("propagate"))
+                        {
+                            bool propagate = keyInfo["propagate"].Boolean();
+                            properties["propagate"] = propagate;
+                        }
+
+                        if (keyInfo.HasLabel("keyCode"))
                         {
-                            keyCode = ANY_KEY;
+                            result = CompositorController::addKeyListener(client, keyCode, flags, properties);
                         }
                         else
                         {
-                            keyCode = keyInfo["nativeKeyCode"].Number();
+                            result = CompositorController::addNativeKeyListener(client, keyCode, flags, properties);
                         }
                     }
-                    const JsonArray modifiers = keyInfo.HasLabel("modifiers") ? keyInfo["modifiers"].Array() : JsonArray();
-                    uint32_t flags = 0;
-                    for (int i=0; i<modifiers.Length(); i++) {
-                      flags |= getKeyFlag(modifiers[i].String());
-                    }
-                    std::map<std::string, RdkShellData> properties;
-                    if (keyInfo.HasLabel("activate"))
-                    {
-                        bool activate = keyInfo["activate"].Boolean();
-                        properties["activate"] = activate;
-                    }
-                    if (keyInfo.HasLabel("propagate"))
+                    else
                     {
-                        bool propagate = keyInfo["propagate"].Boolean();
-                        properties["propagate"] = propagate;
+                        std::cout << "ERROR: Neither keyCode nor nativeKeyCode provided" << std::endl;
                     }
 
-                    if (keyInfo.HasLabel("keyCode"))
-                    {
-                        result = CompositorController::addKeyListener(client, keyCode, flags, properties);
-                    }
-                    else
+                    if (result == false)
                     {
-                        result = CompositorController::addNativeKeyListener(client, keyCode, flags, properties);
+                        break;
                     }
                 }
-                else
-                {
-                    std::cout << "ERROR: Neither keyCode nor nativeKeyCode provided" << std::endl;
-                }
-
-                if (result == false)
-                {
-                    break;
-                }
-            }
-            gRdkShellMutex.unlock();
+            });
             return result;
         }
 
         bool RDKShell::removeKeyListeners(const string& client, const JsonArray& keys)
         {
-            gRdkShellMutex.lock();
-
             bool result = true;
+            runOnRenderThread([&]() {
+                for (int i=0; i<keys.Length(); i++) {
 
-            for (int i=0; i<keys.Length(); i++) {
-
-                result = false;
-                const JsonObject& keyInfo = keys[i].Object();
+                    result = false;
+                    const JsonObject& keyInfo = keys[i].Object();
 
-                if (keyInfo.HasLabel("keyCode") && keyInfo.HasLabel("nativeKeyCode"))
-                {
-                    std::cout << "ERROR: keyCode and nativeKeyCode can't be set both at the same time" << std::endl;
-                }
-                else if (keyInfo.HasLabel("keyCode") || keyInfo.HasLabel("nativeKeyCode"))
-                {
-                    uint32_t keyCode = 0;
-                    if (keyInfo.HasLabel("keyCode"))
+                    if (keyInfo.HasLabel("keyCode") && keyInfo.HasLabel("nativeKeyCode"))
+                    {
+                        std::cout << "ERROR: keyCode and nativeKeyCode can't be set both at the same time" << std::endl;
+                    }
+                    else if (keyInfo.HasLabel("keyCode") || keyInfo.HasLabel("nativeKeyCode"))
                     {
-                        std::string keystring = keyInfo["keyCode"].String();
-                        if (keystring.compare("*") == 0)
+                        uint32_t keyCode = 0;
+                        if (keyInfo.HasLabel("keyCode"))
                         {
-                          keyCode = ANY_KEY;
+                            std::string keystring = keyInfo["keyCode"].String();
+                            if (keystring.compare("*") == 0)
+                            {
+                              keyCode = ANY_KEY;
+                            }
+                            else
+                            {
+                              keyCode = keyInfo["keyCode"].Number();
+                            }
                         }
                         else
                         {
-                          keyCode = keyInfo["keyCode"].Number();
+                            std::string keystring = keyInfo["nativeKeyCode"].String();
+                            if (keystring.compare("*") == 0)
+                            {
+                              keyCode = ANY_KEY;
+                            }
+                            else
+                            {
+                              keyCode = keyInfo["nativeKeyCode"].Number();
+                            }
                         }
-                    }
-                    else
-                    {
-                        std::string keystring = keyInfo["nativeKeyCode"].String();
-                        if (keystring.compare("*") == 0)
+
+                        const JsonArray modifiers = keyInfo.HasLabel("modifiers") ? keyInfo["modifiers"].Array() : JsonArray();
+                        uint32_t flags = 0;
+                        for (int i=0; i<modifiers.Length(); i++) {
+                          flags |= getKeyFlag(modifiers[i].String());
+                        }
+
+                        if (keyInfo.HasLabel("keyCode"))
                         {
-                          keyCode = ANY_KEY;
+                            result = CompositorController::removeKeyListener(client, keyCode, flags);
                         }
                         else
                         {
-                          keyCode = keyInfo["nativeKeyCode"].Number();
+                            result = CompositorController::removeNativeKeyListener(client, keyCode, flags);
                         }
                     }
-
-                    const JsonArray modifiers = keyInfo.HasLabel("modifiers") ? keyInfo["modifiers"].Array() : JsonArray();
-                    uint32_t flags = 0;
-                    for (int i=0; i<modifiers.Length(); i++) {
-                      flags |= getKeyFlag(modifiers[i].String());
-                    }
-
-                    if (keyInfo.HasLabel("keyCode"))
-                    {
-                        result = CompositorController::removeKeyListener(client, keyCode, flags);
-                    }
                     else
                     {
-                        result = CompositorController::removeNativeKeyListener(client, keyCode, flags);
+                        std::cout << "ERROR: Neither keyCode nor nativeKeyCode provided" << std::endl;
                     }
-                }
-                else
-                {
-                    std::cout << "ERROR: Neither keyCode nor nativeKeyCode provided" << std::endl;
-                }
 
-                if (result == false)
-                {
-                    break;
+                    if (result == false)
+                    {
+                        break;
+                    }
                 }
-            }
-            gRdkShellMutex.unlock();
+            });
             return result;
         }
 
@@ -5119,9 +5527,10 @@ namespace WPEFramework {
             for (int i=0; i<modifiers.Length(); i++) {
               flags |= getKeyFlag(modifiers[i].String());
             }
-            gRdkShellMutex.lock();
-            ret = CompositorController::injectKey(keyCode, flags);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::injectKey(keyCode, flags);
+                gPerformanceStats.keySent("", RdkShell::microseconds());
+            });
             return ret;
         }
 
@@ -5145,9 +5554,10 @@ namespace WPEFramework {
                   for (int k=0; k<modifiers.Length(); k++) {
                     flags |= getKeyFlag(modifiers[k].String());
                   }
-                  gRdkShellMutex.lock();
-                  ret = CompositorController::generateKey(keyClient, keyCode, flags);
-                  gRdkShellMutex.unlock();
+                  runOnRenderThread([&]() {
+                      ret = CompositorController::generateKey(keyClient, keyCode, flags);
+                      gPerformanceStats.keySent(keyClient, RdkShell::microseconds());
+                  });
                 }
             }
             return ret;
@@ -5157,9 +5567,9 @@ namespace WPEFramework {
         {
             unsigned int width=0,height=0;
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getScreenResolution(width, height);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::getScreenResolution(width, height);
+            });
             if (true == ret) {
               out["w"] = width;
               out["h"] = height;
@@ -5170,29 +5580,29 @@ namespace WPEFramework {
 
         bool RDKShell::setScreenResolution(const unsigned int w, const unsigned int h)
         {
-            lockRdkShellMutex();
-            receivedResolutionRequest = true;
-            resolutionWidth = w;
-            resolutionHeight = h;
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                receivedResolutionRequest = true;
+                resolutionWidth = w;
+                resolutionHeight = h;
+            });
             return true;
         }
 
         bool RDKShell::setMimeType(const string& client, const string& mimeType)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::setMimeType(client, mimeType);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::setMimeType(client, mimeType);
+            });
             return ret;
         }
 
         bool RDKShell::getMimeType(const string& client, string& mimeType)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getMimeType(client, mimeType);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::getMimeType(client, mimeType);
+            });
             return ret;
         }
 
@@ -5200,20 +5610,20 @@ namespace WPEFramework {
             const bool virtualDisplay, const uint32_t virtualWidth, const uint32_t virtualHeight)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::createDisplay(client, displayName, displayWidth, displayHeight,
-                virtualDisplay, virtualWidth, virtualHeight);
-            RdkShell::CompositorController::addListener(client, mEventListener);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::createDisplay(client, displayName, displayWidth, displayHeight,
+                    virtualDisplay, virtualWidth, virtualHeight);
+                RdkShell::CompositorController::addListener(client, mEventListener);
+            });
             return ret;
         }
 
         bool RDKShell::getClients(JsonArray& clients)
         {
             std::vector<std::string> clientList;
-            lockRdkShellMutex();
-            CompositorController::getClients(clientList);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                CompositorController::getClients(clientList);
+            });
             for (size_t i=0; i<clientList.size(); i++) {
               clients.Add(clientList[i]);
             }
@@ -5223,9 +5633,9 @@ namespace WPEFramework {
         bool RDKShell::getZOrder(JsonArray& clients)
         {
             std::vector<std::string> zOrderList;
-            lockRdkShellMutex();
-            CompositorController::getZOrder(zOrderList);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                CompositorController::getZOrder(zOrderList);
+            });
             for (size_t i=0; i<zOrderList.size(); i++) {
               clients.Add(zOrderList[i]);
             }
@@ -5236,9 +5646,9 @@ namespace WPEFramework {
         {
             unsigned int x=0,y=0,width=0,height=0;
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getBounds(client, x, y, width, height);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::getBounds(client, x, y, width, height);
+            });
             if (true == ret) {
               bounds["x"] = x;
               bounds["y"] = y;
@@ -5252,49 +5662,44 @@ namespace WPEFramework {
         bool RDKShell::setBounds(const std::string& client, const unsigned int x, const unsigned int y, const unsigned int w, const unsigned int h)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            std::cout << "setting the bounds\n";
-            ret = CompositorController::setBounds(client, 0, 0, 1, 1); //forcing a compositor resize flush
-            ret = CompositorController::setBounds(client, x, y, w, h);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                std::cout << "setting the bounds\n";
+                ret = CompositorController::setBounds(client, 0, 0, 1, 1); //forcing a compositor resize flush
+                ret = CompositorController::setBounds(client, x, y, w, h);
+            });
             std::cout << "bounds set\n";
-            usleep(68000);
-            std::cout << "all set\n";
+            runOutsideBatch([]() {
+                usleep(68000);
+                std::cout << "all set\n";
+            });
             return ret;
         }
 
         bool RDKShell::getVisibility(const string& client, bool& visible)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getVisibility(client, visible);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::getVisibility(client, visible);
+            });
             return ret;
         }
 
         bool RDKShell::setVisibility(const string& client, const bool visible)
         {
             bool ret = false;
-            {
-                bool lockAcquired = false;
-                double startTime = RdkShell::milliseconds();
-                while (!lockAcquired && (RdkShell::milliseconds() - startTime) < RDKSHELL_TRY_LOCK_WAIT_TIME_IN_MS)
-                {
-                    lockAcquired = gRdkShellMutex.try_lock();
-                }
-                if (!lockAcquired)
-                {
-                    std::cout << "unable to get lock for visibility, defaulting to normal lock\n";
-                    gRdkShellMutex.lock();
-                }
-                else
-                {
-                    std::cout << "lock was acquired via try for visibility\n";
-                }
-            }
-            ret = CompositorController::setVisibility(client, visible);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::setVisibility(client, visible);
+            });
+
+            runOutsideBatch([this, client, visible]() {
+                setBrowserVisibility(client, visible);
+            });
+
+            return ret;
+        }
 
+        void RDKShell::setBrowserVisibility(const string& client, const bool visible)
+        {
             std::map<std::string, PluginData> activePluginsData;
             gPluginDataMutex.lock();
             activePluginsData = gActivePluginsData;
@@ -5323,178 +5728,408 @@ namespace WPEFramework {
                     }
                 }
             }
-
-            return ret;
         }
 
         bool RDKShell::getOpacity(const string& client, unsigned int& opacity)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getOpacity(client, opacity);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::getOpacity(client, opacity);
+            });
             return ret;
         }
 
         bool RDKShell::setOpacity(const string& client, const unsigned int opacity)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::setOpacity(client, opacity);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::setOpacity(client, opacity);
+            });
             return ret;
         }
 
         bool RDKShell::getScale(const string& client, double& scaleX, double& scaleY)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getScale(client, scaleX, scaleY);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::getScale(client, scaleX, scaleY);
+            });
             return ret;
         }
 
         bool RDKShell::setScale(const string& client, const double scaleX, const double scaleY)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::setScale(client, scaleX, scaleY);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::setScale(client, scaleX, scaleY);
+            });
             return ret;
         }
 
         bool RDKShell::getHolePunch(const string& client, bool& holePunch)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getHolePunch(client, holePunch);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::getHolePunch(client, holePunch);
+            });
             return ret;
         }
 
         bool RDKShell::setHolePunch(const string& client, const bool holePunch)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::setHolePunch(client, holePunch);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::setHolePunch(client, holePunch);
+            });
             return ret;
         }
 
         bool RDKShell::removeAnimation(const string& client)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::removeAnimation(client);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::removeAnimation(client);
+            });
             return ret;
         }
 
         bool RDKShell::addAnimationList(const JsonArray& animations)
         {
-            lockRdkShellMutex();
-            for (int i=0; i<animations.Length(); i++) {
-                const JsonObject& animationInfo = animations[i].Object();
-                if (animationInfo.HasLabel("client") && animationInfo.HasLabel("duration"))
-                {
-                    const string client  = animationInfo["client"].String();
-                    const double duration = std::stod(animationInfo["duration"].String());
-                    std::map<std::string, RdkShellData> animationProperties;
-                    if (animationInfo.HasLabel("x"))
-                    {
-                        int32_t x = animationInfo["x"].Number();
-                        animationProperties["x"] = x;
-                    }
-                    if (animationInfo.HasLabel("y"))
-                    {
-                        int32_t y = animationInfo["y"].Number();
-                        animationProperties["y"] = y;
-                    }
-                    if (animationInfo.HasLabel("w"))
+            runOnRenderThread([&]() {
+                for (int i=0; i<animations.Length(); i++) {
+                    const JsonObject& animationInfo = animations[i].Object();
+                    if (animationInfo.HasLabel("client") && animationInfo.HasLabel("duration"))
                     {
-                        uint32_t width = animationInfo["w"].Number();
-                        animationProperties["w"] = width;
-                    }
-                    if (animationInfo.HasLabel("h"))
-                    {
-                        uint32_t height = animationInfo["h"].Number();
-                        animationProperties["h"] = height;
-                    }
-                    if (animationInfo.HasLabel("sx"))
-                    {
-                        double scaleX = std::stod(animationInfo["sx"].String());
-                        animationProperties["sx"] = scaleX;
-                    }
-                    if (animationInfo.HasLabel("sy"))
-                    {
-                        double scaleY = std::stod(animationInfo["sy"].String());
-                        animationProperties["sy"] = scaleY;
-                    }
-                    if (animationInfo.HasLabel("a"))
-                    {
-                        uint32_t opacity = animationInfo["a"].Number();
-                        animationProperties["a"] = opacity;
-                    }
-                    if (animationInfo.HasLabel("tween"))
-                    {
-                        std::string tween = animationInfo["tween"].String();
-                        animationProperties["tween"] = tween;
-                    }
-                    if (animationInfo.HasLabel("delay"))
-                    {
-                        try
+                        const string client  = animationInfo["client"].String();
+                        const double duration = std::stod(animationInfo["duration"].String());
+                        std::map<std::string, RdkShellData> animationProperties;
+                        double delay = 0;
+                        if (animationInfo.HasLabel("x"))
+                        {
+                            int32_t x = animationInfo["x"].Number();
+                            animationProperties["x"] = x;
+                        }
+                        if (animationInfo.HasLabel("y"))
+                        {
+                            int32_t y = animationInfo["y"].Number();
+                            animationProperties["y"] = y;
+                        }
+                        if (animationInfo.HasLabel("w"))
+                        {
+                            uint32_t width = animationInfo["w"].Number();
+                            animationProperties["w"] = width;
+                        }
+                        if (animationInfo.HasLabel("h"))
+                        {
+                            uint32_t height = animationInfo["h"].Number();
+                            animationProperties["h"] = height;
+                        }
+                        if (animationInfo.HasLabel("sx"))
+                        {
+                            double scaleX = std::stod(animationInfo["sx"].String());
+                            animationProperties["sx"] = scaleX;
+                        }
+                        if (animationInfo.HasLabel("sy"))
                         {
-                          double duration = std::stod(animationInfo["delay"].String());
-                          animationProperties["delay"] = duration;
+                            double scaleY = std::stod(animationInfo["sy"].String());
+                            animationProperties["sy"] = scaleY;
                         }
-                        catch (...)
+                        if (animationInfo.HasLabel("a"))
                         {
-                          std::cout << "RDKShell unable to set delay for animation  " << std::endl;
+                            uint32_t opacity = animationInfo["a"].Number();
+                            animationProperties["a"] = opacity;
+                        }
+                        if (animationInfo.HasLabel("tween"))
+                        {
+                            std::string tween = animationInfo["tween"].String();
+                            animationProperties["tween"] = tween;
+                        }
+                        if (animationInfo.HasLabel("delay"))
+                        {
+                            try
+                            {
+                              delay = std::stod(animationInfo["delay"].String());
+                              animationProperties["delay"] = delay;
+                            }
+                            catch (...)
+                            {
+                              std::cout << "RDKShell unable to set delay for animation  " << std::endl;
+                            }
                         }
+                        CompositorController::addAnimation(client, duration, animationProperties);
+                        gFrameScheduler.animateUntil(RdkShell::seconds() + delay + duration);
                     }
-                    CompositorController::addAnimation(client, duration, animationProperties);
                 }
-            }
-            gRdkShellMutex.unlock();
+            });
             return true;
         }
 
         bool RDKShell::enableInactivityReporting(const bool enable)
         {
-            lockRdkShellMutex();
-            CompositorController::enableInactivityReporting(enable);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                CompositorController::enableInactivityReporting(enable);
+            });
             return true;
         }
 
         bool RDKShell::setInactivityInterval(const uint32_t interval)
         {
-            lockRdkShellMutex();
-            try
+            runOnRenderThread([&]() {
+                try
+                {
+                  CompositorController::setInactivityInterval((double)interval);
+                }
+                catch (...) 
+                {
+                  std::cout << "RDKShell unable to set inactivity interval  " << std::endl;
+                }
+            });
+            return true;
+        }
+
+        bool RDKShell::resetInactivityTime()
+        {
+            runOnRenderThread([&]() {
+                try
+                {
+                  CompositorController::resetInactivityTime();
+                  std::cout << "RDKShell inactivity time reset" << std::endl;
+                }
+                catch (...)
+                {
+                  std::cout << "RDKShell unable to reset inactivity time  " << std::endl;
+                }
+            });
+            return true;
+        }
+
+        void RDKShell::startMemoryPolicy(const string& configLine)
+        {
+            MemoryPolicy::Config config;
+            const JsonObject pluginConfig(configLine.c_str());
+            if (pluginConfig.HasLabel("memorypolicy"))
+            {
+                const JsonObject policyConfig = pluginConfig["memorypolicy"].Object();
+                config.mEnabled = policyConfig.HasLabel("enabled") ? policyConfig["enabled"].Boolean() : config.mEnabled;
+                config.mIntervalMs = policyConfig.HasLabel("interval") ? policyConfig["interval"].Number() : config.mIntervalMs;
+                config.mSuspendPressure = policyConfig.HasLabel("suspendpressure") ? policyConfig["suspendpressure"].Number() : config.mSuspendPressure;
+                config.mDestroyPressure = policyConfig.HasLabel("destroypressure") ? policyConfig["destroypressure"].Number() : config.mDestroyPressure;
+                config.mSuspendFreeKb = policyConfig.HasLabel("suspendfreeram") ? policyConfig["suspendfreeram"].Number() : config.mSuspendFreeKb;
+                config.mDestroyFreeKb = policyConfig.HasLabel("destroyfreeram") ? policyConfig["destroyfreeram"].Number() : config.mDestroyFreeKb;
+                config.mMinIdleSeconds = policyConfig.HasLabel("minidletime") ? policyConfig["minidletime"].Number() : config.mMinIdleSeconds;
+                config.mCooldownSeconds = policyConfig.HasLabel("cooldown") ? policyConfig["cooldown"].Number() : config.mCooldownSeconds;
+                const JsonArray protectedApps = policyConfig.HasLabel("protected") ? policyConfig["protected"].Array() : JsonArray();
+                for (int i=0; i<protectedApps.Length(); i++)
+                {
+                    config.mProtected.push_back(protectedApps[i].String());
+                }
+            }
+            // the resident and factory apps own the screen, they are never reclaimed
+            config.mProtected.push_back(RESIDENTAPP_CALLSIGN);
+            config.mProtected.push_back("factoryapp");
+            std::cout << "memory policy " << (config.mEnabled ? "enabled" : "disabled") << std::endl;
+
+            mMemoryPolicy.start(config, [this](std::vector<MemoryPolicy::Client>& clients) {
+                std::vector<std::string> callsigns;
+                gPluginDataMutex.lock();
+                for (std::map<std::string, PluginData>::const_iterator it = gActivePluginsData.begin(); it != gActivePluginsData.end(); ++it)
+                {
+                    callsigns.push_back(it->first);
+                }
+                gPluginDataMutex.unlock();
+
+                std::vector<WarmPool::SlotInfo> slots;
+                uint32_t memoryBudget = 0, warmLaunches = 0, coldLaunches = 0;
+                mWarmPool.getInfo(slots, memoryBudget, warmLaunches, coldLaunches);
+                for (size_t i = 0; i < callsigns.size(); i++)
+                {
+                    bool busy = false;
+                    gLaunchDestroyMutex.lock();
+                    busy = ((gLaunchApplications.find(callsigns[i]) != gLaunchApplications.end()) || (gDestroyApplications.find(callsigns[i]) != gDestroyApplications.end()));
+                    gLaunchDestroyMutex.unlock();
+                    // the warm pool accounts for its own instances
+                    for (size_t j = 0; !busy && (j < slots.size()); j++)
+                    {
+                        busy = ((slots[j].mEntry.mCallsign == callsigns[i]) && ((slots[j].mState == WarmPool::WARMING) || (slots[j].mState == WarmPool::WARM)));
+                    }
+                    if (busy)
+                    {
+                        continue;
+                    }
+                    MemoryPolicy::Client client;
+                    client.mCallsign = callsigns[i];
+                    getVisibility(client.mCallsign, client.mVisible);
+                    clients.push_back(client);
+                }
+            }, [this](MemoryPolicy::Client& client) {
+                PluginHost::IStateControl* stateControl(mCurrentService->QueryInterfaceByCallsign<PluginHost::IStateControl>(client.mCallsign));
+                if (nullptr != stateControl)
+                {
+                    client.mSuspended = (stateControl->State() == PluginHost::IStateControl::SUSPENDED);
+                    stateControl->Release();
+                }
+                Exchange::IMemory* pluginMemoryInterface(mCurrentService->QueryInterfaceByCallsign<Exchange::IMemory>(client.mCallsign.c_str()));
+                if (nullptr != pluginMemoryInterface)
+                {
+                    client.mResidentKb = pluginMemoryInterface->Resident()/1024;
+                    pluginMemoryInterface->Release();
+                }
+            }, [this](const MemoryPolicy::Client& client, const MemoryPolicy::Action action, const std::string& reason, const MemoryPolicy::Sample& sample) {
+                JsonObject request, response;
+                request["callsign"] = client.mCallsign;
+                if (action == MemoryPolicy::DESTROY)
+                {
+                    destroyWrapper(request, response);
+                }
+                else
+                {
+                    suspendWrapper(request, response);
+                }
+                const bool reclaimed = (response.HasLabel("success") && response["success"].Boolean());
+                if (reclaimed)
+                {
+                    JsonObject params;
+                    params["client"] = client.mCallsign;
+                    params["action"] = MemoryPolicy::actionName(action);
+                    params["reason"] = reason;
+                    params["ram"] = client.mResidentKb;
+                    if (sample.mHasPressure)
+                    {
+                        params["someAvg10"] = static_cast<uint32_t>(sample.mSomeAvg10 + 0.5);
+                        params["fullAvg10"] = static_cast<uint32_t>(sample.mFullAvg10 + 0.5);
+                    }
+                    if (sample.mHasAvailable)
+                    {
+                        params["availableRam"] = sample.mAvailableKb;
+                    }
+                    notify(RDKSHELL_EVENT_ON_APPLICATION_RECLAIMED, params);
+                }
+                return reclaimed;
+            });
+        }
+
+        void RDKShell::getPerformanceStats(JsonObject& stats, const bool reset)
+        {
+            std::function<JsonObject(const PerformanceStats::Summary&)> summaryObject = [](const PerformanceStats::Summary& summary) {
+                JsonObject summaryInfo;
+                summaryInfo["count"] = summary.mCount;
+                summaryInfo["min"] = summary.mMin;
+                summaryInfo["max"] = summary.mMax;
+                summaryInfo["average"] = summary.mAverage;
+                summaryInfo["p50"] = summary.mP50;
+                summaryInfo["p95"] = summary.mP95;
+                summaryInfo["p99"] = summary.mP99;
+                JsonArray histogram;
+                for (size_t i = 0; i < summary.mBuckets.size(); i++)
+                {
+                    histogram.Add(summary.mBuckets[i]);
+                }
+                summaryInfo["histogram"] = histogram;
+                return summaryInfo;
+            };
+
+            PerformanceStats::CompositorSummary compositor;
+            std::map<std::string, PerformanceStats::ClientSummary> clients;
+            gPerformanceStats.get(compositor, clients, reset);
+
+            JsonArray bucketLimits;
+            for (size_t i = 0; i < PerformanceStats::bucketCount(); i++)
             {
-              CompositorController::setInactivityInterval((double)interval);
+                bucketLimits.Add(PerformanceStats::bucketLimit(i));
             }
-            catch (...) 
+            stats["bucketLimits"] = bucketLimits;
+            JsonObject compositorInfo;
+            compositorInfo["framesDrawn"] = compositor.mFramesDrawn;
+            compositorInfo["framesSkipped"] = compositor.mFramesSkipped;
+            compositorInfo["drawTime"] = summaryObject(compositor.mDrawTime);
+            compositorInfo["updateTime"] = summaryObject(compositor.mUpdateTime);
+            compositorInfo["frameTime"] = summaryObject(compositor.mFrameTime);
+            compositorInfo["frameInterval"] = summaryObject(compositor.mFrameInterval);
+            compositorInfo["keyToFrameLatency"] = summaryObject(compositor.mKeyToFrameLatency);
+            stats["compositor"] = compositorInfo;
+            JsonArray clientsInfo;
+            for (std::map<std::string, PerformanceStats::ClientSummary>::const_iterator it = clients.begin(); it != clients.end(); ++it)
             {
-              std::cout << "RDKShell unable to set inactivity interval  " << std::endl;
+                JsonObject clientInfo;
+                clientInfo["client"] = it->first;
+                clientInfo["frameIntervalFromFps"] = summaryObject(it->second.mFrameIntervalFromFps);
+                clientInfo["keyToFrameLatency"] = summaryObject(it->second.mKeyToFrameLatency);
+                clientsInfo.Add(clientInfo);
             }
-            gRdkShellMutex.unlock();
-            return true;
+            stats["clients"] = clientsInfo;
         }
 
-        bool RDKShell::resetInactivityTime()
+        void RDKShell::onPerformanceStatsTimer()
         {
-            lockRdkShellMutex();
-            try
+            // sampling calls into the compositor and into every client, only do it while someone is interested
+            const uint32_t interval = mPerformanceStatsInterval;
+            const uint32_t requestedLeft = mPerformanceStatsRequestedLeft;
+            if ((interval == 0) && (requestedLeft == 0))
             {
-              CompositorController::resetInactivityTime();
-              std::cout << "RDKShell inactivity time reset" << std::endl;
+                return;
             }
-            catch (...)
+            if (requestedLeft > 0)
             {
-              std::cout << "RDKShell unable to reset inactivity time  " << std::endl;
+                mPerformanceStatsRequestedLeft = (requestedLeft > RDKSHELL_PERFORMANCE_STATS_SAMPLE_TIME_IN_MS ? requestedLeft - RDKSHELL_PERFORMANCE_STATS_SAMPLE_TIME_IN_MS : 0);
             }
-            gRdkShellMutex.unlock();
+
+            // clients report the frame rate they render at, the compositor cannot see their individual commits
+            std::vector<std::string> callsigns;
+            gPluginDataMutex.lock();
+            for (std::map<std::string, PluginData>::const_iterator it = gActivePluginsData.begin(); it != gActivePluginsData.end(); ++it)
+            {
+                callsigns.push_back(it->first);
+            }
+            gPluginDataMutex.unlock();
+            for (size_t i = 0; i < callsigns.size(); i++)
+            {
+                bool visible = false;
+                if (!getVisibility(callsigns[i], visible) || !visible)
+                {
+                    continue;
+                }
+                Exchange::IBrowser* browser(mCurrentService->QueryInterfaceByCallsign<Exchange::IBrowser>(callsigns[i]));
+                if (nullptr != browser)
+                {
+                    gPerformanceStats.clientFrameRate(callsigns[i], browser->GetFPS());
+                    browser->Release();
+                }
+            }
+
+            if (interval == 0)
+            {
+                return;
+            }
+            mPerformanceStatsElapsed += RDKSHELL_PERFORMANCE_STATS_SAMPLE_TIME_IN_MS;
+            if (mPerformanceStatsElapsed >= (interval * 1000))
+            {
+                mPerformanceStatsElapsed = 0;
+                JsonObject params;
+                getPerformanceStats(params, false);
+                notify(RDKSHELL_EVENT_ON_PERFORMANCE_STATS, params);
+            }
+        }
+
+        bool RDKShell::configureWarmPool(const JsonObject& config)
+        {
+            std::vector<WarmPool::Entry> entries;
+            const JsonArray entriesArray = config.HasLabel("entries") ? config["entries"].Array() : JsonArray();
+            for (int i=0; i<entriesArray.Length(); i++)
+            {
+                const JsonObject& entryInfo = entriesArray[i].Object();
+                if (!entryInfo.HasLabel("callsign") || !entryInfo.HasLabel("type"))
+                {
+                    return false;
+                }
+                WarmPool::Entry entry;
+                entry.mCallsign = entryInfo["callsign"].String();
+                entry.mType = entryInfo["type"].String();
+                entry.mUri = entryInfo.HasLabel("uri") ? entryInfo["uri"].String() : "";
+                entries.push_back(entry);
+            }
+            const uint32_t memoryBudget = config.HasLabel("memoryBudget") ? config["memoryBudget"].Number() : 0;
+            std::cout << "warm pool configured with " << entries.size() << " entries and a budget of " << memoryBudget << " KB\n";
+            mWarmPool.configure(entries, memoryBudget);
             return true;
         }
 
@@ -5507,6 +6142,19 @@ namespace WPEFramework {
             notify(RDKSHELL_EVENT_ON_LAUNCHED, params);
         }
 
+        void RDKShell::onLaunchStage(const std::string& client, const string& stage, const double stageStartTime, const double stageEndTime, const double launchStartTime)
+        {
+            const uint32_t duration = static_cast<uint32_t>((stageEndTime - stageStartTime) * 1000);
+            const uint32_t elapsed = static_cast<uint32_t>((stageEndTime - launchStartTime) * 1000);
+            std::cout << "launch of " << client << ": " << stage << " took " << duration << " milliseconds, " << elapsed << " milliseconds since the request" << std::endl;
+            JsonObject params;
+            params["client"] = client;
+            params["stage"] = stage;
+            params["duration"] = duration;
+            params["elapsed"] = elapsed;
+            notify(RDKSHELL_EVENT_ON_LAUNCH_STAGE, params);
+        }
+
         void RDKShell::onSuspended(const std::string& client)
         {
             std::cout << "RDKShell onSuspended event received for " << client << std::endl;
@@ -5526,9 +6174,10 @@ namespace WPEFramework {
 
         bool RDKShell::systemMemory(uint32_t &freeKb, uint32_t & totalKb, uint32_t & usedSwapKb)
         {
-            lockRdkShellMutex();
-            bool ret = RdkShell::systemRam(freeKb, totalKb, usedSwapKb);
-            gRdkShellMutex.unlock();
+            bool ret = false;
+            runOnRenderThread([&]() {
+                ret = RdkShell::systemRam(freeKb, totalKb, usedSwapKb);
+            });
             return ret;
         }
 
@@ -5554,63 +6203,63 @@ namespace WPEFramework {
         bool RDKShell::getKeyRepeatsEnabled(bool& enable)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getKeyRepeatsEnabled(enable);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::getKeyRepeatsEnabled(enable);
+            });
             return ret;
         }
 
         bool RDKShell::enableKeyRepeats(const bool enable)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::enableKeyRepeats(enable);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::enableKeyRepeats(enable);
+            });
             return ret;
         }
 
         bool RDKShell::setTopmost(const string& callsign, const bool topmost)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::setTopmost(callsign, topmost);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::setTopmost(callsign, topmost);
+            });
             return ret;
         }
 
         bool RDKShell::getVirtualResolution(const std::string& client, uint32_t &virtualWidth, uint32_t &virtualHeight)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getVirtualResolution(client, virtualWidth, virtualHeight);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::getVirtualResolution(client, virtualWidth, virtualHeight);
+            });
             return ret;
         }
 
         bool RDKShell::setVirtualResolution(const std::string& client, const uint32_t virtualWidth, const uint32_t virtualHeight)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::setVirtualResolution(client, virtualWidth, virtualHeight);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::setVirtualResolution(client, virtualWidth, virtualHeight);
+            });
             return ret;
         }
 
         bool RDKShell::enableVirtualDisplay(const std::string& client, const bool enable)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::enableVirtualDisplay(client, enable);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::enableVirtualDisplay(client, enable);
+            });
             return ret;
         }
 
         bool RDKShell::getVirtualDisplayEnabled(const std::string& client, bool &enabled)
         {
             bool ret = false;
-            lockRdkShellMutex();
-            ret = CompositorController::getVirtualDisplayEnabled(client, enabled);
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                ret = CompositorController::getVirtualDisplayEnabled(client, enabled);
+            });
             return ret;
         }
 
@@ -5658,26 +6307,26 @@ namespace WPEFramework {
         bool RDKShell::showWatermark(const bool enable)
         {
             bool ret = true;
-            lockRdkShellMutex();
-            if (enable)
-            {
-                receivedShowWatermarkRequest = true;
-            }
-            else
-            {
-                ret = CompositorController::hideWatermark();
-            }
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                if (enable)
+                {
+                    receivedShowWatermarkRequest = true;
+                }
+                else
+                {
+                    ret = CompositorController::hideWatermark();
+                }
+            });
             return ret;
         }
 
         bool RDKShell::showFullScreenImage(std::string& path)
         {
             bool ret = true;
-            lockRdkShellMutex();
-            fullScreenImagePath = path;
-            receivedFullScreenImageRequest = true;
-            gRdkShellMutex.unlock();
+            runOnRenderThread([&]() {
+                fullScreenImagePath = path;
+                receivedFullScreenImageRequest = true;
+            });
             return ret;
         }
 
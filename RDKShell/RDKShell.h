@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include "Module.h"
 #include "utils.h"
@@ -27,6 +28,8 @@
 #include <rdkshell/linuxkeys.h>
 #include "AbstractPlugin.h"
 #include "tptimer.h"
+#include "WarmPool.h"
+#include "MemoryPolicy.h"
 
 namespace WPEFramework {
 
@@ -120,6 +123,13 @@ namespace WPEFramework {
             static const string RDKSHELL_METHOD_GET_VIRTUAL_DISPLAY_ENABLED;
             static const string RDKSHELL_METHOD_GET_LAST_WAKEUP_KEY;
             static const string RDKSHELL_METHOD_GET_SCREENSHOT;
+            static const string RDKSHELL_METHOD_GET_FRAME_STATS;
+            static const string RDKSHELL_METHOD_SET_WARM_POOL;
+            static const string RDKSHELL_METHOD_GET_WARM_POOL;
+            static const string RDKSHELL_METHOD_GET_MEMORY_POLICY;
+            static const string RDKSHELL_METHOD_BATCH;
+            static const string RDKSHELL_METHOD_GET_PERFORMANCE_STATS;
+            static const string RDKSHELL_METHOD_SET_PERFORMANCE_STATS_INTERVAL;
 
             // events
             static const string RDKSHELL_EVENT_ON_USER_INACTIVITY;
@@ -142,6 +152,9 @@ namespace WPEFramework {
             static const string RDKSHELL_EVENT_ON_EASTER_EGG;
             static const string RDKSHELL_EVENT_ON_WILL_DESTROY;
             static const string RDKSHELL_EVENT_ON_SCREENSHOT_COMPLETE;
+            static const string RDKSHELL_EVENT_ON_APPLICATION_RECLAIMED;
+            static const string RDKSHELL_EVENT_ON_PERFORMANCE_STATS;
+            static const string RDKSHELL_EVENT_ON_LAUNCH_STAGE;
 
             void notify(const std::string& event, const JsonObject& parameters);
             void pluginEventHandler(const JsonObject& parameters);
@@ -217,6 +230,13 @@ namespace WPEFramework {
             uint32_t getVirtualDisplayEnabledWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getLastWakeupKeyWrapper(const JsonObject& parameters, JsonObject& response);
             uint32_t getScreenshotWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getFrameStatsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setWarmPoolWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getWarmPoolWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getMemoryPolicyWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t batchWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t getPerformanceStatsWrapper(const JsonObject& parameters, JsonObject& response);
+            uint32_t setPerformanceStatsIntervalWrapper(const JsonObject& parameters, JsonObject& response);
 
         private/*internal methods*/:
             RDKShell(const RDKShell&) = delete;
@@ -246,6 +266,7 @@ namespace WPEFramework {
             bool setBounds(const string& client, const unsigned int x, const unsigned int y, const unsigned int w, const unsigned int h);
             bool getVisibility(const string& client, bool& visibility);
             bool setVisibility(const string& client, const bool visible);
+            void setBrowserVisibility(const string& client, const bool visible);
             bool getOpacity(const string& client, unsigned int& opacity);
             bool setOpacity(const string& client, const unsigned int opacity);
             bool getScale(const string& client, double& scaleX, double& scaleY);
@@ -257,7 +278,12 @@ namespace WPEFramework {
             bool enableInactivityReporting(const bool enable);
             bool setInactivityInterval(const uint32_t interval);
             bool resetInactivityTime();
+            bool configureWarmPool(const JsonObject& config);
+            void startMemoryPolicy(const string& configLine);
+            void getPerformanceStats(JsonObject& stats, const bool reset);
+            void onPerformanceStatsTimer();
             void onLaunched(const std::string& client, const string& launchType);
+            void onLaunchStage(const std::string& client, const string& stage, const double stageStartTime, const double stageEndTime, const double launchStartTime);
             void onSuspended(const std::string& client);
             void onDestroyed(const std::string& client);
             bool systemMemory(uint32_t &freeKb, uint32_t & totalKb, uint32_t & usedSwapKb);
@@ -360,6 +386,13 @@ namespace WPEFramework {
             uint32_t mLastWakeupKeyModifiers;
             uint64_t mLastWakeupKeyTimestamp;
             TpTimer m_timer;
+            WarmPool mWarmPool;
+            MemoryPolicy mMemoryPolicy;
+            TpTimer mPerformanceStatsTimer;
+            // seconds between onPerformanceStats events, 0 when disabled
+            std::atomic<uint32_t> mPerformanceStatsInterval;
+            std::atomic<uint32_t> mPerformanceStatsElapsed;
+            std::atomic<uint32_t> mPerformanceStatsRequestedLeft;
         };
 
         struct PluginData
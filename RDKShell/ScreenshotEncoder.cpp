@@ -0,0 +1,371 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ScreenshotEncoder.h"
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <png.h>
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SCREENSHOT_ENCODER_NEON
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define SCREENSHOT_ENCODER_SSSE3
+#endif
+
+#define SCREENSHOT_ENCODER_MAX_SEGMENTS 4
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace {
+
+            const char sBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+            // both output characters for every 12 bit half of a 3 byte group
+            struct Base64PairTable
+            {
+                Base64PairTable()
+                {
+                    for (uint32_t i = 0; i < 4096; i++)
+                    {
+                        mPairs[i][0] = sBase64Alphabet[i >> 6];
+                        mPairs[i][1] = sBase64Alphabet[i & 0x3F];
+                    }
+                }
+                char mPairs[4096][2];
+            };
+
+            const Base64PairTable sBase64PairTable;
+
+            // The vector paths map 6 bit indices to characters arithmetically: the character is
+            // the index plus an offset that only depends on the range the index falls in.
+            const uint8_t sBase64OffsetUpper = 'A';
+            const uint8_t sBase64OffsetLower = 'a' - 26;
+            const uint8_t sBase64OffsetDigit = static_cast<uint8_t>('0' - 52);
+            const uint8_t sBase64OffsetPlus = static_cast<uint8_t>('+' - 62);
+            const uint8_t sBase64OffsetSlash = static_cast<uint8_t>('/' - 63);
+
+#if defined(SCREENSHOT_ENCODER_NEON)
+            inline uint8x16_t base64Translate(const uint8x16_t index)
+            {
+                uint8x16_t offset = vdupq_n_u8(sBase64OffsetUpper);
+                offset = vbslq_u8(vcgeq_u8(index, vdupq_n_u8(26)), vdupq_n_u8(sBase64OffsetLower), offset);
+                offset = vbslq_u8(vcgeq_u8(index, vdupq_n_u8(52)), vdupq_n_u8(sBase64OffsetDigit), offset);
+                offset = vbslq_u8(vceqq_u8(index, vdupq_n_u8(62)), vdupq_n_u8(sBase64OffsetPlus), offset);
+                offset = vbslq_u8(vceqq_u8(index, vdupq_n_u8(63)), vdupq_n_u8(sBase64OffsetSlash), offset);
+                return vaddq_u8(index, offset);
+            }
+
+            // 48 input bytes to 64 characters per iteration, returns the number of bytes consumed
+            size_t base64EncodeBlocks(const uint8_t* src, const size_t size, char* dst)
+            {
+                size_t done = 0;
+                while ((size - done) >= 48)
+                {
+                    const uint8x16x3_t in = vld3q_u8(src + done);
+                    uint8x16x4_t out;
+                    out.val[0] = base64Translate(vshrq_n_u8(in.val[0], 2));
+                    out.val[1] = base64Translate(vorrq_u8(vshlq_n_u8(vandq_u8(in.val[0], vdupq_n_u8(0x03)), 4), vshrq_n_u8(in.val[1], 4)));
+                    out.val[2] = base64Translate(vorrq_u8(vshlq_n_u8(vandq_u8(in.val[1], vdupq_n_u8(0x0F)), 2), vshrq_n_u8(in.val[2], 6)));
+                    out.val[3] = base64Translate(vandq_u8(in.val[2], vdupq_n_u8(0x3F)));
+                    vst4q_u8(reinterpret_cast<uint8_t*>(dst), out);
+                    done += 48;
+                    dst += 64;
+                }
+                return done;
+            }
+#elif defined(SCREENSHOT_ENCODER_SSSE3)
+            inline __m128i base64Select(const __m128i mask, const uint8_t value, const __m128i other)
+            {
+                return _mm_or_si128(_mm_and_si128(mask, _mm_set1_epi8(static_cast<char>(value))), _mm_andnot_si128(mask, other));
+            }
+
+            inline __m128i base64Translate(const __m128i index)
+            {
+                // indices are below 64, so signed compares are fine
+                __m128i offset = _mm_set1_epi8(static_cast<char>(sBase64OffsetUpper));
+                offset = base64Select(_mm_cmpgt_epi8(index, _mm_set1_epi8(25)), sBase64OffsetLower, offset);
+                offset = base64Select(_mm_cmpgt_epi8(index, _mm_set1_epi8(51)), sBase64OffsetDigit, offset);
+                offset = base64Select(_mm_cmpeq_epi8(index, _mm_set1_epi8(62)), sBase64OffsetPlus, offset);
+                offset = base64Select(_mm_cmpeq_epi8(index, _mm_set1_epi8(63)), sBase64OffsetSlash, offset);
+                return _mm_add_epi8(index, offset);
+            }
+
+            // 12 input bytes to 16 characters per iteration, reads 16 bytes so it stops while at
+            // least that many are left, returns the number of bytes consumed
+            size_t base64EncodeBlocks(const uint8_t* src, const size_t size, char* dst)
+            {
+                // every 32 bit lane gets the bytes of one group as b1 b0 b2 b1
+                const __m128i spread = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+                size_t done = 0;
+                while ((size - done) >= 16)
+                {
+                    const __m128i in = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + done)), spread);
+                    // index 0 and 2 sit in the upper bits of their 16 bit halves, index 1 and 3 in
+                    // the lower ones: shift both into the low 6 bits of their byte
+                    const __m128i high = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+                    const __m128i low = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), base64Translate(_mm_or_si128(high, low)));
+                    done += 12;
+                    dst += 16;
+                }
+                return done;
+            }
+#else
+            size_t base64EncodeBlocks(const uint8_t*, const size_t, char*)
+            {
+                return 0;
+            }
+#endif
+
+            void pngWriteCallback(png_structp pngPtr, png_bytep data, png_size_t length)
+            {
+                std::vector<uint8_t>* out = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(pngPtr));
+                out->insert(out->end(), data, data + length);
+            }
+        }
+
+        ScreenshotEncoder::ScreenshotEncoder() : mSegmentCount(0), mRunning(false)
+        {
+        }
+
+        ScreenshotEncoder::~ScreenshotEncoder()
+        {
+            stop();
+        }
+
+        void ScreenshotEncoder::start(const CompletionHandler& handler)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mRunning)
+            {
+                return;
+            }
+            mHandler = handler;
+            mRunning = true;
+            mThread = std::thread(&ScreenshotEncoder::run, this);
+        }
+
+        void ScreenshotEncoder::stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mRunning = false;
+            }
+            mCondition.notify_one();
+            if (mThread.joinable())
+            {
+                mThread.join();
+            }
+            for (std::list<Job>::iterator it = mJobs.begin(); it != mJobs.end(); ++it)
+            {
+                free(it->mData);
+            }
+            mJobs.clear();
+            for (std::list<std::string>::const_iterator it = mSegments.begin(); it != mSegments.end(); ++it)
+            {
+                shm_unlink(it->c_str());
+            }
+            mSegments.clear();
+        }
+
+        void ScreenshotEncoder::submit(uint8_t* data, const size_t size, const uint32_t width, const uint32_t height, const uint8_t formats)
+        {
+            Job job = { data, size, width, height, formats };
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (!mRunning)
+                {
+                    free(data);
+                    return;
+                }
+                mJobs.push_back(job);
+            }
+            mCondition.notify_one();
+        }
+
+        void ScreenshotEncoder::run()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (mRunning)
+            {
+                if (mJobs.empty())
+                {
+                    mCondition.wait(lock);
+                    continue;
+                }
+                Job job = mJobs.front();
+                mJobs.pop_front();
+                lock.unlock();
+                encode(job);
+                free(job.mData);
+                lock.lock();
+            }
+        }
+
+        void ScreenshotEncoder::encode(const Job& job)
+        {
+            if ((nullptr == job.mData) || (0 == job.mSize))
+            {
+                std::cout << "screenshot readback failed\n";
+                return;
+            }
+            if (job.mFormats & FORMAT_RAW)
+            {
+                std::string imageData;
+                base64Encode(job.mData, job.mSize, imageData);
+                std::cout << "Screenshot success size:" << job.mSize << std::endl;
+                mHandler("raw", job.mWidth, job.mHeight, imageData);
+            }
+            if (job.mFormats & FORMAT_PNG)
+            {
+                std::vector<uint8_t> png;
+                if ((static_cast<size_t>(job.mWidth) * job.mHeight * 4 != job.mSize) || !pngEncode(job.mData, job.mWidth, job.mHeight, true, png))
+                {
+                    std::cout << "unable to compress screenshot of size " << job.mSize << " to png\n";
+                    return;
+                }
+                std::string imageData;
+                base64Encode(png.data(), png.size(), imageData);
+                std::cout << "Screenshot success size:" << job.mSize << " png size:" << png.size() << std::endl;
+                mHandler("png", job.mWidth, job.mHeight, imageData);
+            }
+            if (job.mFormats & FORMAT_SHM)
+            {
+                std::string name = "/rdkshell-screenshot-" + std::to_string(getpid()) + "-" + std::to_string(mSegmentCount++);
+                if (!shmExport(job.mData, job.mSize, name))
+                {
+                    std::cout << "unable to export screenshot of size " << job.mSize << " to shared memory\n";
+                    return;
+                }
+                mSegments.push_back(name);
+                while (mSegments.size() > SCREENSHOT_ENCODER_MAX_SEGMENTS)
+                {
+                    shm_unlink(mSegments.front().c_str());
+                    mSegments.pop_front();
+                }
+                std::cout << "Screenshot success size:" << job.mSize << " shared as " << name << std::endl;
+                mHandler("shm", job.mWidth, job.mHeight, name);
+            }
+        }
+
+        void ScreenshotEncoder::base64Encode(const uint8_t* data, const size_t size, std::string& out)
+        {
+            const size_t groups = size / 3;
+            const size_t remainder = size % 3;
+            out.resize((groups + (remainder != 0 ? 1 : 0)) * 4);
+
+            // the vector path covers whole blocks, the table the groups left after it
+            const size_t vectorized = base64EncodeBlocks(data, size, &out[0]);
+            char* dst = &out[0] + ((vectorized / 3) * 4);
+            const uint8_t* src = data + vectorized;
+            const uint8_t* const end = data + (groups * 3);
+            while (src != end)
+            {
+                const uint32_t group = (static_cast<uint32_t>(src[0]) << 16) | (static_cast<uint32_t>(src[1]) << 8) | src[2];
+                memcpy(dst, sBase64PairTable.mPairs[group >> 12], 2);
+                memcpy(dst + 2, sBase64PairTable.mPairs[group & 0xFFF], 2);
+                src += 3;
+                dst += 4;
+            }
+
+            if (remainder != 0)
+            {
+                const uint32_t group = (static_cast<uint32_t>(src[0]) << 16) | (remainder == 2 ? (static_cast<uint32_t>(src[1]) << 8) : 0);
+                dst[0] = sBase64Alphabet[(group >> 18) & 0x3F];
+                dst[1] = sBase64Alphabet[(group >> 12) & 0x3F];
+                dst[2] = (remainder == 2 ? sBase64Alphabet[(group >> 6) & 0x3F] : '=');
+                dst[3] = '=';
+            }
+        }
+
+        bool ScreenshotEncoder::shmExport(const uint8_t* data, const size_t size, const std::string& name)
+        {
+            int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0)
+            {
+                return false;
+            }
+            void* mapped = MAP_FAILED;
+            if (ftruncate(fd, size) == 0)
+            {
+                mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            close(fd);
+            if (mapped == MAP_FAILED)
+            {
+                shm_unlink(name.c_str());
+                return false;
+            }
+            memcpy(mapped, data, size);
+            munmap(mapped, size);
+            return true;
+        }
+
+        bool ScreenshotEncoder::pngEncode(const uint8_t* data, const uint32_t width, const uint32_t height, const bool bottomUp, std::vector<uint8_t>& out)
+        {
+            if ((nullptr == data) || (0 == width) || (0 == height))
+            {
+                return false;
+            }
+
+            png_structp pngPtr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+            if (NULL == pngPtr)
+            {
+                return false;
+            }
+            png_infop infoPtr = png_create_info_struct(pngPtr);
+            if (NULL == infoPtr)
+            {
+                png_destroy_write_struct(&pngPtr, NULL);
+                return false;
+            }
+
+            // the readback is bottom up, flip by handing libpng the rows in reverse order
+            std::vector<png_bytep> rows(height);
+            const size_t pitch = static_cast<size_t>(width) * 4;
+            for (uint32_t i = 0; i < height; ++i)
+            {
+                rows[i] = const_cast<png_bytep>(data + ((bottomUp ? (height - 1 - i) : i) * pitch));
+            }
+
+            if (setjmp(png_jmpbuf(pngPtr)))
+            {
+                png_destroy_write_struct(&pngPtr, &infoPtr);
+                out.clear();
+                return false;
+            }
+
+            out.reserve(pitch * height / 4);
+            png_set_IHDR(pngPtr, infoPtr, width, height, 8, PNG_COLOR_TYPE_RGBA,
+                PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+            png_set_write_fn(pngPtr, &out, pngWriteCallback, NULL);
+            png_set_rows(pngPtr, infoPtr, rows.data());
+            png_write_png(pngPtr, infoPtr, PNG_TRANSFORM_IDENTITY, NULL);
+            png_destroy_write_struct(&pngPtr, &infoPtr);
+            return true;
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,91 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Encodes screenshots read back by the render thread on a worker thread, so that the
+        // render thread only pays for the readback itself.
+        class ScreenshotEncoder
+        {
+            public:
+                enum Format : uint8_t
+                {
+                    FORMAT_RAW = 0x01, // RGBA rows as read back, bottom row first
+                    FORMAT_PNG = 0x02,
+                    FORMAT_SHM = 0x04  // raw rows in a POSIX shared memory segment
+                };
+
+                // called on the worker thread with the base64 encoded image, or with the name of the
+                // shared memory segment for FORMAT_SHM
+                typedef std::function<void(const std::string& format, const uint32_t width, const uint32_t height, std::string& imageData)> CompletionHandler;
+
+                ScreenshotEncoder();
+                ~ScreenshotEncoder();
+                ScreenshotEncoder(const ScreenshotEncoder&) = delete;
+                ScreenshotEncoder& operator=(const ScreenshotEncoder&) = delete;
+
+                void start(const CompletionHandler& handler);
+                void stop();
+
+                // takes ownership of data, which has to be allocated with malloc
+                void submit(uint8_t* data, const size_t size, const uint32_t width, const uint32_t height, const uint8_t formats);
+
+                static void base64Encode(const uint8_t* data, const size_t size, std::string& out);
+                static bool pngEncode(const uint8_t* data, const uint32_t width, const uint32_t height, const bool bottomUp, std::vector<uint8_t>& out);
+                static bool shmExport(const uint8_t* data, const size_t size, const std::string& name);
+
+            private:
+                struct Job
+                {
+                    uint8_t* mData;
+                    size_t mSize;
+                    uint32_t mWidth;
+                    uint32_t mHeight;
+                    uint8_t mFormats;
+                };
+
+                void run();
+                void encode(const Job& job);
+
+                std::mutex mMutex;
+                std::condition_variable mCondition;
+                std::list<Job> mJobs;
+                // exported segments, normally unlinked by the consumer once mapped, the oldest ones
+                // are unlinked here in case nobody picked them up
+                std::list<std::string> mSegments;
+                uint32_t mSegmentCount;
+                std::thread mThread;
+                CompletionHandler mHandler;
+                bool mRunning;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,317 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "WarmPool.h"
+#include <chrono>
+#include <iostream>
+
+#define RDKSHELL_WARM_POOL_RETRY_TIME_IN_SECONDS 60
+#define RDKSHELL_WARM_POOL_CHECK_INTERVAL_IN_SECONDS 30
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        namespace {
+
+            double now()
+            {
+                return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+        }
+
+        WarmPool::WarmPool() : mMemoryBudgetKb(0), mWarmLaunches(0), mColdLaunches(0), mRunning(false)
+        {
+        }
+
+        WarmPool::~WarmPool()
+        {
+            stop();
+        }
+
+        void WarmPool::start(const WarmHandler& warm, const ResidentHandler& resident, const DestroyHandler& destroy)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mRunning)
+            {
+                return;
+            }
+            mWarm = warm;
+            mResident = resident;
+            mDestroy = destroy;
+            mRunning = true;
+            mThread = std::thread(&WarmPool::run, this);
+        }
+
+        void WarmPool::stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mRunning = false;
+            }
+            mCondition.notify_all();
+            if (mThread.joinable())
+            {
+                mThread.join();
+            }
+        }
+
+        void WarmPool::configure(const std::vector<Entry>& entries, const uint32_t memoryBudgetKb)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                std::vector<Slot> slots;
+                for (std::vector<Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+                {
+                    Slot* existing = find(it->mCallsign);
+                    if (existing != nullptr)
+                    {
+                        slots.push_back(*existing);
+                        slots.back().mEntry = *it;
+                    }
+                    else
+                    {
+                        Slot slot = { *it, EMPTY, 0, 0 };
+                        slots.push_back(slot);
+                    }
+                }
+                for (std::vector<Slot>::iterator it = mSlots.begin(); it != mSlots.end(); ++it)
+                {
+                    bool kept = false;
+                    for (std::vector<Entry>::const_iterator entry = entries.begin(); entry != entries.end(); ++entry)
+                    {
+                        if (entry->mCallsign == it->mEntry.mCallsign)
+                        {
+                            kept = true;
+                            break;
+                        }
+                    }
+                    // claimed instances belong to the application now, warming ones are handled when done
+                    if (!kept && (it->mState == WARM))
+                    {
+                        mRemoved.push_back(it->mEntry.mCallsign);
+                    }
+                }
+                mSlots.swap(slots);
+                mMemoryBudgetKb = memoryBudgetKb;
+            }
+            mCondition.notify_all();
+        }
+
+        bool WarmPool::isPoolThread() const
+        {
+            return (std::this_thread::get_id() == mThread.get_id());
+        }
+
+        void WarmPool::waitForWarmUp(const std::string& callsign)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            waitWhileWarming(lock, callsign);
+        }
+
+        bool WarmPool::claim(const std::string& callsign)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (isPoolThread())
+            {
+                // launch issued by the pool itself
+                return false;
+            }
+            Slot* slot = waitWhileWarming(lock, callsign);
+            bool warm = ((slot != nullptr) && (slot->mState == WARM));
+            if (slot != nullptr)
+            {
+                slot->mState = CLAIMED;
+            }
+            if (warm)
+            {
+                mWarmLaunches++;
+            }
+            else
+            {
+                mColdLaunches++;
+            }
+            return warm;
+        }
+
+        void WarmPool::released(const std::string& callsign)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                Slot* slot = find(callsign);
+                if ((slot == nullptr) || ((slot->mState != WARM) && (slot->mState != CLAIMED)))
+                {
+                    return;
+                }
+                slot->mState = EMPTY;
+                slot->mRetryTime = 0;
+            }
+            mCondition.notify_all();
+        }
+
+        void WarmPool::getInfo(std::vector<SlotInfo>& slots, uint32_t& memoryBudgetKb, uint32_t& warmLaunches, uint32_t& coldLaunches)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (std::vector<Slot>::const_iterator it = mSlots.begin(); it != mSlots.end(); ++it)
+            {
+                SlotInfo info = { it->mEntry, it->mState, it->mResidentKb };
+                slots.push_back(info);
+            }
+            memoryBudgetKb = mMemoryBudgetKb;
+            warmLaunches = mWarmLaunches;
+            coldLaunches = mColdLaunches;
+        }
+
+        const char* WarmPool::stateName(const State state)
+        {
+            switch (state)
+            {
+                case EMPTY:
+                    return "empty";
+                case WARMING:
+                    return "warming";
+                case WARM:
+                    return "warm";
+                case CLAIMED:
+                    return "claimed";
+            }
+            return "unknown";
+        }
+
+        void WarmPool::run()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (mRunning)
+            {
+                if (!mRemoved.empty())
+                {
+                    std::string callsign = mRemoved.back();
+                    mRemoved.pop_back();
+                    lock.unlock();
+                    std::cout << "destroying warm instance " << callsign << " as it is no longer pooled\n";
+                    mDestroy(callsign);
+                    lock.lock();
+                    continue;
+                }
+
+                // the resident size of the last run of an instance predicts the next one
+                Slot* next = nullptr;
+                const double currentTime = now();
+                for (std::vector<Slot>::iterator it = mSlots.begin(); it != mSlots.end(); ++it)
+                {
+                    if ((it->mState == EMPTY) && (it->mRetryTime <= currentTime) &&
+                        ((mMemoryBudgetKb == 0) || ((warmResidentKb() + it->mResidentKb) <= mMemoryBudgetKb)))
+                    {
+                        next = &(*it);
+                        break;
+                    }
+                }
+                if (next == nullptr)
+                {
+                    mCondition.wait_for(lock, std::chrono::seconds(RDKSHELL_WARM_POOL_CHECK_INTERVAL_IN_SECONDS));
+                    continue;
+                }
+
+                const Entry entry = next->mEntry;
+                next->mState = WARMING;
+                lock.unlock();
+                std::cout << "warming " << entry.mCallsign << " of type " << entry.mType << std::endl;
+                const double warmStartTime = now();
+                const bool warmed = mWarm(entry);
+                const uint32_t residentKb = (warmed ? mResident(entry.mCallsign) : 0);
+                lock.lock();
+
+                bool destroy = false;
+                Slot* slot = find(entry.mCallsign);
+                if (slot == nullptr)
+                {
+                    destroy = warmed;
+                }
+                else if (!warmed)
+                {
+                    std::cout << "unable to warm " << entry.mCallsign << std::endl;
+                    slot->mState = EMPTY;
+                    slot->mRetryTime = now() + RDKSHELL_WARM_POOL_RETRY_TIME_IN_SECONDS;
+                }
+                else
+                {
+                    slot->mResidentKb = residentKb;
+                    slot->mState = WARM;
+                    if ((mMemoryBudgetKb != 0) && (warmResidentKb() > mMemoryBudgetKb))
+                    {
+                        std::cout << "warm instance " << entry.mCallsign << " uses " << residentKb << " KB and exceeds the pool budget of " << mMemoryBudgetKb << " KB\n";
+                        slot->mState = EMPTY;
+                        destroy = true;
+                    }
+                    else
+                    {
+                        std::cout << entry.mCallsign << " is warm after " << (now() - warmStartTime) * 1000 << " milliseconds, resident " << residentKb << " KB\n";
+                    }
+                }
+                mCondition.notify_all();
+
+                if (destroy)
+                {
+                    lock.unlock();
+                    mDestroy(entry.mCallsign);
+                    lock.lock();
+                }
+            }
+            mCondition.notify_all();
+        }
+
+        WarmPool::Slot* WarmPool::waitWhileWarming(std::unique_lock<std::mutex>& lock, const std::string& callsign)
+        {
+            // the warm-up is a launch of the same callsign, a second launch must not run next to it. The pool
+            // thread always finishes a warm-up it started, even when stopped, so the state changes eventually.
+            Slot* slot = find(callsign);
+            while (!isPoolThread() && (slot != nullptr) && (slot->mState == WARMING))
+            {
+                mCondition.wait(lock);
+                slot = find(callsign);
+            }
+            return slot;
+        }
+
+        WarmPool::Slot* WarmPool::find(const std::string& callsign)
+        {
+            for (std::vector<Slot>::iterator it = mSlots.begin(); it != mSlots.end(); ++it)
+            {
+                if (it->mEntry.mCallsign == callsign)
+                {
+                    return &(*it);
+                }
+            }
+            return nullptr;
+        }
+
+        uint32_t WarmPool::warmResidentKb() const
+        {
+            uint32_t total = 0;
+            for (std::vector<Slot>::const_iterator it = mSlots.begin(); it != mSlots.end(); ++it)
+            {
+                if ((it->mState == WARM) || (it->mState == WARMING))
+                {
+                    total += it->mResidentKb;
+                }
+            }
+            return total;
+        }
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,123 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Keeps configured application instances started, hidden and suspended so that a launch
+        // only has to resume them. Thunder identifies an instance by its callsign, so every pool
+        // slot is a callsign of a given type and a launch of that callsign claims the slot. A
+        // claimed slot is refilled in the background once the instance has been deactivated,
+        // as long as the resident memory of all warm instances stays within the budget.
+        class WarmPool
+        {
+            public:
+                enum State
+                {
+                    EMPTY,
+                    WARMING,
+                    WARM,
+                    CLAIMED
+                };
+
+                struct Entry
+                {
+                    std::string mCallsign;
+                    std::string mType;
+                    std::string mUri;
+                };
+
+                struct SlotInfo
+                {
+                    Entry mEntry;
+                    State mState;
+                    uint32_t mResidentKb;
+                };
+
+                // starts (true on success), measures and destroys an instance, called on the pool thread
+                typedef std::function<bool(const Entry&)> WarmHandler;
+                typedef std::function<uint32_t(const std::string&)> ResidentHandler;
+                typedef std::function<void(const std::string&)> DestroyHandler;
+
+                WarmPool();
+                ~WarmPool();
+                WarmPool(const WarmPool&) = delete;
+                WarmPool& operator=(const WarmPool&) = delete;
+
+                void start(const WarmHandler& warm, const ResidentHandler& resident, const DestroyHandler& destroy);
+                void stop();
+
+                // replaces the configuration, warm instances that are no longer configured are destroyed
+                void configure(const std::vector<Entry>& entries, const uint32_t memoryBudgetKb);
+
+                // waits until the pool is no longer warming the callsign. The warm-up is itself a launch, so it
+                // ends within the timeouts of a launch.
+                void waitForWarmUp(const std::string& callsign);
+                // called at the start of every launch, returns true when a warm instance was claimed. A launch
+                // of an instance that is still warming waits for the warm-up to end first.
+                bool claim(const std::string& callsign);
+                // the instance was deactivated, the slot can be refilled
+                void released(const std::string& callsign);
+                // true for the launches the pool makes to warm an instance
+                bool isPoolThread() const;
+
+                void getInfo(std::vector<SlotInfo>& slots, uint32_t& memoryBudgetKb, uint32_t& warmLaunches, uint32_t& coldLaunches);
+
+                static const char* stateName(const State state);
+
+            private:
+                struct Slot
+                {
+                    Entry mEntry;
+                    State mState;
+                    uint32_t mResidentKb;
+                    double mRetryTime;
+                };
+
+                void run();
+                Slot* waitWhileWarming(std::unique_lock<std::mutex>& lock, const std::string& callsign);
+                Slot* find(const std::string& callsign);
+                uint32_t warmResidentKb() const;
+
+                std::mutex mMutex;
+                std::condition_variable mCondition;
+                std::vector<Slot> mSlots;
+                std::vector<std::string> mRemoved;
+                uint32_t mMemoryBudgetKb;
+                uint32_t mWarmLaunches;
+                uint32_t mColdLaunches;
+                bool mRunning;
+                std::thread mThread;
+                WarmHandler mWarm;
+                ResidentHandler mResident;
+                DestroyHandler mDestroy;
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
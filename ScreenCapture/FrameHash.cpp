@@ -0,0 +1,94 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "FrameHash.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace WPEFramework
+{
+    namespace Plugin
+    {
+        const int FrameHash::BLOCK_SIZE;
+
+        namespace
+        {
+            inline uint64_t mix(uint64_t hash, uint64_t value)
+            {
+                hash ^= value;
+                hash *= 0x100000001b3ULL;
+                return hash ^ (hash >> 29);
+            }
+        }
+
+        void FrameHash::compute(const unsigned char *pixels, int width, int height, std::vector<uint64_t> &blocks)
+        {
+            const int columns = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            const int rows = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            const size_t pitch = (size_t)width * 4;
+
+            // the frame size goes first so that frames of another size never match
+            blocks.assign((size_t)columns * rows + 1, 0xcbf29ce484222325ULL);
+            blocks[0] = ((uint64_t)width << 32) | (uint32_t)height;
+
+            for (int y = 0; y < height; y++)
+            {
+                const unsigned char *row = pixels + y * pitch;
+                uint64_t *hashes = &blocks[1 + (y / BLOCK_SIZE) * columns];
+                for (int column = 0; column < columns; column++)
+                {
+                    // two pixels at a time, a block row is a multiple of 8 bytes except at the right edge
+                    size_t begin = (size_t)column * BLOCK_SIZE * 4;
+                    size_t end = std::min(begin + BLOCK_SIZE * 4, pitch);
+                    uint64_t hash = hashes[column];
+                    size_t i = begin;
+                    for (; i + 8 <= end; i += 8)
+                    {
+                        uint64_t value;
+                        memcpy(&value, row + i, 8);
+                        hash = mix(hash, value);
+                    }
+                    if (i < end)
+                    {
+                        uint64_t value = 0;
+                        memcpy(&value, row + i, end - i);
+                        hash = mix(hash, value);
+                    }
+                    hashes[column] = hash;
+                }
+            }
+        }
+
+        size_t FrameHash::changedBlocks(const std::vector<uint64_t> &previous, const std::vector<uint64_t> &current)
+        {
+            if (previous.empty() || previous.size() != current.size() || previous[0] != current[0])
+                return current.empty() ? 0 : current.size() - 1;
+
+            size_t changed = 0;
+            for (size_t i = 1; i < current.size(); i++)
+            {
+                if (previous[i] != current[i])
+                    changed++;
+            }
+            return changed;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,44 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Cheap per block fingerprint of an RGBA frame, used to detect captures that did not
+        // change since the previous one.
+        class FrameHash
+        {
+        public:
+            static const int BLOCK_SIZE = 64;
+
+            // one hash per BLOCK_SIZE x BLOCK_SIZE block, row by row
+            static void compute(const unsigned char *pixels, int width, int height, std::vector<uint64_t> &blocks);
+            // number of blocks that differ, all of them when the frame size changed
+            static size_t changedBlocks(const std::vector<uint64_t> &previous, const std::vector<uint64_t> &current);
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
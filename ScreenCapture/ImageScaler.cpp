@@ -0,0 +1,95 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ImageScaler.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace WPEFramework
+{
+    namespace Plugin
+    {
+        bool ImageScaler::transform(const unsigned char *pixels, int width, int height, bool bottomUp,
+            const Rect &rect, int outWidth, int outHeight, std::vector<unsigned char> &out)
+        {
+            if (NULL == pixels || rect.w <= 0 || rect.h <= 0 || rect.x < 0 || rect.y < 0
+                || rect.x + rect.w > width || rect.y + rect.h > height
+                || outWidth <= 0 || outHeight <= 0 || outWidth > rect.w || outHeight > rect.h)
+                return false;
+
+            const size_t pitch = (size_t)width * 4;
+            const size_t rowLength = (size_t)rect.w * 4;
+            out.resize((size_t)outWidth * outHeight * 4);
+
+            if (outWidth == rect.w && outHeight == rect.h)
+            {
+                for (int y = 0; y < rect.h; y++)
+                {
+                    int row = rect.y + y;
+                    memcpy(&out[y * rowLength], pixels + (bottomUp ? height - 1 - row : row) * pitch + rect.x * 4, rowLength);
+                }
+                return true;
+            }
+
+            // every output pixel averages the box of source pixels it covers. The rows of a box are
+            // summed per channel first, in a plain loop the compiler vectorizes, then the columns
+            std::vector<uint32_t> sums(rowLength);
+            std::vector<int> columnStart(outWidth + 1);
+            for (int x = 0; x <= outWidth; x++)
+                columnStart[x] = (int)((int64_t)x * rect.w / outWidth);
+
+            for (int oy = 0; oy < outHeight; oy++)
+            {
+                int y0 = (int)((int64_t)oy * rect.h / outHeight);
+                int y1 = (int)((int64_t)(oy + 1) * rect.h / outHeight);
+
+                memset(&sums[0], 0, sums.size() * sizeof(uint32_t));
+                for (int y = y0; y < y1; y++)
+                {
+                    int row = rect.y + y;
+                    const unsigned char *src = pixels + (bottomUp ? height - 1 - row : row) * pitch + rect.x * 4;
+                    uint32_t *sum = &sums[0];
+                    for (size_t i = 0; i < rowLength; i++)
+                        sum[i] += src[i];
+                }
+
+                unsigned char *dst = &out[(size_t)oy * outWidth * 4];
+                for (int ox = 0; ox < outWidth; ox++)
+                {
+                    int x0 = columnStart[ox];
+                    int x1 = columnStart[ox + 1];
+                    uint32_t total[4] = { 0, 0, 0, 0 };
+                    for (int x = x0; x < x1; x++)
+                    {
+                        total[0] += sums[x * 4 + 0];
+                        total[1] += sums[x * 4 + 1];
+                        total[2] += sums[x * 4 + 2];
+                        total[3] += sums[x * 4 + 3];
+                    }
+                    uint32_t count = (uint32_t)(x1 - x0) * (y1 - y0);
+                    for (int c = 0; c < 4; c++)
+                        dst[ox * 4 + c] = (total[c] + count / 2) / count;
+                }
+            }
+            return true;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,47 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Crops and downscales RGBA captures before they are encoded.
+        class ImageScaler
+        {
+        public:
+            struct Rect
+            {
+                int x;
+                int y;
+                int w;
+                int h;
+            };
+
+            // copies rect out of the image, top row first, and box filters it down to
+            // outWidth x outHeight, which must not be larger than the rect
+            static bool transform(const unsigned char *pixels, int width, int height, bool bottomUp,
+                const Rect &rect, int outWidth, int outHeight, std::vector<unsigned char> &out);
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
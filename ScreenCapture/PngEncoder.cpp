@@ -0,0 +1,306 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "PngEncoder.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#define PNG_ENCODER_MAX_THREADS 4
+#define PNG_ENCODER_BYTES_PER_PIXEL 4
+
+namespace WPEFramework
+{
+    namespace Plugin
+    {
+        namespace
+        {
+            struct Band
+            {
+                Band() : adler(0), length(0), done(false), failed(false) { }
+
+                std::vector<unsigned char> data;
+                uLong adler;      // of the filtered rows, combined into the checksum of the stream
+                uLong length;
+                bool done;
+                bool failed;
+            };
+
+            void put32(unsigned char *p, uint32_t value)
+            {
+                p[0] = value >> 24;
+                p[1] = value >> 16;
+                p[2] = value >> 8;
+                p[3] = value;
+            }
+
+            bool writeChunk(const PngEncoder::Writer &writer, const char *type, const unsigned char *data, size_t length)
+            {
+                unsigned char header[8];
+                unsigned char trailer[4];
+                put32(header, length);
+                memcpy(header + 4, type, 4);
+                uLong crc = crc32(0, header + 4, 4);
+                if (length > 0)
+                    crc = crc32(crc, data, length);
+                put32(trailer, crc);
+                return writer(header, sizeof(header)) && (0 == length || writer(data, length)) && writer(trailer, sizeof(trailer));
+            }
+
+            inline unsigned char paeth(int a, int b, int c)
+            {
+                int p = a + b - c;
+                int pa = abs(p - a);
+                int pb = abs(p - b);
+                int pc = abs(p - c);
+                if (pa <= pb && pa <= pc)
+                    return a;
+                return (pb <= pc) ? b : c;
+            }
+
+            // writes the filter type byte followed by the filtered row, prev is NULL for the first row
+            void filterRow(PngEncoder::Filter filter, const unsigned char *row, const unsigned char *prev, size_t length, unsigned char *out)
+            {
+                const int bpp = PNG_ENCODER_BYTES_PER_PIXEL;
+                out[0] = filter;
+                unsigned char *o = out + 1;
+                switch (filter)
+                {
+                    case PngEncoder::FILTER_SUB:
+                        for (size_t i = 0; i < length; i++)
+                            o[i] = row[i] - (i >= bpp ? row[i - bpp] : 0);
+                        break;
+                    case PngEncoder::FILTER_UP:
+                        for (size_t i = 0; i < length; i++)
+                            o[i] = row[i] - (prev ? prev[i] : 0);
+                        break;
+                    case PngEncoder::FILTER_AVERAGE:
+                        for (size_t i = 0; i < length; i++)
+                            o[i] = row[i] - (((i >= bpp ? row[i - bpp] : 0) + (prev ? prev[i] : 0)) >> 1);
+                        break;
+                    case PngEncoder::FILTER_PAETH:
+                        for (size_t i = 0; i < length; i++)
+                            o[i] = row[i] - paeth(i >= bpp ? row[i - bpp] : 0, prev ? prev[i] : 0, (i >= bpp && prev) ? prev[i - bpp] : 0);
+                        break;
+                    default:
+                        memcpy(o, row, length);
+                        break;
+                }
+            }
+
+            uint64_t filterCost(const unsigned char *filtered, size_t length)
+            {
+                uint64_t cost = 0;
+                for (size_t i = 0; i < length; i++)
+                    cost += (filtered[i] < 128) ? filtered[i] : 256 - filtered[i];
+                return cost;
+            }
+
+            bool compressBand(const unsigned char *pixels, int width, int height, bool bottomUp, const PngEncoder::Options &options,
+                int firstRow, int rows, bool last, Band &band)
+            {
+                const size_t pitch = (size_t)width * PNG_ENCODER_BYTES_PER_PIXEL;
+                std::vector<unsigned char> filtered(rows * (pitch + 1));
+                std::vector<unsigned char> candidate(options.filter == PngEncoder::FILTER_ADAPTIVE ? pitch + 1 : 0);
+
+                for (int y = 0; y < rows; y++)
+                {
+                    int row = firstRow + y;
+                    const unsigned char *current = pixels + (bottomUp ? height - 1 - row : row) * pitch;
+                    const unsigned char *prev = (row > 0) ? pixels + (bottomUp ? height - row : row - 1) * pitch : NULL;
+                    unsigned char *out = &filtered[y * (pitch + 1)];
+
+                    if (options.filter != PngEncoder::FILTER_ADAPTIVE)
+                    {
+                        filterRow(options.filter, current, prev, pitch, out);
+                        continue;
+                    }
+
+                    uint64_t best = UINT64_MAX;
+                    for (int f = PngEncoder::FILTER_NONE; f <= PngEncoder::FILTER_PAETH; f++)
+                    {
+                        filterRow((PngEncoder::Filter)f, current, prev, pitch, &candidate[0]);
+                        uint64_t cost = filterCost(&candidate[1], pitch);
+                        if (cost < best)
+                        {
+                            best = cost;
+                            memcpy(out, &candidate[0], pitch + 1);
+                        }
+                    }
+                }
+
+                band.length = filtered.size();
+                band.adler = adler32(adler32(0, NULL, 0), &filtered[0], filtered.size());
+
+                // raw deflate, the zlib header and checksum are written once for the whole stream
+                z_stream stream;
+                memset(&stream, 0, sizeof(stream));
+                if (Z_OK != deflateInit2(&stream, options.level, Z_DEFLATED, -15, 8,
+                        options.filter == PngEncoder::FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED))
+                    return false;
+
+                band.data.resize(deflateBound(&stream, filtered.size()) + 16);
+                stream.next_in = &filtered[0];
+                stream.avail_in = filtered.size();
+                stream.next_out = &band.data[0];
+                stream.avail_out = band.data.size();
+
+                // a sync flush ends the band on a byte boundary without marking the last block
+                int ret = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+                bool ok = last ? (Z_STREAM_END == ret) : (Z_OK == ret && 0 == stream.avail_in);
+                band.data.resize(stream.total_out);
+                deflateEnd(&stream);
+                return ok;
+            }
+        }
+
+        PngEncoder::Options::Options()
+        : level(Z_DEFAULT_COMPRESSION)
+        , filter(FILTER_ADAPTIVE)
+        , threads(0)
+        , bandRows(32)
+        {
+        }
+
+        bool PngEncoder::filterFromString(const std::string &name, Filter &filter)
+        {
+            static const char *names[] = { "none", "sub", "up", "average", "paeth", "adaptive" };
+            for (int i = FILTER_NONE; i <= FILTER_ADAPTIVE; i++)
+            {
+                if (name == names[i])
+                {
+                    filter = (Filter)i;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool PngEncoder::encode(const unsigned char *pixels, int width, int height, bool bottomUp, const Options &options, const Writer &writer)
+        {
+            if (NULL == pixels || width <= 0 || height <= 0)
+                return false;
+
+            const int bandRows = std::max(options.bandRows, 1);
+            const int bandCount = (height + bandRows - 1) / bandRows;
+            int threads = options.threads > 0 ? options.threads : std::min<int>(std::thread::hardware_concurrency(), PNG_ENCODER_MAX_THREADS);
+            threads = std::max(1, std::min(threads, bandCount));
+            // bands are compressed at most this far ahead of the writer, which bounds the memory
+            const int window = threads * 2;
+
+            std::vector<Band> bands(bandCount);
+            std::mutex mutex;
+            std::condition_variable condition;
+            int nextBand = 0;
+            int written = 0;
+            bool stopped = false;
+
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++)
+            {
+                workers.push_back(std::thread([&]() {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while (true)
+                    {
+                        condition.wait(lock, [&] { return stopped || nextBand >= bandCount || nextBand < written + window; });
+                        if (stopped || nextBand >= bandCount)
+                            break;
+                        int b = nextBand++;
+                        lock.unlock();
+
+                        Band band;
+                        int firstRow = b * bandRows;
+                        bool ok = compressBand(pixels, width, height, bottomUp, options, firstRow, std::min(bandRows, height - firstRow), b == bandCount - 1, band);
+
+                        lock.lock();
+                        bands[b].data.swap(band.data);
+                        bands[b].adler = band.adler;
+                        bands[b].length = band.length;
+                        bands[b].failed = !ok;
+                        bands[b].done = true;
+                        condition.notify_all();
+                    }
+                }));
+            }
+
+            unsigned char header[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+            unsigned char ihdr[13];
+            put32(ihdr, width);
+            put32(ihdr + 4, height);
+            ihdr[8] = 8;                // bit depth
+            ihdr[9] = 6;                // truecolour with alpha
+            ihdr[10] = 0;               // deflate
+            ihdr[11] = 0;               // adaptive filtering
+            ihdr[12] = 0;               // no interlace
+
+            // the zlib header announces the compression level range, window of 32K
+            const int level = (options.level == Z_DEFAULT_COMPRESSION) ? 6 : options.level;
+            unsigned char zlibHeader[2] = { 0x78, (unsigned char)(level < 2 ? 0x01 : level < 6 ? 0x5e : level == 6 ? 0x9c : 0xda) };
+
+            bool ok = writer(header, sizeof(header)) && writeChunk(writer, "IHDR", ihdr, sizeof(ihdr));
+            uLong adler = adler32(0, NULL, 0);
+            for (int b = 0; ok && b < bandCount; b++)
+            {
+                std::vector<unsigned char> data;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    condition.wait(lock, [&] { return bands[b].done; });
+                    if (bands[b].failed)
+                    {
+                        ok = false;
+                        break;
+                    }
+                    data.swap(bands[b].data);
+                    adler = adler32_combine(adler, bands[b].adler, bands[b].length);
+                }
+
+                if (0 == b)
+                    data.insert(data.begin(), zlibHeader, zlibHeader + 2);
+                if (bandCount - 1 == b)
+                {
+                    unsigned char trailer[4];
+                    put32(trailer, adler);
+                    data.insert(data.end(), trailer, trailer + 4);
+                }
+                ok = writeChunk(writer, "IDAT", data.empty() ? NULL : &data[0], data.size());
+
+                std::lock_guard<std::mutex> lock(mutex);
+                written++;
+                condition.notify_all();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopped = true;
+            }
+            condition.notify_all();
+            for (size_t t = 0; t < workers.size(); t++)
+                workers[t].join();
+
+            return ok && writeChunk(writer, "IEND", NULL, 0);
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
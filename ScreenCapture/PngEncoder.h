@@ -0,0 +1,65 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // RGBA png encoder that filters and deflates horizontal bands of the image on several
+        // threads. Every band is an independent run of deflate blocks ending on a byte boundary,
+        // so the bands are concatenated into one zlib stream in order as they complete.
+        class PngEncoder
+        {
+        public:
+            enum Filter
+            {
+                FILTER_NONE = 0,
+                FILTER_SUB,
+                FILTER_UP,
+                FILTER_AVERAGE,
+                FILTER_PAETH,
+                // picks the filter with the smallest sum of absolute differences for every row
+                FILTER_ADAPTIVE
+            };
+
+            struct Options
+            {
+                Options();
+
+                int level;         // zlib compression level, 0 to 9
+                Filter filter;
+                int threads;       // 0 uses every core, up to a limit
+                int bandRows;
+            };
+
+            // receives the encoded file in order, returns false to stop encoding
+            typedef std::function<bool(const unsigned char *data, size_t length)> Writer;
+
+            static bool encode(const unsigned char *pixels, int width, int height, bool bottomUp, const Options &options, const Writer &writer);
+
+            static bool filterFromString(const std::string &name, Filter &filter);
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -18,18 +18,29 @@
 **/
 
 #include "ScreenCapture.h"
+#include "ChunkQueue.h"
+#include "FrameHash.h"
 
 #include "utils.h"
 
+#include <algorithm>
+#include <thread>
+
 #ifdef PLATFORM_BROADCOM
 #include <nexus_config.h>
 #include <nxclient.h>
 #endif
 
-#include <png.h>
 #include <curl/curl.h>
 #include <base64.h>
 
+#if defined(PLATFORM_AMLOGIC)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #ifdef HAS_FRAMEBUFFER_API_HEADER
 extern "C" {
 #include "framebuffer-api.h"
@@ -39,8 +50,19 @@ extern "C" {
 
 #define SCREENCAPTURE_THUNDER_TIMEOUT 20000
 
+// the png is uploaded while it is encoded, at most this much of it is buffered
+#define SCREENCAPTURE_UPLOAD_CHUNK_SIZE (64 * 1024)
+#define SCREENCAPTURE_UPLOAD_MAX_CHUNKS 4
+
+// periodic captures are taken at most this often, in seconds
+#define SCREENCAPTURE_MIN_PERIODIC_INTERVAL 1
+#define SCREENCAPTURE_DEFAULT_PERIODIC_INTERVAL 10
+
 // Methods
 #define METHOD_UPLOAD "uploadScreenCapture"
+#define METHOD_START_PERIODIC_CAPTURE "startPeriodicCapture"
+#define METHOD_STOP_PERIODIC_CAPTURE "stopPeriodicCapture"
+#define METHOD_GET_PERIODIC_CAPTURE_STATUS "getPeriodicCaptureStatus"
 
 // Events
 #define EVT_UPLOAD_COMPLETE "uploadComplete"
@@ -65,6 +87,16 @@ namespace WPEFramework
 
             screenShotDispatcher = new WPEFramework::Core::TimerType<ScreenShotJob>(64 * 1024, "ScreenCaptureDispatcher");
 
+            curl_global_init(CURL_GLOBAL_ALL);
+            m_curl = nullptr;
+
+            m_periodicRunning = false;
+            m_periodicInterval = SCREENCAPTURE_DEFAULT_PERIODIC_INTERVAL;
+            m_lastPngSize = 0;
+            m_periodicCaptured = m_periodicUploaded = m_periodicSkipped = m_periodicFailed = 0;
+            m_periodicBytesUploaded = m_periodicBytesSaved = 0;
+            m_periodicTimer.connect(std::bind(&ScreenCapture::onPeriodicCapture, this));
+
             #ifdef PLATFORM_BROADCOM
             inNexus = false;
             #endif
@@ -75,6 +107,9 @@ namespace WPEFramework
 #endif   
 
             Register(METHOD_UPLOAD, &ScreenCapture::uploadScreenCapture, this);
+            Register(METHOD_START_PERIODIC_CAPTURE, &ScreenCapture::startPeriodicCapture, this);
+            Register(METHOD_STOP_PERIODIC_CAPTURE, &ScreenCapture::stopPeriodicCapture, this);
+            Register(METHOD_GET_PERIODIC_CAPTURE_STATUS, &ScreenCapture::getPeriodicCaptureStatus, this);
         }
 
         ScreenCapture::~ScreenCapture()
@@ -83,15 +118,84 @@ namespace WPEFramework
 
         void ScreenCapture::Deinitialize(PluginHost::IShell* /* service */)
         {
+            {
+                std::lock_guard<std::mutex> guard(m_periodicMutex);
+                m_periodicRunning = false;
+            }
+            m_periodicTimer.stop();
+            //waits for a capture that is already running
+            std::lock_guard<std::mutex> captureGuard(m_periodicCaptureMutex);
+
             ScreenCapture::_instance = nullptr;
 
             delete screenShotDispatcher;
+
+            std::lock_guard<std::mutex> guard(m_uploadMutex);
+            if(m_curl)
+            {
+                curl_easy_cleanup(m_curl);
+                m_curl = nullptr;
+            }
         }
 
 #if defined(PLATFORM_AMLOGIC)
         void ScreenCapture::pluginEventHandler(const JsonObject& parameters)
         {
-            if (parameters.HasLabel("imageData"))
+            // RDKShell sends one event per requested format, to every subscriber, only the formats
+            // requested by this plugin are handled. RDKShell versions without formats send none.
+            bool periodic = false;
+            {
+                std::lock_guard<std::mutex> guard(m_pendingMutex);
+                std::deque<PendingCapture>::iterator it = m_pendingRDKShellCaptures.begin();
+                if (parameters.HasLabel("format"))
+                {
+                    const std::string format = parameters["format"].String();
+                    while (it != m_pendingRDKShellCaptures.end() && it->format != format)
+                        ++it;
+                }
+                if (it == m_pendingRDKShellCaptures.end())
+                    return;
+
+                periodic = it->periodic;
+                m_pendingRDKShellCaptures.erase(it);
+            }
+
+            // RDKShell reads the screen back bottom row first, the rows are flipped while encoding
+            if (parameters.HasLabel("shmName"))
+            {
+                std::string shmName = parameters["shmName"].String();
+                size_t width = parameters.HasLabel("width") ? parameters["width"].Number() : screenWidth;
+                size_t height = parameters.HasLabel("height") ? parameters["height"].Number() : screenHeight;
+                size_t imageSize = width * height * 4;
+
+                int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+                if (fd < 0)
+                {
+                    LOGERR("Failed to open screen capture segment %s", shmName.c_str());
+                    doUploadScreenCapture(NULL, 0, 0, false, false, periodic);
+                    return;
+                }
+                // the segment is only needed by this capture, it goes away with the mapping
+                shm_unlink(shmName.c_str());
+
+                struct stat segmentStat;
+                void *image = MAP_FAILED;
+                if (fstat(fd, &segmentStat) == 0 && (size_t)segmentStat.st_size == imageSize)
+                    image = mmap(NULL, imageSize, PROT_READ, MAP_SHARED, fd, 0);
+                else
+                    LOGERR("Got wrong segment size for screen capture, expected %zu", imageSize);
+                close(fd);
+
+                if (MAP_FAILED == image)
+                {
+                    doUploadScreenCapture(NULL, 0, 0, false, false, periodic);
+                    return;
+                }
+
+                doUploadScreenCapture((const unsigned char *)image, width, height, true, true, periodic);
+                munmap(image, imageSize);
+            }
+            else if (parameters.HasLabel("imageData"))
             {
                 std::string imageData = parameters["imageData"].String();
 
@@ -99,40 +203,74 @@ namespace WPEFramework
 
                 if(screenWidth * screenHeight * 4 != decodedImageSize)
                 {
-                    LOGERR("Got wrong data size for screen capture, %d instead of %d", decodedImageSize, screenWidth * screenHeight * 4);
+                    LOGERR("Got wrong data size for screen capture, %zu instead of %zu", decodedImageSize, screenWidth * screenHeight * 4);
+                    doUploadScreenCapture(NULL, 0, 0, false, false, periodic);
                     return;
                 }
 
                 uint8_t *decodedImage = (uint8_t*)malloc(decodedImageSize);
                 b64_decode((const uint8_t*) imageData.c_str(), imageData.size(), decodedImage);
 
-                // flip the image
-                uint32_t *decodedImageRGBA = (uint32_t *)decodedImage;
-                for(size_t row = 0; row < screenHeight / 2; row++)
-                {
-                    for(size_t col = 0; col < screenWidth; col++)
-                    {
-                        uint32_t p = decodedImageRGBA[row * screenWidth + col];
+                doUploadScreenCapture(decodedImage, screenWidth, screenHeight, true, true, periodic);
+                free(decodedImage);
+            }
+            else
+            {
+                LOGERR("Got screen capture without image");
+                doUploadScreenCapture(NULL, 0, 0, false, false, periodic);
+            }
+        }
+#endif
 
-                        decodedImageRGBA[row * screenWidth + col] = decodedImageRGBA[(screenHeight - 1 - row) * screenWidth + col];
-                        decodedImageRGBA[(screenHeight - 1 - row) * screenWidth + col] = p;
-                    }
-                }
+        bool ScreenCapture::parseCaptureOptions(const JsonObject& parameters, CaptureOptions &options, std::string &error_str)
+        {
+            options = CaptureOptions();
 
-                std::vector<unsigned char> png_out_data;
-                if(!saveToPng((unsigned char *)decodedImage, screenWidth, screenHeight, png_out_data))
+            if(parameters.HasLabel("compressionLevel"))
+            {
+                int level = parameters["compressionLevel"].Number();
+                if(level < 0 || level > 9)
                 {
-                    LOGERR("Failed to convert ScreenShot data to png");
-                    return;
+                    error_str = "compressionLevel has to be between 0 and 9";
+                    return false;
                 }
+                options.png.level = level;
+            }
 
-                free(decodedImage);
+            if(parameters.HasLabel("filter") && !PngEncoder::filterFromString(parameters["filter"].String(), options.png.filter))
+            {
+                error_str = "Unsupported filter, use none, sub, up, average, paeth or adaptive";
+                return false;
+            }
 
-                doUploadScreenCapture(png_out_data, true);
+            if(parameters.HasLabel("rect"))
+            {
+                JsonObject rect = parameters["rect"].Object();
+                options.rect.x = rect["x"].Number();
+                options.rect.y = rect["y"].Number();
+                options.rect.w = rect["w"].Number();
+                options.rect.h = rect["h"].Number();
+                if(options.rect.x < 0 || options.rect.y < 0 || options.rect.w <= 0 || options.rect.h <= 0)
+                {
+                    error_str = "rect needs x and y of at least 0 and positive w and h";
+                    return false;
+                }
             }
 
+            if(parameters.HasLabel("scale"))
+            {
+                JsonObject scale = parameters["scale"].Object();
+                options.scaleWidth = scale["w"].Number();
+                options.scaleHeight = scale["h"].Number();
+                if(options.scaleWidth <= 0 || options.scaleHeight <= 0)
+                {
+                    error_str = "scale needs positive w and h";
+                    return false;
+                }
+            }
+
+            return true;
         }
-#endif
 
         uint32_t ScreenCapture::uploadScreenCapture(const JsonObject& parameters, JsonObject& response)
         {
@@ -151,9 +289,27 @@ namespace WPEFramework
 
             if(parameters.HasLabel("callGUID"))
               callGUID = parameters["callGUID"].String();
+
+            std::string error_str;
+            if(!parseCaptureOptions(parameters, m_captureOptions, error_str))
+            {
+                response["message"] = error_str;
+
+                returnResponse(false);
+            }
               
 #if defined(PLATFORM_AMLOGIC)
+            requestRDKShellScreenshot(false);
+#else
+            screenShotDispatcher->Schedule( Core::Time::Now().Add(0), ScreenShotJob( this) );
+#endif
 
+            returnResponse(true);
+        }
+
+#if defined(PLATFORM_AMLOGIC)
+        bool ScreenCapture::requestRDKShellScreenshot(bool periodic)
+        {
             if (nullptr == gRSKShellConnection)
             {
                 std::string serviceCallsign = "org.rdk.RDKShell";
@@ -161,7 +317,7 @@ namespace WPEFramework
                 gRSKShellConnection = Utils::getThunderControllerClient(serviceCallsign);
             }
 
-            if (nullptr != gRSKShellConnection)
+            if (nullptr != gRSKShellConnection && !gRDKSHellEventSubscribed)
             {
                 int32_t status = Core::ERROR_GENERAL;
                 std::string eventName("onScreenshotComplete");
@@ -172,34 +328,193 @@ namespace WPEFramework
                 else
                     LOGERR("Failed to Subscribe for %s", eventName.c_str());
             }
-            else
+            else if (nullptr == gRSKShellConnection)
                 LOGERR("Failed to establish connection to RSKShell");
 
-            if(gRDKSHellEventSubscribed)
-            {
-                JsonObject req, res;
+            if(!gRDKSHellEventSubscribed)
+                return false;
 
-                int32_t status = gRSKShellConnection->Invoke(SCREENCAPTURE_THUNDER_TIMEOUT, "getScreenResolution", req, res);
-                if(Core::ERROR_NONE == status)
+            JsonObject req, res;
+
+            int32_t status = gRSKShellConnection->Invoke(SCREENCAPTURE_THUNDER_TIMEOUT, "getScreenResolution", req, res);
+            if(Core::ERROR_NONE == status)
+            {
+                if(res.HasLabel("w") && res.HasLabel("h"))
                 {
-                    if(res.HasLabel("w") && res.HasLabel("h"))
-                    {
-                        screenWidth = std::stoi(res["w"].String());
-                        screenHeight = std::stoi(res["h"].String());
-                    }
+                    screenWidth = std::stoi(res["w"].String());
+                    screenHeight = std::stoi(res["h"].String());
                 }
+            }
 
+            // ask for the pixels in shared memory, RDKShell versions without it only support base64
+            std::string format = "shm";
+            addPendingCapture(format, periodic);
+            JsonObject shmReq;
+            shmReq["format"] = format;
+            status = gRSKShellConnection->Invoke(SCREENCAPTURE_THUNDER_TIMEOUT, "getScreenshot", shmReq, res);
+            if(Core::ERROR_NONE != status || !res.HasLabel("success") || !res["success"].Boolean())
+            {
+                removePendingCapture(format, periodic);
+                format = "raw";
+                addPendingCapture(format, periodic);
                 status = gRSKShellConnection->Invoke(SCREENCAPTURE_THUNDER_TIMEOUT, "getScreenshot", req, res);
-                if(Core::ERROR_NONE != status)
-                    LOGERR("Failed to call getScreenshot: %d", status);
             }
-#else
-            screenShotDispatcher->Schedule( Core::Time::Now().Add(0), ScreenShotJob( this) );
+            if(Core::ERROR_NONE != status)
+            {
+                LOGERR("Failed to call getScreenshot: %d", status);
+
+                // no event follows, the request is forgotten
+                removePendingCapture(format, periodic);
+                return false;
+            }
+
+            return true;
+        }
+
+        void ScreenCapture::addPendingCapture(const std::string &format, bool periodic)
+        {
+            std::lock_guard<std::mutex> guard(m_pendingMutex);
+            PendingCapture pending = { format, periodic };
+            m_pendingRDKShellCaptures.push_back(pending);
+        }
+
+        void ScreenCapture::removePendingCapture(const std::string &format, bool periodic)
+        {
+            std::lock_guard<std::mutex> guard(m_pendingMutex);
+            for(std::deque<PendingCapture>::reverse_iterator it = m_pendingRDKShellCaptures.rbegin(); it != m_pendingRDKShellCaptures.rend(); ++it)
+            {
+                if(it->format == format && it->periodic == periodic)
+                {
+                    m_pendingRDKShellCaptures.erase(std::next(it).base());
+                    break;
+                }
+            }
+        }
 #endif
 
+        uint32_t ScreenCapture::startPeriodicCapture(const JsonObject& parameters, JsonObject& response)
+        {
+            std::lock_guard<std::mutex> guard(m_callMutex);
+
+            LOGINFOMETHOD();
+
+            if(!parameters.HasLabel("url"))
+            {
+                response["message"] = "Upload url is not specified";
+
+                returnResponse(false);
+            }
+
+            int interval = SCREENCAPTURE_DEFAULT_PERIODIC_INTERVAL;
+            if(parameters.HasLabel("interval"))
+            {
+                interval = parameters["interval"].Number();
+                if(interval < SCREENCAPTURE_MIN_PERIODIC_INTERVAL)
+                {
+                    response["message"] = "interval has to be at least " + std::to_string(SCREENCAPTURE_MIN_PERIODIC_INTERVAL) + " second";
+
+                    returnResponse(false);
+                }
+            }
+
+            CaptureOptions options;
+            std::string error_str;
+            if(!parseCaptureOptions(parameters, options, error_str))
+            {
+                response["message"] = error_str;
+
+                returnResponse(false);
+            }
+
+            m_periodicTimer.stop();
+
+            {
+                std::lock_guard<std::mutex> periodicGuard(m_periodicMutex);
+                m_periodicRunning = true;
+                m_periodicInterval = interval;
+                m_periodicUrl = parameters["url"].String();
+                m_periodicCallGUID = parameters.HasLabel("callGUID") ? parameters["callGUID"].String() : std::string();
+                m_periodicOptions = options;
+                // restarted captures begin with a full upload and new statistics
+                m_lastFrameHash.clear();
+                m_lastPngSize = 0;
+                m_periodicCaptured = m_periodicUploaded = m_periodicSkipped = m_periodicFailed = 0;
+                m_periodicBytesUploaded = m_periodicBytesSaved = 0;
+            }
+
+            m_periodicTimer.setInterval(interval * 1000);
+            m_periodicTimer.start();
+
+            returnResponse(true);
+        }
+
+        uint32_t ScreenCapture::stopPeriodicCapture(const JsonObject& parameters, JsonObject& response)
+        {
+            std::lock_guard<std::mutex> guard(m_callMutex);
+
+            LOGINFOMETHOD();
+
+            {
+                std::lock_guard<std::mutex> periodicGuard(m_periodicMutex);
+                m_periodicRunning = false;
+            }
+            m_periodicTimer.stop();
+
+            getPeriodicCaptureStats(response);
+
             returnResponse(true);
         }
 
+        uint32_t ScreenCapture::getPeriodicCaptureStatus(const JsonObject& parameters, JsonObject& response)
+        {
+            LOGINFOMETHOD();
+
+            getPeriodicCaptureStats(response);
+
+            returnResponse(true);
+        }
+
+        void ScreenCapture::getPeriodicCaptureStats(JsonObject& response)
+        {
+            std::lock_guard<std::mutex> guard(m_periodicMutex);
+
+            response["running"] = m_periodicRunning;
+            response["interval"] = m_periodicInterval;
+            response["captured"] = m_periodicCaptured;
+            response["uploaded"] = m_periodicUploaded;
+            response["skipped"] = m_periodicSkipped;
+            response["failed"] = m_periodicFailed;
+            response["bytesUploaded"] = m_periodicBytesUploaded;
+            response["bytesSaved"] = m_periodicBytesSaved;
+        }
+
+        void ScreenCapture::onPeriodicCapture()
+        {
+            // runs on the timer thread, the next capture is only scheduled after this one returned
+            std::lock_guard<std::mutex> guard(m_periodicCaptureMutex);
+
+            {
+                std::lock_guard<std::mutex> periodicGuard(m_periodicMutex);
+                if(!m_periodicRunning)
+                    return;
+            }
+
+#if defined(PLATFORM_AMLOGIC)
+            {
+                // a screenshot RDKShell did not deliver yet is not asked for again
+                std::lock_guard<std::mutex> pendingGuard(m_pendingMutex);
+                for(std::deque<PendingCapture>::const_iterator it = m_pendingRDKShellCaptures.begin(); it != m_pendingRDKShellCaptures.end(); ++it)
+                {
+                    if(it->periodic)
+                        return;
+                }
+            }
+            requestRDKShellScreenshot(true);
+#else
+            getScreenShot(true);
+#endif
+        }
+
         uint64_t ScreenShotJob::Timed(const uint64_t scheduledTime)
         {
             if(!m_screenCapture)
@@ -208,45 +523,165 @@ namespace WPEFramework
                 return 0;
             }
 
-            m_screenCapture->getScreenShot();
+            m_screenCapture->getScreenShot(false);
 
             return 0;
         }
 
-        bool ScreenCapture::getScreenShot()
+        bool ScreenCapture::getScreenShot(bool periodic)
         {
-            std::vector<unsigned char> png_data;
+            std::vector<unsigned char> pixels;
+            int width = 0;
+            int height = 0;
             bool got_screenshot = false;
 
             #ifdef PLATFORM_BROADCOM
-            got_screenshot = getScreenshotNexus(png_data);
+            got_screenshot = getScreenshotNexus(pixels, width, height);
             #endif
 
             #ifdef PLATFORM_INTEL
-            got_screenshot = getScreenshotIntel(png_data);
+            got_screenshot = getScreenshotIntel(pixels, width, height);
             #endif
 
             #ifdef HAS_FRAMEBUFFER_API_HEADER
-            got_screenshot = getScreenshotRealtek(png_data);
+            got_screenshot = getScreenshotRealtek(pixels, width, height);
             #endif
 
-            doUploadScreenCapture(png_data, got_screenshot);
+            return doUploadScreenCapture(pixels.empty() ? NULL : &pixels[0], width, height, false, got_screenshot, periodic);
         }
 
-        bool ScreenCapture::doUploadScreenCapture(const std::vector<unsigned char> &png_data, bool got_screenshot)
+        bool ScreenCapture::transformCapture(const unsigned char *&pixels, int &width, int &height, bool &bottom_up,
+            const CaptureOptions &options, std::vector<unsigned char> &buffer, std::string &error_str)
         {
+            ImageScaler::Rect rect = { 0, 0, width, height };
+            if(options.rect.w > 0)
+            {
+                // the part of the rect outside of the screen is left out
+                rect = options.rect;
+                rect.w = std::min(rect.w, width - rect.x);
+                rect.h = std::min(rect.h, height - rect.y);
+                if(rect.w <= 0 || rect.h <= 0)
+                {
+                    error_str = "rect is outside of the screen";
+                    return false;
+                }
+            }
+
+            // only downscaled, a larger size keeps the size of the rect
+            int out_width = options.scaleWidth > 0 ? std::min(options.scaleWidth, rect.w) : rect.w;
+            int out_height = options.scaleHeight > 0 ? std::min(options.scaleHeight, rect.h) : rect.h;
+
+            if(out_width == width && out_height == height)
+                return true;
+
+            if(!ImageScaler::transform(pixels, width, height, bottom_up, rect, out_width, out_height, buffer))
+            {
+                error_str = "could not scale the capture";
+                return false;
+            }
+
+            pixels = &buffer[0];
+            width = out_width;
+            height = out_height;
+            bottom_up = false;
+            return true;
+        }
+
+        bool ScreenCapture::doUploadScreenCapture(const unsigned char *pixels, int width, int height, bool bottom_up, bool got_screenshot, bool periodic)
+        {
+            std::string upload_url;
+            std::string call_guid;
+            CaptureOptions options;
+
+            if(periodic)
+            {
+                std::lock_guard<std::mutex> guard(m_periodicMutex);
+                // a capture that was requested before the periodic captures were stopped
+                if(!m_periodicRunning)
+                    return false;
+                upload_url = m_periodicUrl;
+                call_guid = m_periodicCallGUID;
+                options = m_periodicOptions;
+                m_periodicCaptured++;
+            }
+            else
+            {
+                upload_url = url;
+                call_guid = callGUID;
+                options = m_captureOptions;
+            }
+
             if(got_screenshot)
             {
                 std::string error_str;
+                std::vector<unsigned char> transformed;
 
-                LOGWARN("uploading %d of png data to '%s'", png_data.size(), url.c_str() );
+                if(!transformCapture(pixels, width, height, bottom_up, options, transformed, error_str))
+                {
+                    LOGERR("Error: %s", error_str.c_str());
 
-                if(uploadDataToUrl(png_data, url.c_str(), error_str))
+                    if(periodic)
+                    {
+                        std::lock_guard<std::mutex> guard(m_periodicMutex);
+                        m_periodicFailed++;
+                    }
+
+                    JsonObject params;
+                    params["status"] = false;
+                    params["message"] = std::string("Failed to get screen data: ") + error_str;
+                    params["call_guid"] = call_guid;
+
+                    sendNotify(EVT_UPLOAD_COMPLETE, params);
+
+                    return false;
+                }
+
+                if(periodic)
+                {
+                    // hashed after scaling, so that changes too small to be seen in the upload are ignored
+                    std::vector<uint64_t> frame_hash;
+                    FrameHash::compute(pixels, width, height, frame_hash);
+
+                    std::lock_guard<std::mutex> guard(m_periodicMutex);
+                    bool unchanged = !m_lastFrameHash.empty() && FrameHash::changedBlocks(m_lastFrameHash, frame_hash) == 0;
+                    m_lastFrameHash.swap(frame_hash);
+                    if(unchanged)
+                    {
+                        // the same png as the last upload would have been sent again
+                        m_periodicSkipped++;
+                        m_periodicBytesSaved += m_lastPngSize;
+                        return true;
+                    }
+                }
+
+                LOGWARN("uploading %dx%d screen capture to '%s'", width, height, upload_url.c_str() );
+
+                size_t png_size = 0;
+                bool uploaded = uploadPngToUrl(pixels, width, height, bottom_up, upload_url.c_str(), options.png, png_size, error_str);
+
+                if(periodic)
+                {
+                    std::lock_guard<std::mutex> guard(m_periodicMutex);
+                    if(uploaded)
+                    {
+                        m_periodicUploaded++;
+                        m_periodicBytesUploaded += png_size;
+                        m_lastPngSize = png_size;
+                    }
+                    else
+                    {
+                        // the next frame is uploaded even when it did not change
+                        m_periodicFailed++;
+                        m_lastFrameHash.clear();
+                    }
+                }
+
+                if(uploaded)
                 {
                     JsonObject params;
                     params["status"] = true;
                     params["message"] = "Success";
-                    params["call_guid"] = callGUID;
+                    params["call_guid"] = call_guid;
 
                     sendNotify(EVT_UPLOAD_COMPLETE, params);
 
@@ -257,7 +692,7 @@ namespace WPEFramework
                     JsonObject params;
                     params["status"] = false;
                     params["message"] = std::string("Upload Failed: ") + error_str;
-                    params["call_guid"] = callGUID;
+                    params["call_guid"] = call_guid;
 
                     sendNotify(EVT_UPLOAD_COMPLETE, params);
 
@@ -268,10 +703,16 @@ namespace WPEFramework
             {
                 LOGERR("Error: could not get the screenshot");
 
+                if(periodic)
+                {
+                    std::lock_guard<std::mutex> guard(m_periodicMutex);
+                    m_periodicFailed++;
+                }
+
                 JsonObject params;
                 params["status"] = false;
                 params["message"] = "Failed to get screen data";
-                params["call_guid"] = callGUID;
+                params["call_guid"] = call_guid;
 
                 sendNotify(EVT_UPLOAD_COMPLETE, params);
 
@@ -280,7 +721,7 @@ namespace WPEFramework
         }
 
 #ifdef PLATFORM_INTEL
-        bool ScreenCapture::getScreenshotIntel(std::vector<unsigned char> &png_out_data)
+        bool ScreenCapture::getScreenshotIntel(std::vector<unsigned char> &pixels, int &width, int &height)
         {
             int i;
             char *filename = "/proc/gdl/dump/wbp";    //both video and guide graphics, potentially at lower 720x480
@@ -313,10 +754,10 @@ namespace WPEFramework
             }
 
             std::vector<unsigned char> data_v(size);
-            std::vector<unsigned char> new_data_v(size);
+            pixels.resize(size);
 
             unsigned char* data = &data_v[0];
-            unsigned char* new_data = &new_data_v[0];
+            unsigned char* new_data = &pixels[0];
 
             fread(data, sizeof(unsigned char), size, fp); // read the rest of the data at once
             fclose(fp);
@@ -330,8 +771,8 @@ namespace WPEFramework
                 new_data[i+3] = data[i+3];
             }
 
-            //convert to png
-            saveToPng(new_data, w, h, png_out_data);
+            width = w;
+            height = h;
 
             return true;
         }
@@ -363,7 +804,7 @@ namespace WPEFramework
             return true;
         }
 
-        bool ScreenCapture::getScreenshotNexus(std::vector<unsigned char> &png_out_data)
+        bool ScreenCapture::getScreenshotNexus(std::vector<unsigned char> &pixels, int &width, int &height)
         {
             if(!joinNexus())
             {
@@ -395,8 +836,8 @@ namespace WPEFramework
             //defSurfSettings.pixelFormat = NEXUS_PixelFormat_eA8_R8_G8_B8;
             defSurfSettings.pixelFormat = NEXUS_PixelFormat_eA8_B8_G8_R8;
             int bytesPerPixel = 4;
-            std::vector<unsigned char> data_v(1280 * 720 * 4);
-            unsigned char *bytes = &data_v[0];
+            pixels.resize(1280 * 720 * 4);
+            unsigned char *bytes = &pixels[0];
 //             unsigned char bytes[1280 * 720 * 4];
 
 
@@ -444,13 +885,10 @@ namespace WPEFramework
                 return false;
             }
 
-            if(!saveToPng(bytes, defSurfSettings.width, defSurfSettings.height, png_out_data))
-            {
-                LOGERR("could not convert Nexus screenshot to png");
-                return false;
-            }
-            else
-                return true;
+            width = defSurfSettings.width;
+            height = defSurfSettings.height;
+
+            return true;
         }
 #endif
 
@@ -472,7 +910,7 @@ namespace WPEFramework
             LOGWARN("VNCServerLogMessage called");
         }
 
-        bool ScreenCapture::getScreenshotRealtek(std::vector<unsigned char> &png_out_data)
+        bool ScreenCapture::getScreenshotRealtek(std::vector<unsigned char> &pixels, int &width, int &height)
         {
             ErrCode err;
             vnc_bool_t result;
@@ -532,24 +970,23 @@ namespace WPEFramework
             if(buffer) {
                 LOGINFO("fbGetFramebuffer=ok"); 
 
+                // copied out of the framebuffer, which is left untouched, with red and blue swapped
+                pixels.resize(w * h * 4);
                 for(unsigned int n = 0; n < h; n++)
                 {
                     for(unsigned int i = 0; i < w; i++)
                     {
-                        unsigned char *color = buffer + n * s + i * 4;
+                        const unsigned char *color = buffer + n * s + i * 4;
+                        unsigned char *pixel = &pixels[(n * w + i) * 4];
 
-                        unsigned char blue = color[0];
-                        color[0] =  color[2];
-                        color[2] = blue;
+                        pixel[0] = color[2];
+                        pixel[1] = color[1];
+                        pixel[2] = color[0];
+                        pixel[3] = color[3];
                     }
                 }
-
-                if(!saveToPng(buffer, w, h, png_out_data))
-                {
-                    LOGERR("could not convert Nexus screenshot to png");
-                    fbDestroy(context);
-                    return false;
-                }
+                width = w;
+                height = h;
                 LOGINFO("[Done]");
 
             } else {
@@ -566,15 +1003,18 @@ namespace WPEFramework
         }
 #endif
 
-        static void PngWriteCallback(png_structp  png_ptr, png_bytep data, png_size_t length)
+        static size_t ChunkQueueReadCallback(char *buffer, size_t size, size_t nitems, void *userdata)
         {
-            std::vector<unsigned char> *p = (std::vector<unsigned char>*)png_get_io_ptr(png_ptr);
-            p->insert(p->end(), data, data + length);
+            ChunkQueue *p = (ChunkQueue*)userdata;
+            size_t length = 0;
+            if(!p->read((unsigned char *)buffer, size * nitems, length))
+                return CURL_READFUNC_ABORT;
+            return length;
         }
 
-        bool ScreenCapture::uploadDataToUrl(const std::vector<unsigned char> &data, const char *url, std::string &error_str)
+        bool ScreenCapture::uploadPngToUrl(const unsigned char *pixels, int width, int height, bool bottom_up, const char *url,
+            const PngEncoder::Options &png_options, size_t &png_size, std::string &error_str)
         {
-            CURL *curl;
             CURLcode res;
             bool call_succeeded = true;
 
@@ -584,37 +1024,64 @@ namespace WPEFramework
                 return false;
             }
 
-            LOGWARN("uploading png data of size %u to '%s'", data.size(), url);
+            std::lock_guard<std::mutex> guard(m_uploadMutex);
 
-            //init curl
-            curl_global_init(CURL_GLOBAL_ALL);
-            curl = curl_easy_init();
+            //the handle is kept between uploads so that its connection can be reused
+            if(!m_curl)
+                m_curl = curl_easy_init();
+            else
+                curl_easy_reset(m_curl);
 
-            if(!curl)
+            if(!m_curl)
             {
                 LOGERR("could not init curl\n");
+                error_str = "could not init curl";
                 return false;
             }
 
+            //encode on a separate thread, the upload below sends every chunk as soon as it is ready
+            ChunkQueue png_queue(SCREENCAPTURE_UPLOAD_CHUNK_SIZE, SCREENCAPTURE_UPLOAD_MAX_CHUNKS);
+            bool encoded = false;
+            png_size = 0;
+            std::thread encoder([&]() {
+                encoded = PngEncoder::encode(pixels, width, height, bottom_up, png_options, [&png_queue, &png_size](const unsigned char *data, size_t length) {
+                    png_size += length;
+                    return png_queue.write(data, length);
+                });
+                png_queue.finish(encoded);
+            });
+
             //create header
             struct curl_slist *chunk = NULL;
             chunk = curl_slist_append(chunk, "Content-Type: image/png");
+            chunk = curl_slist_append(chunk, "Transfer-Encoding: chunked");
 
             //set url and data
-            curl_easy_setopt(curl, CURLOPT_URL, url);
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, chunk);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.size());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, &data[0]);
+            curl_easy_setopt(m_curl, CURLOPT_URL, url);
+            curl_easy_setopt(m_curl, CURLOPT_HTTPHEADER, chunk);
+            curl_easy_setopt(m_curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(m_curl, CURLOPT_READFUNCTION, ChunkQueueReadCallback);
+            curl_easy_setopt(m_curl, CURLOPT_READDATA, &png_queue);
 
             //perform blocking upload call
-            res = curl_easy_perform(curl);
+            res = curl_easy_perform(m_curl);
+
+            //unblocks the encoder when the upload stopped before reading everything
+            png_queue.cancel();
+            encoder.join();
 
             //output success / failure log
-            if(CURLE_OK == res)
+            if(!encoded)
+            {
+                LOGERR("png encoding failed");
+                error_str = "png encoding failed";
+                call_succeeded = false;
+            }
+            else if(CURLE_OK == res)
             {
                 long response_code;
 
-                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+                curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &response_code);
 
                 if(600 > response_code && response_code >= 400)
                 {
@@ -632,98 +1099,11 @@ namespace WPEFramework
                 call_succeeded = false;
             }
 
-            //clean up curl object
-            curl_easy_cleanup(curl);
+            //the handle itself is kept, only the header list goes
             curl_slist_free_all(chunk);
 
             return call_succeeded;
         }
 
-        bool ScreenCapture::saveToPng(unsigned char *data, int width, int height, std::vector<unsigned char> &png_out_data)
-        {
-            int bitdepth = 8;
-            int colortype = PNG_COLOR_TYPE_RGBA;
-            int pitch = 4 * width;
-            int transform = PNG_TRANSFORM_IDENTITY;
-
-            int i = 0;
-            int r = 0;
-            png_structp png_ptr = NULL;
-            png_infop info_ptr = NULL;
-            png_bytep* row_pointers = NULL;
-
-            if (NULL == data)
-            {
-                LOGERR("Error: failed to save the png because the given data is NULL.");
-                r = -1;
-                goto error;
-            }
-
-            if (0 == pitch)
-            {
-                LOGERR("Error: failed to save the png because the given pitch is 0.");
-                r = -3;
-                goto error;
-            }
-
-            png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-            if (NULL == png_ptr)
-            {
-                LOGERR("Error: failed to create the png write struct.");
-                r = -5;
-                goto error;
-            }
-
-            info_ptr = png_create_info_struct(png_ptr);
-            if (NULL == info_ptr)
-            {
-                LOGERR("Error: failed to create the png info struct.");
-                r = -6;
-                goto error;
-            }
-
-            png_set_IHDR(png_ptr,
-                            info_ptr,
-                            width,
-                            height,
-                            bitdepth,                 /* e.g. 8 */
-                            colortype,                /* PNG_COLOR_TYPE_{GRAY, PALETTE, RGB, RGB_ALPHA, GRAY_ALPHA, RGBA, GA} */
-                            PNG_INTERLACE_NONE,       /* PNG_INTERLACE_{NONE, ADAM7 } */
-                            PNG_COMPRESSION_TYPE_BASE,
-                            PNG_FILTER_TYPE_BASE);
-
-            row_pointers = (png_bytep*)malloc(sizeof(png_bytep) * height);
-
-            for (i = 0; i < height; ++i)
-                row_pointers[i] = data + i * pitch;
-
-            png_set_write_fn(png_ptr, &png_out_data, PngWriteCallback, NULL);
-            png_set_rows(png_ptr, info_ptr, row_pointers);
-            png_write_png(png_ptr, info_ptr, transform, NULL);
-
-            error:
-
-            if (NULL != png_ptr)
-            {
-
-                if (NULL == info_ptr)
-                {
-                    LOGERR("Error: info ptr is null. not supposed to happen here.\n");
-                }
-
-                png_destroy_write_struct(&png_ptr, &info_ptr);
-                png_ptr = NULL;
-                info_ptr = NULL;
-            }
-
-            if (NULL != row_pointers)
-            {
-                free(row_pointers);
-                row_pointers = NULL;
-            }
-
-            return (r==0);
-        }
-
     } // namespace Plugin
 } // namespace WPEFramework
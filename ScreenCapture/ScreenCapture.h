@@ -19,10 +19,13 @@
 
 #pragma once
 
+#include <deque>
 #include <mutex>
 #include <vector>
 
 #include "Module.h"
+#include "PngEncoder.h"
+#include "ImageScaler.h"
 #include "tptimer.h"
 #include "utils.h"
 #include "AbstractPlugin.h"
@@ -78,27 +81,49 @@ namespace WPEFramework {
 #if defined(PLATFORM_AMLOGIC)
             void pluginEventHandler(const JsonObject& parameters);
 #endif
+            struct CaptureOptions
+            {
+                CaptureOptions() : scaleWidth(0), scaleHeight(0) { rect.x = rect.y = rect.w = rect.h = 0; }
+
+                PngEncoder::Options png;
+                ImageScaler::Rect rect;    // w of 0 captures the whole screen
+                int scaleWidth;            // 0 keeps the size
+                int scaleHeight;
+            };
+
             //Begin methods
             uint32_t uploadScreenCapture(const JsonObject& parameters, JsonObject& response);
+            uint32_t startPeriodicCapture(const JsonObject& parameters, JsonObject& response);
+            uint32_t stopPeriodicCapture(const JsonObject& parameters, JsonObject& response);
+            uint32_t getPeriodicCaptureStatus(const JsonObject& parameters, JsonObject& response);
             //End methods
 
+            // the platform captures fill in RGBA pixels, top row first
             #ifdef PLATFORM_BROADCOM
-            bool getScreenshotNexus(std::vector<unsigned char> &png_data);
+            bool getScreenshotNexus(std::vector<unsigned char> &pixels, int &width, int &height);
             bool joinNexus();
             #endif
 
             #ifdef PLATFORM_INTEL
-            bool getScreenshotIntel(std::vector<unsigned char> &png_data);
+            bool getScreenshotIntel(std::vector<unsigned char> &pixels, int &width, int &height);
             #endif
 
             #ifdef HAS_FRAMEBUFFER_API_HEADER
-            bool getScreenshotRealtek(std::vector<unsigned char> &png_data);
+            bool getScreenshotRealtek(std::vector<unsigned char> &pixels, int &width, int &height);
             #endif
 
-            bool saveToPng(unsigned char *bytes, int w, int h, std::vector<unsigned char> &png_out_data);
-            bool uploadDataToUrl(const std::vector<unsigned char> &data, const char *url, std::string &error_str);
-            bool getScreenShot();
-            bool doUploadScreenCapture(const std::vector<unsigned char> &png_data, bool got_screenshot);
+            static bool parseCaptureOptions(const JsonObject& parameters, CaptureOptions &options, std::string &error_str);
+            static bool transformCapture(const unsigned char *&pixels, int &width, int &height, bool &bottom_up,
+                const CaptureOptions &options, std::vector<unsigned char> &buffer, std::string &error_str);
+            bool uploadPngToUrl(const unsigned char *pixels, int width, int height, bool bottom_up, const char *url,
+                const PngEncoder::Options &png_options, size_t &png_size, std::string &error_str);
+            bool getScreenShot(bool periodic);
+            bool doUploadScreenCapture(const unsigned char *pixels, int width, int height, bool bottom_up, bool got_screenshot, bool periodic);
+            void onPeriodicCapture();
+            void getPeriodicCaptureStats(JsonObject& response);
+#if defined(PLATFORM_AMLOGIC)
+            bool requestRDKShellScreenshot(bool periodic);
+#endif
 
         public:
             ScreenCapture();
@@ -109,11 +134,32 @@ namespace WPEFramework {
             static ScreenCapture* _instance;
         private:
             std::mutex m_callMutex;
+            std::mutex m_uploadMutex;
+            void *m_curl;
 
             WPEFramework::Core::TimerType<ScreenShotJob> *screenShotDispatcher;
 
             std::string url;
             std::string callGUID;
+            CaptureOptions m_captureOptions;
+
+            // periodic captures, a frame whose block hashes match the previous one is not uploaded
+            TpTimer m_periodicTimer;
+            std::mutex m_periodicMutex;
+            std::mutex m_periodicCaptureMutex;
+            bool m_periodicRunning;
+            int m_periodicInterval;
+            std::string m_periodicUrl;
+            std::string m_periodicCallGUID;
+            CaptureOptions m_periodicOptions;
+            std::vector<uint64_t> m_lastFrameHash;
+            size_t m_lastPngSize;
+            uint32_t m_periodicCaptured;
+            uint32_t m_periodicUploaded;
+            uint32_t m_periodicSkipped;
+            uint32_t m_periodicFailed;
+            uint64_t m_periodicBytesUploaded;
+            uint64_t m_periodicBytesSaved;
 
             #ifdef PLATFORM_BROADCOM
             bool inNexus;
@@ -122,6 +168,17 @@ namespace WPEFramework {
 #if defined(PLATFORM_AMLOGIC)
             size_t screenWidth;
             size_t screenHeight;
+            struct PendingCapture
+            {
+                std::string format;
+                bool periodic;
+            };
+            void addPendingCapture(const std::string &format, bool periodic);
+            void removePendingCapture(const std::string &format, bool periodic);
+
+            // the RDKShell screenshots requested by this plugin, in request order
+            std::mutex m_pendingMutex;
+            std::deque<PendingCapture> m_pendingRDKShellCaptures;
 #endif   
 
             friend class ScreenShotJob;
@@ -0,0 +1,222 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "PngEncoder.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef HAVE_LIBPNG
+#include <png.h>
+#endif
+
+using namespace WPEFramework::Plugin;
+
+namespace
+{
+    // A frame that compresses like a UI: a gradient background, flat tiles, rows of
+    // text-like glyphs and one tile of photo-like noise.
+    void syntheticFrame(std::vector<unsigned char> &pixels, int width, int height)
+    {
+        pixels.resize((size_t)width * height * 4);
+        unsigned int seed = 1;
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                unsigned char *p = &pixels[((size_t)y * width + x) * 4];
+                p[0] = 16 + (x * 32) / width;
+                p[1] = 24 + (y * 48) / height;
+                p[2] = 64;
+                p[3] = 255;
+
+                const int tileX = x % (width / 6);
+                const int tileY = y % (height / 4);
+                if (tileX > 16 && tileY > 16)
+                {
+                    if ((x / (width / 6)) == 2 && (y / (height / 4)) == 1)
+                    {
+                        seed = seed * 1103515245 + 12345;
+                        p[0] = (seed >> 16) & 0xff;
+                        p[1] = (p[0] + x) & 0xff;
+                        p[2] = (p[0] + y) & 0xff;
+                    }
+                    else if (tileY > (height / 4) - 40 && ((tileX / 6) % 3) != 0 && ((tileY / 3) % 4) != 0)
+                    {
+                        p[0] = p[1] = p[2] = 230;
+                    }
+                    else
+                    {
+                        p[0] = 40;
+                        p[1] = 44;
+                        p[2] = 52;
+                    }
+                }
+            }
+        }
+    }
+
+    double run(const std::vector<unsigned char> &pixels, int width, int height, const PngEncoder::Options &options, int iterations, size_t &size)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int loop = 0; loop < iterations; loop++)
+        {
+            size = 0;
+            PngEncoder::encode(pixels.data(), width, height, false, options, [&size](const unsigned char *, size_t length) {
+                size += length;
+                return true;
+            });
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+
+#ifdef HAVE_LIBPNG
+    void countPng(png_structp png, png_bytep, png_size_t length)
+    {
+        *static_cast<size_t *>(png_get_io_ptr(png)) += length;
+    }
+
+    void flushPng(png_structp)
+    {
+    }
+
+    // What saveToPng did before PngEncoder: libpng with its default settings.
+    double runLibpng(const std::vector<unsigned char> &pixels, int width, int height, int iterations, size_t &size)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int loop = 0; loop < iterations; loop++)
+        {
+            size = 0;
+            png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+            png_infop info = png_create_info_struct(png);
+            if (setjmp(png_jmpbuf(png)))
+            {
+                png_destroy_write_struct(&png, &info);
+                return 0;
+            }
+            png_set_write_fn(png, &size, countPng, flushPng);
+            png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+            png_write_info(png, info);
+            for (int y = 0; y < height; y++)
+                png_write_row(png, const_cast<png_bytep>(&pixels[(size_t)y * width * 4]));
+            png_write_end(png, NULL);
+            png_destroy_write_struct(&png, &info);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / iterations;
+    }
+#endif
+
+    void print(const char *name, double ms, size_t size)
+    {
+        printf("%-26s %8.1f ms %8zu KB\n", name, ms, size / 1024);
+    }
+}
+
+// Usage: ScreenCapturePngBenchmark [-n iterations] [-s WIDTHxHEIGHT] [raw RGBA file]
+// Prints the wall time per encode and the output size for the encoder settings that matter
+// on a device, so encoder changes can be compared on the target. Without a file a synthetic
+// UI-like frame is encoded.
+int main(int argc, char **argv)
+{
+    int iterations = 10;
+    int width = 1920;
+    int height = 1080;
+    const char *file = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg == "-n" && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (arg == "-s" && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2)
+                width = 0;
+        }
+        else if (arg[0] != '-' && file == NULL)
+            file = argv[i];
+        else
+            width = 0;
+    }
+
+    if (iterations <= 0 || width <= 0 || height <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [-n iterations] [-s WIDTHxHEIGHT] [raw RGBA file]" << std::endl;
+        return 1;
+    }
+
+    std::vector<unsigned char> pixels;
+    if (file != NULL)
+    {
+        std::ifstream input(file, std::ios::binary);
+        pixels.assign((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        if (pixels.size() != (size_t)width * height * 4)
+        {
+            std::cerr << file << ": expected " << (size_t)width * height * 4 << " bytes of " << width << "x" << height << " RGBA" << std::endl;
+            return 1;
+        }
+    }
+    else
+        syntheticFrame(pixels, width, height);
+
+    printf("%dx%d, %d iterations, %u cores\n", width, height, iterations, std::thread::hardware_concurrency());
+
+    size_t size = 0;
+    double ms = 0;
+#ifdef HAVE_LIBPNG
+    ms = runLibpng(pixels, width, height, iterations, size);
+    print("libpng default", ms, size);
+#endif
+
+    struct Setting
+    {
+        const char *name;
+        int level;
+        PngEncoder::Filter filter;
+        int threads;
+    };
+    const Setting settings[] = {
+        { "level 6 adaptive 1 thread", 6, PngEncoder::FILTER_ADAPTIVE, 1 },
+        { "level 6 adaptive", 6, PngEncoder::FILTER_ADAPTIVE, 0 },
+        { "level 6 paeth", 6, PngEncoder::FILTER_PAETH, 0 },
+        { "level 6 none", 6, PngEncoder::FILTER_NONE, 0 },
+        { "level 1 adaptive", 1, PngEncoder::FILTER_ADAPTIVE, 0 },
+        { "level 1 none", 1, PngEncoder::FILTER_NONE, 0 },
+        { "level 9 adaptive", 9, PngEncoder::FILTER_ADAPTIVE, 0 }
+    };
+    for (size_t i = 0; i < sizeof(settings) / sizeof(settings[0]); i++)
+    {
+        PngEncoder::Options options;
+        options.level = settings[i].level;
+        options.filter = settings[i].filter;
+        options.threads = settings[i].threads;
+        ms = run(pixels, width, height, options, iterations, size);
+        print(settings[i].name, ms, size);
+    }
+
+    return 0;
+}
@@ -0,0 +1,395 @@
+#include "AudioMixer.h"
+#include "logger.h"
+#include <gst/app/gstappsrc.h>
+
+//format of the mixed audio, the players convert to it before their audio reaches the mixer
+#define AUDIO_MIXER_FORMAT              "S16LE"
+#define AUDIO_MIXER_RATE                48000
+#define AUDIO_MIXER_CHANNELS            2
+#define AUDIO_MIXER_BYTES_PER_SEC       (AUDIO_MIXER_RATE * AUDIO_MIXER_CHANNELS * 2)
+//how long the mixer waits for a late input, and how far ahead of the output an input starts
+#define AUDIO_MIXER_LATENCY_MS          40
+#define AUDIO_MIXER_LEAD_MS             20
+//audio an input may hold ahead of the output, the player is paced by it
+#define AUDIO_MIXER_INPUT_MAX_BYTES     (AUDIO_MIXER_BYTES_PER_SEC / 10)
+//the output and its sink stay open this long after the last sound
+#define AUDIO_MIXER_IDLE_TIMEOUT_MS     5000
+
+AudioMixer::AudioMixer() : m_pipeline(NULL), m_mixer(NULL), m_busWatch(0), m_idleTimer(0), m_running(false)
+{
+}
+
+AudioMixer::~AudioMixer()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_idleTimer)
+    {
+        g_source_remove(m_idleTimer);
+        m_idleTimer = 0;
+    }
+    for(std::list<std::shared_ptr<Input>>::iterator it = m_inputs.begin(); it != m_inputs.end(); ++it)
+    {
+        if((*it)->pad)
+        {
+            gst_object_unref((*it)->pad);
+        }
+        (*it)->source = NULL;
+        (*it)->pad = NULL;
+    }
+    m_inputs.clear();
+    if(m_pipeline)
+    {
+        stop();
+        g_source_remove(m_busWatch);
+        gst_object_unref(m_pipeline);
+        m_pipeline = NULL;
+    }
+}
+
+GstCaps* AudioMixer::getCaps()
+{
+    return gst_caps_new_simple("audio/x-raw", "format", G_TYPE_STRING, AUDIO_MIXER_FORMAT, "rate", G_TYPE_INT, AUDIO_MIXER_RATE,
+                               "channels", G_TYPE_INT, AUDIO_MIXER_CHANNELS, "layout", G_TYPE_STRING, "interleaved", NULL);
+}
+
+bool AudioMixer::createPipeline()
+{
+    SAPLOG_INFO("SAP: Creating mixer pipeline...\n");
+    m_pipeline = gst_pipeline_new("mixer");
+    //silence keeps the output running, so that a new input does not wait for the sink to open
+    GstElement *silence = gst_element_factory_make("audiotestsrc", NULL);
+    GstElement *silenceCaps = gst_element_factory_make("capsfilter", NULL);
+    m_mixer = gst_element_factory_make("audiomixer", NULL);
+    GstElement *convert = gst_element_factory_make("audioconvert", NULL);
+    GstElement *resample = gst_element_factory_make("audioresample", NULL);
+    GstElement *sink = gst_element_factory_make("autoaudiosink", NULL);
+    if(!m_pipeline || !silence || !silenceCaps || !m_mixer || !convert || !resample || !sink)
+    {
+        SAPLOG_ERROR("SAP: Failed to create mixer pipeline elements\n");
+        if(m_pipeline)
+        {
+            gst_object_unref(m_pipeline);
+            m_pipeline = NULL;
+        }
+        return false;
+    }
+
+    gst_util_set_object_arg(G_OBJECT(silence), "wave", "silence");
+    g_object_set(G_OBJECT(silence), "is-live", TRUE, NULL);
+    GstCaps *caps = getCaps();
+    g_object_set(G_OBJECT(silenceCaps), "caps", caps, NULL);
+    gst_caps_unref(caps);
+    g_object_set(G_OBJECT(m_mixer), "latency", (guint64)(AUDIO_MIXER_LATENCY_MS * GST_MSECOND), NULL);
+
+    gst_bin_add_many(GST_BIN(m_pipeline), silence, silenceCaps, m_mixer, convert, resample, sink, NULL);
+    if(!gst_element_link_many(silence, silenceCaps, m_mixer, convert, resample, sink, NULL))
+    {
+        SAPLOG_ERROR("SAP: Failed to link mixer pipeline\n");
+        gst_object_unref(m_pipeline);
+        m_pipeline = NULL;
+        return false;
+    }
+
+    GstBus *bus = gst_element_get_bus(m_pipeline);
+    m_busWatch = gst_bus_add_watch(bus, GstBusCallback, (gpointer)(this));
+    gst_object_unref(bus);
+    return true;
+}
+
+void AudioMixer::start()
+{
+    if(m_idleTimer)
+    {
+        g_source_remove(m_idleTimer);
+        m_idleTimer = 0;
+    }
+    if(!m_pipeline && !createPipeline())
+    {
+        return;
+    }
+    if(!m_running)
+    {
+        m_startTime = std::chrono::steady_clock::now();
+        gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
+        m_running = true;
+    }
+}
+
+void AudioMixer::stop()
+{
+    if(m_running)
+    {
+        SAPLOG_INFO("SAP: Stopping mixer output\n");
+        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        m_running = false;
+    }
+}
+
+std::shared_ptr<AudioMixer::Input> AudioMixer::attach(int id, bool priority, int gain, int duck)
+{
+    std::shared_ptr<Input> input = std::make_shared<Input>();
+    input->id = id;
+    input->priority = priority;
+    input->gain = gain;
+    input->duck = duck;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    start();
+    if(!m_pipeline)
+    {
+        return input;
+    }
+    GstElement *source = gst_element_factory_make("appsrc", NULL);
+    GstCaps *caps = getCaps();
+    g_object_set(G_OBJECT(source), "caps", caps, "format", GST_FORMAT_TIME, "is-live", TRUE, "block", TRUE,
+                 "max-bytes", (guint64)AUDIO_MIXER_INPUT_MAX_BYTES, NULL);
+    gst_caps_unref(caps);
+    gst_bin_add(GST_BIN(m_pipeline), source);
+    GstPad *pad = gst_element_get_request_pad(m_mixer, "sink_%u");
+    GstPad *sourcePad = gst_element_get_static_pad(source, "src");
+    GstPadLinkReturn linked = gst_pad_link(sourcePad, pad);
+    gst_object_unref(sourcePad);
+    if(GST_PAD_LINK_FAILED(linked))
+    {
+        SAPLOG_ERROR("SAP: Failed to link mixer input of player id %d\n", id);
+        gst_element_release_request_pad(m_mixer, pad);
+        gst_object_unref(pad);
+        gst_bin_remove(GST_BIN(m_pipeline), source);
+        return input;
+    }
+    gst_element_sync_state_with_parent(source);
+    input->source = source;
+    input->pad = pad;
+    m_inputs.push_back(input);
+    updateLevels();
+    SAPLOG_INFO("SAP: Mixer input attached for player id %d, %d inputs\n", id, (int)m_inputs.size());
+    return input;
+}
+
+void AudioMixer::detach(const std::shared_ptr<Input> &input)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    removeInput(input);
+}
+
+void AudioMixer::removeInput(const std::shared_ptr<Input> &input)
+{
+    if(!input->source)
+    {
+        return;
+    }
+    //the source is stopped before its pad goes away, a running source would push into an unlinked pad
+    //and post an error for the whole output. Stopping it also unblocks a push of the player.
+    gst_element_set_locked_state(input->source, TRUE);
+    gst_element_set_state(input->source, GST_STATE_NULL);
+    GstPad *sourcePad = gst_element_get_static_pad(input->source, "src");
+    gst_pad_unlink(sourcePad, input->pad);
+    gst_object_unref(sourcePad);
+    gst_element_release_request_pad(m_mixer, input->pad);
+    gst_object_unref(input->pad);
+    gst_bin_remove(GST_BIN(m_pipeline), input->source);
+    input->source = NULL;
+    input->pad = NULL;
+    m_inputs.remove(input);
+    updateLevels();
+    SAPLOG_INFO("SAP: Mixer input detached for player id %d, %d inputs\n", input->id, (int)m_inputs.size());
+}
+
+std::shared_ptr<AudioMixer::Input> AudioMixer::findInput(GstObject *element)
+{
+    for(std::list<std::shared_ptr<Input>>::iterator it = m_inputs.begin(); it != m_inputs.end(); ++it)
+    {
+        if(GST_OBJECT((*it)->source) == element)
+        {
+            return *it;
+        }
+    }
+    return std::shared_ptr<Input>();
+}
+
+bool AudioMixer::push(const std::shared_ptr<Input> &input, GstBuffer *buffer)
+{
+    GstElement *source = NULL;
+    GstBuffer *timed = NULL;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!input->source || input->eos)
+        {
+            return false;
+        }
+        source = GST_ELEMENT(gst_object_ref(input->source));
+
+        //the audio of an input is continuous, it starts again from the output position when it fell behind
+        GstClockTime now = 0;
+        GstClock *clock = gst_element_get_clock(m_pipeline);
+        if(clock)
+        {
+            now = gst_clock_get_time(clock) - gst_element_get_base_time(m_pipeline);
+            gst_object_unref(clock);
+        }
+        if(input->nextPts == GST_CLOCK_TIME_NONE || input->nextPts < now)
+        {
+            input->nextPts = now + AUDIO_MIXER_LEAD_MS * GST_MSECOND;
+        }
+        //the copy shares the audio memory, only the timestamps are its own
+        timed = gst_buffer_copy(buffer);
+        GST_BUFFER_PTS(timed) = input->nextPts;
+        GST_BUFFER_DTS(timed) = GST_CLOCK_TIME_NONE;
+        GST_BUFFER_DURATION(timed) = gst_util_uint64_scale(gst_buffer_get_size(buffer), GST_SECOND, AUDIO_MIXER_BYTES_PER_SEC);
+        input->nextPts += GST_BUFFER_DURATION(timed);
+    }
+    GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(source), timed);
+    gst_object_unref(source);
+    return (ret == GST_FLOW_OK);
+}
+
+void AudioMixer::endOfStream(const std::shared_ptr<Input> &input)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(input->source && !input->eos)
+    {
+        gst_app_src_end_of_stream(GST_APP_SRC(input->source));
+        input->eos = true;
+        updateLevels();
+    }
+}
+
+bool AudioMixer::isActive(const std::shared_ptr<Input> &input)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (input->source != NULL && !input->eos);
+}
+
+void AudioMixer::setLevels(const std::shared_ptr<Input> &input, int gain, int duck)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    input->gain = gain;
+    input->duck = duck;
+    updateLevels();
+}
+
+void AudioMixer::updateLevels()
+{
+    int duck = 100;
+    int active = 0;
+    for(std::list<std::shared_ptr<Input>>::iterator it = m_inputs.begin(); it != m_inputs.end(); ++it)
+    {
+        if(!(*it)->eos)
+        {
+            active++;
+            if((*it)->priority && (*it)->duck < duck)
+            {
+                duck = (*it)->duck;
+            }
+        }
+    }
+    for(std::list<std::shared_ptr<Input>>::iterator it = m_inputs.begin(); it != m_inputs.end(); ++it)
+    {
+        gdouble volume = (gdouble)(*it)->gain / 100;
+        if(!(*it)->priority)
+        {
+            volume = volume * duck / 100;
+        }
+        g_object_set(G_OBJECT((*it)->pad), "volume", volume, NULL);
+    }
+    if(active == 0)
+    {
+        scheduleIdleStop();
+    }
+}
+
+void AudioMixer::scheduleIdleStop()
+{
+    if(m_running && !m_idleTimer)
+    {
+        m_idleTimer = g_timeout_add(AUDIO_MIXER_IDLE_TIMEOUT_MS, onIdleTimeout, this);
+    }
+}
+
+gboolean AudioMixer::onIdleTimeout(gpointer data)
+{
+    AudioMixer *mixer = (AudioMixer*) data;
+    std::lock_guard<std::mutex> lock(mixer->m_mutex);
+    //an input may have come and gone while this timeout waited for the lock
+    if(mixer->m_idleTimer != g_source_get_id(g_main_current_source()))
+    {
+        return G_SOURCE_REMOVE;
+    }
+    mixer->m_idleTimer = 0;
+    for(std::list<std::shared_ptr<Input>>::iterator it = mixer->m_inputs.begin(); it != mixer->m_inputs.end(); ++it)
+    {
+        if(!(*it)->eos)
+        {
+            return G_SOURCE_REMOVE;
+        }
+    }
+    mixer->stop();
+    return G_SOURCE_REMOVE;
+}
+
+gboolean AudioMixer::GstBusCallback(GstBus *, GstMessage *message, gpointer data)
+{
+    AudioMixer *mixer = (AudioMixer*) data;
+    return mixer->handleMessage(message);
+}
+
+bool AudioMixer::handleMessage(GstMessage *message)
+{
+    GError* error = NULL;
+    gchar* debug = NULL;
+    switch (GST_MESSAGE_TYPE(message)){
+
+        case GST_MESSAGE_ERROR: {
+                gst_message_parse_error(message, &error, &debug);
+                SAPLOG_ERROR("SAP: mixer error! code: %d, %s, Debug: %s", error->code, error->message, debug);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                std::shared_ptr<Input> input = findInput(GST_MESSAGE_SRC(message));
+                if(input)
+                {
+                    //only the player of this input loses its audio, the others keep playing
+                    SAPLOG_ERROR("SAP: Dropping mixer input of player id %d after its error\n", input->id);
+                    removeInput(input);
+                }
+                else if(!gst_object_has_as_ancestor(GST_MESSAGE_SRC(message), GST_OBJECT(m_pipeline)) &&
+                        GST_MESSAGE_SRC(message) != GST_OBJECT(m_pipeline))
+                {
+                    SAPLOG_WARNING("SAP: Ignoring error of a mixer input that is gone already\n");
+                }
+                else
+                {
+                    //the output is started again by the next input
+                    stop();
+                }
+            }
+            break;
+
+        case GST_MESSAGE_WARNING: {
+                gst_message_parse_warning(message, &error, &debug);
+                SAPLOG_WARNING("SAP: mixer warning! code: %d, %s, Debug: %s", error->code, error->message, debug);
+            }
+            break;
+
+        case GST_MESSAGE_STATE_CHANGED: {
+                GstState oldstate, newstate, pending;
+                gst_message_parse_state_changed (message, &oldstate, &newstate, &pending);
+                if (GST_ELEMENT(GST_MESSAGE_SRC(message)) == m_pipeline && newstate == GST_STATE_PLAYING)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    SAPLOG_INFO("SAP: Mixer output playing %lld ms after start\n",
+                                (long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_startTime).count());
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if(error)
+        g_error_free(error);
+
+    if(debug)
+        g_free(debug);
+
+    return true;
+}
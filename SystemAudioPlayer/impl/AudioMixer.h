@@ -0,0 +1,67 @@
+#ifndef AUDIO_MIXER
+#define AUDIO_MIXER
+#include <gst/gst.h>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+
+//Mixes the decoded audio of every player into one output pipeline, so that players share
+//one audio sink instead of opening their own. Each player feeds an input of its own with
+//a gain. While a priority input (speech) plays, the other inputs are ducked to its duck level.
+//The output keeps running on silence between sounds and stops after it was idle for a while.
+class AudioMixer
+{
+    public:
+    struct Input
+    {
+        Input() : id(0), priority(false), gain(100), duck(100), eos(false), source(NULL), pad(NULL), nextPts(GST_CLOCK_TIME_NONE) {}
+        int id;
+        bool priority;
+        int gain;
+        int duck;
+        bool eos;
+        GstElement *source;
+        GstPad *pad;
+        GstClockTime nextPts;
+    };
+
+    AudioMixer();
+    ~AudioMixer();
+    //new input of a player, the output is started when it is not running
+    std::shared_ptr<Input> attach(int id, bool priority, int gain, int duck);
+    void detach(const std::shared_ptr<Input> &input);
+    //streaming thread of the player, blocks while the input holds enough audio
+    bool push(const std::shared_ptr<Input> &input, GstBuffer *buffer);
+    void endOfStream(const std::shared_ptr<Input> &input);
+    //attached and not at its end yet
+    bool isActive(const std::shared_ptr<Input> &input);
+    //gain and duck level in percent
+    void setLevels(const std::shared_ptr<Input> &input, int gain, int duck);
+    //the format of the mixed audio, who uses has to release this caps
+    static GstCaps* getCaps();
+
+    private:
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+    bool createPipeline();
+    void start();
+    void stop();
+    void removeInput(const std::shared_ptr<Input> &input);
+    std::shared_ptr<Input> findInput(GstObject *element);
+    void updateLevels();
+    void scheduleIdleStop();
+    bool handleMessage(GstMessage *message);
+    static gboolean onIdleTimeout(gpointer data);
+    static gboolean GstBusCallback(GstBus *bus, GstMessage *message, gpointer data);
+
+    std::mutex m_mutex;
+    GstElement *m_pipeline;
+    GstElement *m_mixer;
+    guint m_busWatch;
+    guint m_idleTimer;
+    bool m_running;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::list<std::shared_ptr<Input>> m_inputs;
+};
+#endif
@@ -3,7 +3,17 @@
 #include <gst/app/gstappsrc.h>
 
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #define AUDIO_GST_FRAGMENT_MAX_SIZE     (128 * 1024)
+//chunk buffers kept for reuse once the pipeline released them
+#define AUDIO_BUFFER_POOL_MAX_FREE      32
+//audio the data source may queue ahead of playback, more is dropped
+#define AUDIO_QUEUE_CAPACITY_MS         30000
+//stream rates assumed for the queue capacity of compressed audio
+#define AUDIO_MP3_MAX_BYTES_PER_SEC     (320000 / 8)
+#define AUDIO_WAV_BYTES_PER_SEC         (44100 * 2 * 2)
 #define PLAYBACK_STARTED "PLAYBACK_STARTED"
 #define PLAYBACK_FINISHED "PLAYBACK_FINISHED"
 #define PLAYBACK_PAUSED "PLAYBACK_PAUSED"
@@ -15,7 +25,10 @@
 GMainLoop* AudioPlayer::m_main_loop=NULL;
 GThread* AudioPlayer::m_main_loop_thread=NULL;
 SAPEventCallback* AudioPlayer::m_callback=NULL;
+AudioMixer* AudioPlayer::m_mixer=NULL;
+#if defined(PLATFORM_AMLOGIC)
 audio_hw_device_t* AudioPlayer::m_audio_dev=NULL;
+#endif
 //TODO Dock primary volume , if both APP & SYSTEM mode are playing
 //static bool app_playing =false;
 //static bool sys_playing =false;
@@ -29,15 +42,6 @@ AudioPlayer::AudioPlayer(AudioType audioType,SourceType sourceType,PlayMode play
     m_isPaused = false;
     state = READY;
     SAPLOG_INFO("SAP: AudioPlayer Constructor\n");    
-    if(sourceType == DATA || sourceType == WEBSOCKET)
-    {
-        m_running = true;
-        appsrc_firstpacket = true;
-        webClient = NULL;
-        bufferQueue = new BufferQueue(1000);
-        m_thread= new std::thread(&AudioPlayer::PushDataAppSrc, this);
-    }
-
     if(this->audioType == PCM)
     {
         m_PCMFormat = "S16LE";
@@ -56,6 +60,16 @@ AudioPlayer::AudioPlayer(AudioType audioType,SourceType sourceType,PlayMode play
 
     }
 
+    if(sourceType == DATA || sourceType == WEBSOCKET)
+    {
+        m_running = true;
+        appsrc_firstpacket = true;
+        webClient = NULL;
+        bufferQueue = new BufferRing(getQueueCapacity());
+        m_bufferPool = std::make_shared<BufferPool>(AUDIO_BUFFER_POOL_MAX_FREE);
+        m_thread= new std::thread(&AudioPlayer::PushDataAppSrc, this);
+    }
+
     createPipeline();
     SAPLOG_INFO("AudioPlayer AudioType:%d,SourceType:%d,playMode:%d,object id:%d\n",getAudioType(),getSourceType(),getPlayMode(),getObjectIdentifier());
     //Set mixter levels, this can be reflected when playing
@@ -77,6 +91,7 @@ AudioPlayer::~AudioPlayer()
         delete bufferQueue;
         delete m_thread;
     }  
+    detachMixer();
     gst_element_set_state (m_pipeline, GST_STATE_NULL);
     gst_object_unref (m_pipeline);  
 }
@@ -88,6 +103,10 @@ void AudioPlayer::Init(SAPEventCallback *callback)
         gst_init(NULL,NULL);
     m_main_loop_thread = g_thread_new("BusWatch", (void* (*)(void*)) event_loop, NULL);
     m_callback = callback;
+#if defined(SAP_AUDIO_MIXER) && !defined(PLATFORM_AMLOGIC)
+    //the Amlogic HAL mixes the players itself
+    m_mixer = new AudioMixer();
+#endif
 #if defined(PLATFORM_AMLOGIC)
     if(!m_audio_dev)
     {
@@ -117,6 +136,8 @@ void AudioPlayer::DeInit()
     if(g_main_loop_is_running(m_main_loop))
         g_main_loop_quit(m_main_loop);
     g_thread_join(m_main_loop_thread);
+    delete m_mixer;
+    m_mixer = NULL;
    
 #if defined(PLATFORM_AMLOGIC)
     if(m_audio_dev)
@@ -180,6 +201,10 @@ bool AudioPlayer::configPCMCaps(const std::string format, int rate, int channels
     m_Layout = layout;
     m_Rate = rate;
     m_Channels = channels;
+    if(sourceType == DATA || sourceType == WEBSOCKET)
+    {
+        bufferQueue->setCapacity(getQueueCapacity());
+    }
     SAPLOG_INFO("SAP: PCM config is applied successfully format=%s layout=%s rate=%d channels=%d\n",m_PCMFormat.c_str() , m_Layout.c_str() , m_Rate , m_Channels);
     return true;
     }
@@ -190,6 +215,28 @@ bool AudioPlayer::configPCMCaps(const std::string format, int rate, int channels
     }
 }
 
+//Bytes the data queue holds, AUDIO_QUEUE_CAPACITY_MS of the configured audio
+size_t AudioPlayer::getQueueCapacity()
+{
+    size_t bytesPerSec;
+    if(audioType == PCM)
+    {
+        //the sample width is the number in the format name, S16LE, F32LE, U8...
+        size_t digits = m_PCMFormat.find_first_of("0123456789");
+        int bits = (digits != std::string::npos) ? atoi(m_PCMFormat.c_str() + digits) : 16;
+        bytesPerSec = (size_t)m_Rate * m_Channels * ((bits + 7) / 8);
+    }
+    else if(audioType == MP3)
+    {
+        bytesPerSec = AUDIO_MP3_MAX_BYTES_PER_SEC;
+    }
+    else
+    {
+        bytesPerSec = AUDIO_WAV_BYTES_PER_SEC;
+    }
+    return bytesPerSec * AUDIO_QUEUE_CAPACITY_MS / 1000;
+}
+
 //Get a new audio caps , who uses has to release this caps
 GstCaps * AudioPlayer::getPCMAudioCaps( const std::string format, int rate, int channels, const std::string layout)
 {
@@ -227,14 +274,31 @@ void AudioPlayer::createPipeline()
         return;
     }
      // create soc specific elements..generic elements
-#if defined(PLATFORM_AMLOGIC)
     GstElement *convert = gst_element_factory_make("audioconvert", NULL);
     GstElement *resample = gst_element_factory_make("audioresample", NULL);
+#if defined(PLATFORM_AMLOGIC)
     m_audioSink = gst_element_factory_make("amlhalasink", NULL);
     m_audioVolume = m_audioSink;
 #else
-    m_audioSink = gst_element_factory_make("autoaudiosink", NULL); 
-#endif 
+    if(m_mixer)
+    {
+        //the decoded audio goes to the shared mixer in its format, the player has no audio sink of its own
+        m_audioSink = gst_element_factory_make("appsink", NULL);
+        GstCaps *mixerCaps = AudioMixer::getCaps();
+        g_object_set(G_OBJECT(m_audioSink), "caps", mixerCaps, "sync", FALSE, NULL);
+        gst_caps_unref(mixerCaps);
+        GstAppSinkCallbacks callbacks;
+        memset(&callbacks, 0, sizeof(callbacks));
+        callbacks.eos = onMixerEos;
+        callbacks.new_sample = onMixerSample;
+        gst_app_sink_set_callbacks(GST_APP_SINK(m_audioSink), &callbacks, this, NULL);
+    }
+    else
+    {
+        m_audioSink = gst_element_factory_make("autoaudiosink", NULL);
+    }
+#endif
+
     if(sourceType == HTTPSRC)
     {
        m_source = gst_element_factory_make("souphttpsrc", NULL);
@@ -281,13 +345,8 @@ void AudioPlayer::createPipeline()
 	    //g_signal_connect (m_source, "need-data", G_CALLBACK (start_feed), this);
             //g_signal_connect (m_source, "enough-data", G_CALLBACK (stop_feed), this);
 	    g_object_set(m_source, "format", GST_FORMAT_TIME, NULL);
-	    #if defined(PLATFORM_AMLOGIC)
             gst_bin_add_many(GST_BIN(m_pipeline), m_source, convert, resample, m_audioSink, NULL);
             result = gst_element_link_many (m_source,convert,resample,m_audioSink,NULL);
-	    #else
-            gst_bin_add_many(GST_BIN(m_pipeline), m_source, m_audioSink, NULL);
-            result = gst_element_link_many (m_source,m_audioSink,NULL);
-            #endif
         }
         else
 	{
@@ -303,13 +362,8 @@ void AudioPlayer::createPipeline()
                 return;
             }
 	
-            #if defined(PLATFORM_AMLOGIC)
 	    gst_bin_add_many(GST_BIN(m_pipeline), m_source, m_capsfilter, convert, resample, m_audioSink, NULL);
             result = gst_element_link_many (m_source,m_capsfilter,convert,resample,m_audioSink,NULL);
-            #else
-	    gst_bin_add_many(GST_BIN(m_pipeline), m_source, m_capsfilter, m_audioSink, NULL);
-	    result = gst_element_link_many (m_source,m_capsfilter,m_audioSink,NULL);
-	    #endif	
         }
     }
 
@@ -330,17 +384,14 @@ void AudioPlayer::createPipeline()
             #endif
         }
         GstElement *wavparser = gst_element_factory_make("wavparse", NULL);
-        #if defined(PLATFORM_AMLOGIC)
         gst_bin_add_many(GST_BIN(m_pipeline), m_source, wavparser, convert, resample, m_audioSink, NULL);
         result = gst_element_link_many (m_source,wavparser,convert,resample,m_audioSink,NULL);
-        #endif
     }
 
     else
     {  
         //mp3
         SAPLOG_INFO("SAP: Pipleine for mp3 audioType\n");
-        #if defined(PLATFORM_AMLOGIC)
         GstElement *parser = gst_element_factory_make("mpegaudioparse", NULL);
         GstElement *decodebin = gst_element_factory_make("avdec_mp3", NULL);
 	gst_bin_add_many(GST_BIN(m_pipeline), m_source, parser, decodebin, convert, resample, m_audioSink, NULL);
@@ -349,7 +400,6 @@ void AudioPlayer::createPipeline()
         result &= gst_element_link (decodebin, convert);
         result &= gst_element_link (convert, resample);
         result &= gst_element_link (resample, m_audioSink);
-        #endif
     }
 
     if(!result) 
@@ -374,6 +424,73 @@ int AudioPlayer::GstBusCallback(GstBus *, GstMessage *message, gpointer data)
 }
 
 
+void AudioPlayer::attachMixer()
+{
+    detachMixer();
+    if(!m_mixer)
+    {
+        return;
+    }
+    std::shared_ptr<AudioMixer::Input> input = m_mixer->attach(getObjectIdentifier(), playMode == APP, m_thisVolume, m_primVolume);
+    std::lock_guard<std::mutex> lock(m_mixerMutex);
+    m_mixerInput = input;
+}
+
+void AudioPlayer::detachMixer()
+{
+    std::shared_ptr<AudioMixer::Input> input;
+    {
+        std::lock_guard<std::mutex> lock(m_mixerMutex);
+        input.swap(m_mixerInput);
+    }
+    if(input)
+    {
+        m_mixer->detach(input);
+    }
+}
+
+std::shared_ptr<AudioMixer::Input> AudioPlayer::getMixerInput()
+{
+    std::lock_guard<std::mutex> lock(m_mixerMutex);
+    return m_mixerInput;
+}
+
+GstFlowReturn AudioPlayer::onMixerSample(GstAppSink *sink, gpointer data)
+{
+    AudioPlayer *player = (AudioPlayer*) data;
+    GstSample *sample = gst_app_sink_pull_sample(sink);
+    if(sample == NULL)
+    {
+        return GST_FLOW_OK;
+    }
+    GstFlowReturn ret = GST_FLOW_OK;
+    std::shared_ptr<AudioMixer::Input> input = player->getMixerInput();
+    //blocks while the mixer input is full, which paces this pipeline to the output
+    if(input && !m_mixer->push(input, gst_sample_get_buffer(sample)) && input == player->getMixerInput())
+    {
+        //the mixer dropped this input after an error, unlike a Stop this is an error of this player
+        SAPLOG_ERROR("SAP: Mixer input of player id %d failed\n", player->getObjectIdentifier());
+        ret = GST_FLOW_ERROR;
+    }
+    gst_sample_unref(sample);
+    return ret;
+}
+
+void AudioPlayer::onMixerEos(GstAppSink *, gpointer data)
+{
+    AudioPlayer *player = (AudioPlayer*) data;
+    std::shared_ptr<AudioMixer::Input> input = player->getMixerInput();
+    if(input)
+    {
+        m_mixer->endOfStream(input);
+    }
+}
+
+static void releaseBuffer(Buffer *buffer)
+{
+    buffer->release();
+}
+
 gboolean AudioPlayer::PushDataAppSrc()
 {
     while(m_running)
@@ -391,13 +508,16 @@ gboolean AudioPlayer::PushDataAppSrc()
         //package should be played as soon as it arrived
         //GstClockTime pts = 0;
         //GstClockTime dts = 0;
-        buffer = bufferQueue->remove();  //blocking call
+        buffer = bufferQueue->pop();  //blocking call
 	if(buffer == NULL)
 	{
             continue;		
 	}
         int length = buffer->getLength();
-        char *ptr = buffer->getBuffer();
+        size_t offset = 0;
+        //the chunk is handed to the pipeline in place, it goes back to the pool when the last fragment is freed
+        GstBuffer *chunk = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, buffer->getBuffer(), buffer->capacity, 0, length,
+                                                       buffer, (GDestroyNotify) releaseBuffer);
 
         while(length != 0)
         {               
@@ -408,11 +528,9 @@ gboolean AudioPlayer::PushDataAppSrc()
                 lenToSend = maxBytes;
             }
      
-            GstBuffer *gbuffer = gst_buffer_new_and_alloc((guint)lenToSend);
-            GstMapInfo map;
-            gst_buffer_map(gbuffer, &map, GST_MAP_WRITE);
-            memcpy(map.data,ptr,lenToSend);
-            gst_buffer_unmap(gbuffer, &map);
+            //fragments share the memory of the chunk
+            GstBuffer *gbuffer = (offset == 0 && lenToSend == buffer->getLength()) ? gst_buffer_ref(chunk) :
+                                 gst_buffer_copy_region(chunk, GST_BUFFER_COPY_MEMORY, offset, lenToSend);
             //GST_BUFFER_PTS(gbuffer) = pts;
             //GST_BUFFER_DTS(gbuffer) = dts;
             //GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(player->m_source), gbuffer);
@@ -432,11 +550,10 @@ gboolean AudioPlayer::PushDataAppSrc()
                 setPrimaryVolume(m_primVolume);
                 setVolume(m_thisVolume);
             }
-            ptr = lenToSend + (char *)ptr;
+            offset += lenToSend;
             length -= lenToSend;
         }
-        buffer->deleteBuffer();
-	delete buffer;        
+        gst_buffer_unref(chunk);
     }
    
 }
@@ -457,11 +574,12 @@ void AudioPlayer::wsConnectionStatus(WSStatus status)
 
 void AudioPlayer::push_data(const void *ptr,int length)
 {
-    if(!bufferQueue->isFull())
+    Buffer *buffer = m_bufferPool->acquire(length);
+    buffer->fillBuffer(ptr,length);
+    if(!bufferQueue->push(buffer))
     {
-	Buffer *buffer = new Buffer();
-        buffer->fillBuffer(ptr,length);
-        bufferQueue->add(buffer);
+        SAPLOG_WARNING("SAP: buffer queue full, dropping %d bytes Playerid %d\n",length,getObjectIdentifier());
+        buffer->release();
     }
 }
 
@@ -666,6 +784,7 @@ bool AudioPlayer::waitForStatus(GstState expected_state, uint32_t timeout_ms)
 void AudioPlayer::destroyPipeline()
 {
     SAPLOG_WARNING("SAP: Destroying Pipeline...Player id %d\n",getObjectIdentifier());
+    detachMixer();
 
     if(m_pipeline) {
         gst_element_set_state(m_pipeline, GST_STATE_NULL);
@@ -692,6 +811,7 @@ void AudioPlayer::Play(std::string url)
             webClient = new WebSocketClient(this);
             webClient->connect(m_url);
         } 
+        attachMixer();
         SAPLOG_INFO("SAP: PLAYING GLOBAL primary Volume=%d player Volume=%d",m_primVolume  , m_thisVolume ); 
         //TODO setAppSysPlayingSate(true)
         gst_element_set_state(m_pipeline, GST_STATE_PLAYING);
@@ -705,7 +825,12 @@ void AudioPlayer::PlayBuffer(const char *data,int length)
     if(m_pipeline)
     {
         if(state != PLAYING)
+        {
+            std::shared_ptr<AudioMixer::Input> input = getMixerInput();
+            if(!input || !m_mixer->isActive(input))
+                attachMixer();
             gst_element_set_state(m_pipeline, GST_STATE_PLAYING);      
+        }
         push_data(data,length);
     }
 }
@@ -750,6 +875,7 @@ void AudioPlayer::Stop()
 	SAPLOG_INFO("size of Buffer queue after clear %d\n",bufferQueue->count());
 	  
     }
+    detachMixer();
     resetPipeline();
     state = READY;
     
@@ -792,6 +918,7 @@ int AudioPlayer::getObjectIdentifier()
     return objectIdentifier;
 }
 
+#if defined(PLATFORM_AMLOGIC)
 bool AudioPlayer::loadInitAudioDev()
 {
     //TTSLOG_WARNING("Destroying Pipeline...");
@@ -851,6 +978,7 @@ bool AudioPlayer::setMixGain(MixGain gain, int val)
      }
  return status;
 }
+#endif
 
 //Primary Audio control/dock
 void AudioPlayer::setPrimaryVolume( int primVol)
@@ -872,7 +1000,7 @@ void AudioPlayer::setPrimaryVolume( int primVol)
     return;
 }
 
-//Player audio control
+//Player audio control, the HAL mix gain on Amlogic, else the gain of its mixer input if the players are mixed
 void AudioPlayer::setVolume( int thisVol)
 {
     SAPLOG_INFO(" Prev Player Volume=%d cur Vol=%d",m_prevThisVolume , thisVol );
@@ -897,7 +1025,13 @@ void AudioPlayer::setVolume( int thisVol)
         g_object_set(G_OBJECT(m_audioVolume), "stream-volume", (double)thisVol/100, NULL);
     }
 #else
-    g_object_set(G_OBJECT(m_audioVolume), "volume", (double)thisVol/100, NULL);
+    std::shared_ptr<AudioMixer::Input> input = getMixerInput();
+    if(input)
+    {
+        //while an app (tts) player speaks, the system sounds are ducked to its primary volume level
+        m_mixer->setLevels(input, thisVol, m_primVolume);
+    }
+    m_prevThisVolume = thisVol;
 #endif
     return;
 }
@@ -2,10 +2,13 @@
 #define AUDIO_PLAYER
 #include <gst/gst.h>
 #include <gst/audio/audio.h>
+#include <gst/app/gstappsink.h>
 #include <string>
-#include "BufferQueue.h"
+#include "AudioMixer.h"
+#include "BufferRing.h"
 #include "WebSocketClient.h"
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <thread>
 
@@ -77,6 +80,7 @@ class AudioPlayer
     static GMainLoop   *m_main_loop;
     static GThread     *m_main_loop_thread;
     static SAPEventCallback *m_callback;
+    static AudioMixer *m_mixer;
     int objectIdentifier;
     std::atomic<bool> m_isPaused;
     bool m_running;
@@ -89,6 +93,9 @@ class AudioPlayer
     guint       m_busWatch;  
     gint64      m_duration;
     std::thread *m_thread;
+    //input of this player in the shared mixer while it plays
+    std::mutex m_mixerMutex;
+    std::shared_ptr<AudioMixer::Input> m_mixerInput;
 #if defined(PLATFORM_AMLOGIC)
     static audio_hw_device_t *m_audio_dev;
     enum MixGain {
@@ -98,7 +105,8 @@ class AudioPlayer
     };
 #endif
     WebSocketClient *webClient;
-    BufferQueue *bufferQueue;
+    BufferRing *bufferQueue;
+    std::shared_ptr<BufferPool> m_bufferPool;
     GstElement  *m_source;
     AudioType audioType;
     SourceType sourceType;
@@ -113,6 +121,11 @@ class AudioPlayer
     void createPipeline();
     void resetPipeline();
     void destroyPipeline();
+    void attachMixer();
+    void detachMixer();
+    std::shared_ptr<AudioMixer::Input> getMixerInput();
+    static GstFlowReturn onMixerSample(GstAppSink *sink, gpointer data);
+    static void onMixerEos(GstAppSink *sink, gpointer data);
 #if defined(PLATFORM_AMLOGIC)
     bool setMixGain(MixGain gain, int val);
     bool loadInitAudioDev();
@@ -120,6 +133,7 @@ class AudioPlayer
     void setVolume( int Vol);
     void setPrimaryVolume( int Vol);
     bool waitForStatus(GstState expected_state, uint32_t timeout_ms);
+    size_t getQueueCapacity();
     GstCaps * getPCMAudioCaps( const std::string format, int rate, int channels, const std::string layout);
 
     public:
@@ -0,0 +1,94 @@
+#include "BufferPool.h"
+#include <cstring>
+
+//allocations are rounded up so that a buffer fits chunks of slightly different sizes
+#define BUFFER_POOL_GRANULARITY 4096
+
+Buffer::Buffer(size_t capacity) : buff(new char[capacity]), length(0), capacity(capacity)
+{
+}
+
+Buffer::~Buffer()
+{
+    delete[] buff;
+}
+
+void Buffer::fillBuffer(const void *ptr,int len)
+{
+    this->length = len;
+    std::memcpy(buff,ptr,length);
+}
+
+int Buffer::getLength()
+{
+    return length;
+}
+
+char* Buffer::getBuffer()
+{
+    return buff;
+}
+
+void Buffer::release()
+{
+    //the pool reference is dropped here so that a free buffer does not keep its pool alive
+    std::shared_ptr<BufferPool> owner;
+    owner.swap(pool);
+    if(owner)
+    {
+        owner->release(this);
+    }
+    else
+    {
+        delete this;
+    }
+}
+
+BufferPool::BufferPool(size_t maxFree) : m_maxFree(maxFree)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    for(size_t i = 0; i < m_free.size(); i++)
+    {
+        delete m_free[i];
+    }
+}
+
+Buffer* BufferPool::acquire(size_t size)
+{
+    Buffer *buffer = NULL;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(size_t i = m_free.size(); i > 0; i--)
+        {
+            if(m_free[i - 1]->capacity >= size)
+            {
+                buffer = m_free[i - 1];
+                m_free.erase(m_free.begin() + (i - 1));
+                break;
+            }
+        }
+    }
+    if(buffer == NULL)
+    {
+        buffer = new Buffer(((size + BUFFER_POOL_GRANULARITY - 1) / BUFFER_POOL_GRANULARITY) * BUFFER_POOL_GRANULARITY);
+    }
+    buffer->length = 0;
+    buffer->pool = shared_from_this();
+    return buffer;
+}
+
+void BufferPool::release(Buffer *buffer)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_free.size() < m_maxFree)
+        {
+            m_free.push_back(buffer);
+            return;
+        }
+    }
+    delete buffer;
+}
@@ -0,0 +1,44 @@
+#ifndef BUFFERPOOL_H_
+#define BUFFERPOOL_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <stddef.h>
+
+class BufferPool;
+
+struct Buffer
+{
+    Buffer(size_t capacity);
+    ~Buffer();
+    void fillBuffer(const void *ptr,int len);
+    int getLength();
+    char *getBuffer();
+    //hands the buffer back to its pool, the buffer must not be used afterwards
+    void release();
+    char *buff;
+    int length;
+    size_t capacity;
+    std::shared_ptr<BufferPool> pool;
+};
+
+//Reuses the allocations of the incoming audio chunks. A chunk is copied once into a pooled
+//buffer, which the pipeline then reads in place and releases when it is done with it.
+class BufferPool : public std::enable_shared_from_this<BufferPool>
+{
+    public:
+    BufferPool(size_t maxFree);
+    ~BufferPool();
+    Buffer* acquire(size_t size);
+    void release(Buffer *buffer);
+
+    private:
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    std::mutex m_mutex;
+    std::vector<Buffer*> m_free;
+    size_t m_maxFree;
+};
+#endif
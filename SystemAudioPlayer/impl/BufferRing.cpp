@@ -0,0 +1,105 @@
+#include "BufferRing.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex word must be a plain int");
+
+const size_t BufferRing::SLOTS;
+
+BufferRing::BufferRing(size_t capacityBytes) : m_write(0), m_read(0), m_discard(0), m_bytes(0), m_capacity(capacityBytes), m_stopped(false), m_wakeups(0)
+{
+}
+
+BufferRing::~BufferRing()
+{
+    uint64_t write = m_write.load();
+    for(uint64_t index = m_read.load(); index != write; index++)
+    {
+        m_slots[index % SLOTS]->release();
+    }
+}
+
+bool BufferRing::push(Buffer *item)
+{
+    uint64_t write = m_write.load(std::memory_order_relaxed);
+    size_t bytes = m_bytes.load();
+    //one chunk is always taken, however big, so that a long clip can still be played
+    if((write - m_read.load() >= SLOTS) || ((bytes != 0) && (bytes + item->getLength() > m_capacity.load(std::memory_order_relaxed))))
+    {
+        return false;
+    }
+    m_slots[write % SLOTS] = item;
+    m_bytes += item->getLength();
+    m_write.store(write + 1);
+    //only the transition from empty can find the consumer asleep
+    if(write == m_read.load())
+    {
+        wake();
+    }
+    return true;
+}
+
+Buffer* BufferRing::pop()
+{
+    while(true)
+    {
+        int wakeups = m_wakeups.load();
+        if(m_stopped.load())
+        {
+            return NULL;
+        }
+        uint64_t read = m_read.load(std::memory_order_relaxed);
+        if(read != m_write.load())
+        {
+            Buffer *item = m_slots[read % SLOTS];
+            m_bytes -= item->getLength();
+            m_read.store(read + 1);
+            if(read < m_discard.load())
+            {
+                item->release();
+                continue;
+            }
+            return item;
+        }
+        syscall(SYS_futex, reinterpret_cast<int*>(&m_wakeups), FUTEX_WAIT_PRIVATE, wakeups, NULL, NULL, 0);
+    }
+}
+
+void BufferRing::clear()
+{
+    //the consumer drops them, so that it stays the only one taking chunks out
+    m_discard.store(m_write.load());
+    wake();
+}
+
+void BufferRing::preDelete()
+{
+    m_stopped.store(true);
+    wake();
+}
+
+void BufferRing::setCapacity(size_t capacityBytes)
+{
+    m_capacity.store(capacityBytes);
+}
+
+bool BufferRing::isEmpty()
+{
+    return (count() == 0);
+}
+
+int BufferRing::count()
+{
+    uint64_t read = m_read.load();
+    uint64_t discard = m_discard.load();
+    uint64_t write = m_write.load();
+    uint64_t first = (discard > read) ? discard : read;
+    return (write > first) ? (int)(write - first) : 0;
+}
+
+void BufferRing::wake()
+{
+    m_wakeups++;
+    syscall(SYS_futex, reinterpret_cast<int*>(&m_wakeups), FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
@@ -0,0 +1,46 @@
+#ifndef BUFFERRING_H_
+#define BUFFERRING_H_
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include "BufferPool.h"
+
+//Single producer, single consumer ring of audio chunks, bounded by the bytes it holds.
+//Push and pop take no lock. The consumer sleeps on a futex only when the ring is empty and
+//the producer only wakes it when it fills an empty ring. A full ring drops the chunk, the
+//producer never waits.
+class BufferRing
+{
+    public:
+    BufferRing(size_t capacityBytes);
+    ~BufferRing();
+    //producer: returns false when the chunk does not fit, the caller keeps it
+    bool push(Buffer *item);
+    //consumer: blocks while the ring is empty, returns NULL once the ring was stopped
+    Buffer* pop();
+    //any thread: chunks queued so far are dropped by the consumer instead of returned
+    void clear();
+    //any thread: wakes the consumer for good
+    void preDelete();
+    void setCapacity(size_t capacityBytes);
+    bool isEmpty();
+    int count();
+
+    private:
+    BufferRing(const BufferRing&) = delete;
+    BufferRing& operator=(const BufferRing&) = delete;
+    void wake();
+
+    static const size_t SLOTS = 1024;
+    Buffer *m_slots[SLOTS];
+    std::atomic<uint64_t> m_write;
+    std::atomic<uint64_t> m_read;
+    std::atomic<uint64_t> m_discard;
+    std::atomic<size_t> m_bytes;
+    std::atomic<size_t> m_capacity;
+    std::atomic<bool> m_stopped;
+    //futex word, changed on every wake so that a consumer about to sleep sees it
+    std::atomic<int> m_wakeups;
+};
+#endif
@@ -1,4 +1,5 @@
 #include "AudioPlayer.h"
+#include "logger.h"
 #include <pthread.h>
 #include <assert.h>
 #include <cstring>
@@ -0,0 +1,274 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AudioMixer.h"
+
+#include <gst/app/gstappsink.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    //one sound of a player: 22.05 kHz mono like the PCM clips, converted the way the players do it
+    const char *SOUND = "audiotestsrc num-buffers=12 samplesperbuffer=1024 wave=sine freq=440 ! "
+                        "audio/x-raw,format=S16LE,rate=22050,channels=1 ! audioconvert ! audioresample ! ";
+    //AUDIO_MIXER_LEAD_MS and AUDIO_MIXER_LATENCY_MS of AudioMixer.cpp, a buffer pushed into an input
+    //is mixed that much later, the start time of a mixed sound includes it
+    const int MIXER_DELAY_MS = 60;
+
+    struct Player
+    {
+        Player() : pipeline(NULL), mixer(NULL), firstBuffer(false) {}
+        GstElement *pipeline;
+        AudioMixer *mixer;
+        std::shared_ptr<AudioMixer::Input> input;
+        Clock::time_point request;
+        Clock::time_point first;
+        std::atomic<bool> firstBuffer;
+    };
+
+    GstPadProbeReturn onFirstBuffer(GstPad *, GstPadProbeInfo *, gpointer data)
+    {
+        Player *player = (Player*) data;
+        //the probe stays for the next sound of this player
+        if(!player->firstBuffer)
+        {
+            player->first = Clock::now();
+            player->firstBuffer = true;
+        }
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstFlowReturn onSample(GstAppSink *sink, gpointer data)
+    {
+        Player *player = (Player*) data;
+        GstSample *sample = gst_app_sink_pull_sample(sink);
+        if(sample)
+        {
+            player->mixer->push(player->input, gst_sample_get_buffer(sample));
+            gst_sample_unref(sample);
+        }
+        return GST_FLOW_OK;
+    }
+
+    void onEos(GstAppSink *, gpointer data)
+    {
+        Player *player = (Player*) data;
+        player->mixer->endOfStream(player->input);
+    }
+
+    //without a mixer the player opens an audio sink of its own, as every player did before the mixer
+    bool createPlayer(Player &player, AudioMixer *mixer)
+    {
+        std::string description = std::string(SOUND) + (mixer ? "appsink name=sink" : "autoaudiosink name=sink");
+        GError *error = NULL;
+        player.pipeline = gst_parse_launch(description.c_str(), &error);
+        if(error)
+        {
+            std::cerr << "Cannot create the player pipeline: " << error->message << std::endl;
+            g_error_free(error);
+            return false;
+        }
+        player.mixer = mixer;
+        GstElement *sink = gst_bin_get_by_name(GST_BIN(player.pipeline), "sink");
+        if(mixer)
+        {
+            GstCaps *caps = AudioMixer::getCaps();
+            g_object_set(G_OBJECT(sink), "caps", caps, "sync", FALSE, NULL);
+            gst_caps_unref(caps);
+            GstAppSinkCallbacks callbacks;
+            memset(&callbacks, 0, sizeof(callbacks));
+            callbacks.eos = onEos;
+            callbacks.new_sample = onSample;
+            gst_app_sink_set_callbacks(GST_APP_SINK(sink), &callbacks, &player, NULL);
+        }
+        GstPad *pad = gst_element_get_static_pad(sink, "sink");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, onFirstBuffer, &player, NULL);
+        gst_object_unref(pad);
+        gst_object_unref(sink);
+        return true;
+    }
+
+    void play(Player &player)
+    {
+        player.firstBuffer = false;
+        player.request = Clock::now();
+        if(player.mixer)
+        {
+            player.input = player.mixer->attach(0, false, 100, 100);
+        }
+        gst_element_set_state(player.pipeline, GST_STATE_PLAYING);
+    }
+
+    void waitAndStop(Player &player)
+    {
+        GstBus *bus = gst_element_get_bus(player.pipeline);
+        GstMessage *message = gst_bus_timed_pop_filtered(bus, 10 * GST_SECOND, (GstMessageType)(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+        if(message == NULL || GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR)
+        {
+            std::cerr << "Player did not finish its sound" << std::endl;
+        }
+        if(message)
+        {
+            gst_message_unref(message);
+        }
+        gst_object_unref(bus);
+        if(player.mixer)
+        {
+            //the audio the input holds ahead of the output
+            g_usleep(100 * 1000);
+            player.mixer->detach(player.input);
+            player.input.reset();
+        }
+        gst_element_set_state(player.pipeline, GST_STATE_NULL);
+    }
+
+    long residentKb()
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while(std::getline(status, line))
+        {
+            if(line.compare(0, 6, "VmRSS:") == 0)
+            {
+                return atol(line.c_str() + 6);
+            }
+        }
+        return 0;
+    }
+
+    double cpuMs()
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+    }
+
+    gpointer runLoop(gpointer data)
+    {
+        g_main_loop_run((GMainLoop*) data);
+        return NULL;
+    }
+}
+
+// Plays a number of short sounds on a number of players at once, either with an audio sink per
+// player or through one AudioMixer, and prints the start time of a sound (request to its first
+// buffer reaching the sink element), the resident memory while all play and the cpu time.
+// Run each mode in a process of its own so the memory of one does not show in the other.
+int main(int argc, char *argv[])
+{
+    if(argc < 2 || (strcmp(argv[1], "players") != 0 && strcmp(argv[1], "mixer") != 0))
+    {
+        std::cerr << "Usage: " << argv[0] << " players|mixer [players] [sounds]" << std::endl;
+        return 1;
+    }
+    const bool mixed = (strcmp(argv[1], "mixer") == 0);
+    const int count = (argc > 2) ? atoi(argv[2]) : 3;
+    const int sounds = (argc > 3) ? atoi(argv[3]) : 10;
+    if(count <= 0 || sounds <= 0)
+    {
+        std::cerr << "players and sounds have to be positive" << std::endl;
+        return 1;
+    }
+
+    gst_init(&argc, &argv);
+    //the bus watch and the idle timer of the mixer run on the default main context
+    GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+    GThread *loopThread = g_thread_new("BusWatch", runLoop, loop);
+    AudioMixer *mixer = mixed ? new AudioMixer() : NULL;
+
+    std::vector<Player> players(count);
+    for(int i = 0; i < count; i++)
+    {
+        if(!createPlayer(players[i], mixer))
+        {
+            return 1;
+        }
+    }
+
+    const long startKb = residentKb();
+    const double startCpu = cpuMs();
+    long peakKb = startKb;
+    double totalStart = 0;
+    double maxStart = 0;
+    for(int sound = 0; sound < sounds; sound++)
+    {
+        for(int i = 0; i < count; i++)
+        {
+            play(players[i]);
+        }
+        for(int i = 0; i < count; i++)
+        {
+            for(int waited = 0; !players[i].firstBuffer && waited < 10000; waited++)
+            {
+                g_usleep(1000);
+            }
+            if(!players[i].firstBuffer)
+            {
+                std::cerr << "Player did not start its sound" << std::endl;
+                return 1;
+            }
+            double start = std::chrono::duration<double, std::milli>(players[i].first - players[i].request).count();
+            if(mixed)
+            {
+                start += MIXER_DELAY_MS;
+            }
+            totalStart += start;
+            if(start > maxStart)
+            {
+                maxStart = start;
+            }
+        }
+        long kb = residentKb();
+        if(kb > peakKb)
+        {
+            peakKb = kb;
+        }
+        for(int i = 0; i < count; i++)
+        {
+            waitAndStop(players[i]);
+        }
+        //a pause between the sounds, shorter than the idle time of the mixer output
+        g_usleep(500 * 1000);
+    }
+    const double cpu = cpuMs() - startCpu;
+
+    printf("%-8s %d players x %d sounds: start avg %.1f ms max %.1f ms, resident %ld KB (+%ld KB while playing), cpu %.0f ms\n",
+           argv[1], count, sounds, totalStart / (count * sounds), maxStart, peakKb, peakKb - startKb, cpu);
+    for(int i = 0; i < count; i++)
+    {
+        gst_object_unref(players[i].pipeline);
+    }
+    delete mixer;
+    g_main_loop_quit(loop);
+    g_thread_join(loopThread);
+    g_main_loop_unref(loop);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ChunkQueue.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace WPEFramework
+{
+    namespace Plugin
+    {
+        ChunkQueue::ChunkQueue(size_t chunkSize, size_t maxChunks)
+        : m_chunkSize(chunkSize)
+        , m_maxChunks(maxChunks)
+        , m_readOffset(0)
+        , m_finished(false)
+        , m_succeeded(false)
+        , m_cancelled(false)
+        {
+            m_pending.reserve(m_chunkSize);
+        }
+
+        bool ChunkQueue::write(const unsigned char *data, size_t length)
+        {
+            while (length > 0)
+            {
+                size_t count = std::min(length, m_chunkSize - m_pending.size());
+                m_pending.insert(m_pending.end(), data, data + count);
+                data += count;
+                length -= count;
+
+                if (m_pending.size() == m_chunkSize)
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this] { return m_cancelled || m_chunks.size() < m_maxChunks; });
+                    if (m_cancelled)
+                        return false;
+                    push();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return !m_cancelled;
+        }
+
+        void ChunkQueue::finish(bool success)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (success && !m_pending.empty())
+                    push();
+                m_finished = true;
+                m_succeeded = success;
+            }
+            m_condition.notify_all();
+        }
+
+        bool ChunkQueue::read(unsigned char *buffer, size_t size, size_t &length)
+        {
+            length = 0;
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_cancelled || m_finished || !m_chunks.empty(); });
+            if (m_cancelled)
+                return false;
+
+            if (m_chunks.empty())
+                return m_succeeded;
+
+            std::vector<unsigned char> &chunk = m_chunks.front();
+            length = std::min(size, chunk.size() - m_readOffset);
+            memcpy(buffer, &chunk[m_readOffset], length);
+            m_readOffset += length;
+
+            if (m_readOffset == chunk.size())
+            {
+                m_freeChunks.push_back(std::move(chunk));
+                m_chunks.pop_front();
+                m_readOffset = 0;
+                lock.unlock();
+                m_condition.notify_all();
+            }
+            return true;
+        }
+
+        void ChunkQueue::cancel()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_cancelled = true;
+            }
+            m_condition.notify_all();
+        }
+
+        // called with m_mutex held, hands the pending chunk to the consumer and takes a recycled one
+        void ChunkQueue::push()
+        {
+            m_chunks.push_back(std::move(m_pending));
+            if (m_freeChunks.empty())
+            {
+                m_pending = std::vector<unsigned char>();
+                m_pending.reserve(m_chunkSize);
+            }
+            else
+            {
+                m_pending = std::move(m_freeChunks.back());
+                m_freeChunks.pop_back();
+            }
+            m_pending.clear();
+            m_condition.notify_all();
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
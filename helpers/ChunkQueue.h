@@ -0,0 +1,70 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace WPEFramework {
+
+    namespace Plugin {
+
+        // Bounded queue of fixed size chunks between one producer (an encoder) and one
+        // consumer (an upload), so that the encoded data never has to be held in full.
+        class ChunkQueue
+        {
+        private:
+            ChunkQueue(const ChunkQueue&) = delete;
+            ChunkQueue& operator=(const ChunkQueue&) = delete;
+
+        public:
+            ChunkQueue(size_t chunkSize, size_t maxChunks);
+
+            // blocks while the queue is full, returns false once the consumer cancelled
+            bool write(const unsigned char *data, size_t length);
+            // flushes the last partial chunk and ends the stream
+            void finish(bool success);
+
+            // blocks while the queue is empty, returns false when the stream ended unsuccessfully
+            // or was cancelled, length is 0 at the end of a successful stream
+            bool read(unsigned char *buffer, size_t size, size_t &length);
+            // stops the stream from the consumer side and unblocks the producer
+            void cancel();
+
+        private:
+            void push();
+
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            size_t m_chunkSize;
+            size_t m_maxChunks;
+            std::deque<std::vector<unsigned char>> m_chunks;
+            std::vector<std::vector<unsigned char>> m_freeChunks;
+            std::vector<unsigned char> m_pending;
+            size_t m_readOffset;
+            bool m_finished;
+            bool m_succeeded;
+            bool m_cancelled;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework